@@ -0,0 +1,38 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/CertificateUtils.h"
+
+#include <cstring>
+#include <sstream>
+#include <openssl/evp.h>
+
+std::array<uint8_t,8> computeHashedId8(const Certificate& c) {
+    std::ostringstream os;
+    os << (int)c.getVersion() << '|' << (int)c.getCertType() << '|'
+       << (int)c.getIssuerType() << '|' << c.getSubjectId() << '|'
+       << (int)c.getAppPermPsid() << '|' << c.getAlgoName();
+    for (size_t i = 0; i < c.getPublicKeyArraySize(); i++)
+        os << (int)c.getPublicKey(i) << ',';
+    std::string s = os.str();
+
+    uint8_t hash[32];
+    unsigned int len = 0;
+    EVP_Digest(s.data(), s.size(), hash, &len, EVP_sha256(), nullptr);
+
+    std::array<uint8_t,8> id8;
+    std::memcpy(id8.data(), hash + 24, 8);  // last 8 bytes
+    return id8;
+}
@@ -0,0 +1,31 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_CERTIFICATEUTILS_H_
+#define _LTE_CERTIFICATEUTILS_H_
+
+#include "apps/mode4App/Certificate_m.h"
+
+#include <array>
+#include <cstdint>
+
+/**
+ * HashedId8 of a certificate: last 8 bytes of SHA-256 over its canonical
+ * serialization, per IEEE 1609.2 Section 6.3.29.
+ * Shared by the vehicle and RSU applications for digest-based signer identification.
+ */
+std::array<uint8_t,8> computeHashedId8(const Certificate& c);
+
+#endif
@@ -0,0 +1,68 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/CompactSpdu.h"
+
+Register_Class(TeslaDisclosure);
+Register_Class(CompactSpdu);
+
+const long TeslaDisclosure::WIRE_SIZE;
+const long CompactSpdu::HEADER_SIZE;
+const long CompactSpdu::DELTA_SIZE;
+const long CompactSpdu::WIRE_SIZE;
+const int CompactSpdu::POSITION_STEP;
+
+std::string TeslaDisclosure::signedSuffix(const TeslaDisclosure* disclosure)
+{
+    if (disclosure == nullptr)
+        return "";
+
+    return "," + TeslaKeyChain::toHex(disclosure->getAnchor()) + "," + std::to_string(disclosure->getDisclosedIndex())
+        + "," + TeslaKeyChain::toHex(disclosure->getDisclosedKey());
+}
+
+TeslaDisclosure* TeslaDisclosure::find(omnetpp::cPacket* spdu)
+{
+    for (omnetpp::cPacket* p = spdu->getEncapsulatedPacket(); p != nullptr; p = p->getEncapsulatedPacket())
+    {
+        if (TeslaDisclosure* disclosure = dynamic_cast<TeslaDisclosure*>(p))
+            return disclosure;
+    }
+    return nullptr;
+}
+
+// big endian, as on the wire
+static void put(std::vector<uint8_t>& out, uint32_t value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; i--)
+        out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+std::vector<uint8_t> CompactSpdu::getMacInput() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(DELTA_SIZE + 1);
+    put(out, getTempId(), 4);
+    put(out, getMsgCnt(), 1);
+    put(out, (uint32_t)getMsgId(), 4);
+    put(out, getRefMsgCnt(), 1);
+    put(out, getSecMark(), 2);
+    put(out, (uint16_t)getDLat(), 2);
+    put(out, (uint16_t)getDLon(), 2);
+    put(out, (uint8_t)getDSpeed(), 1);
+    put(out, (uint16_t)getDHeading(), 2);
+    put(out, getKeyIndex(), 1);
+    return out;
+}
@@ -0,0 +1,119 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_COMPACTSPDU_H_
+#define _LTE_COMPACTSPDU_H_
+
+#include <omnetpp.h>
+#include <string>
+#include <vector>
+
+#include "apps/mode4App/TeslaKeyChain.h"
+#include "apps/mode4App/TeslaDisclosure_m.h"
+#include "apps/mode4App/CompactSpdu_m.h"
+
+/**
+ * Key chain data appended to a full SPDU of a sender using compact BSMs:
+ * the anchor of the chain authenticating the next compact SPDUs, and the
+ * last key of the previous chain, which authenticates the last compact
+ * SPDUs sent before. Encapsulated in the SPDU (in its HybridSignature, if
+ * any) and covered by its signature (see signedSuffix()).
+ */
+class TeslaDisclosure : public TeslaDisclosure_Base
+{
+  public:
+    // anchor(16) + disclosedIndex(1) + disclosedKey(16)
+    static const long WIRE_SIZE = TeslaKeyChain::KEY_SIZE + 1 + TeslaKeyChain::KEY_SIZE;
+
+    TeslaDisclosure(const char* name = "TeslaDisclosure", short kind = 0) :
+        TeslaDisclosure_Base(name, kind)
+    {
+        anchor.fill(0);
+        disclosedKey.fill(0);
+        setByteLength(WIRE_SIZE);
+    }
+
+    TeslaDisclosure(const TeslaDisclosure& other) :
+        TeslaDisclosure_Base(other)
+    {
+    }
+
+    TeslaDisclosure& operator=(const TeslaDisclosure& other)
+    {
+        if (&other == this)
+            return *this;
+        TeslaDisclosure_Base::operator=(other);
+        return *this;
+    }
+
+    virtual TeslaDisclosure* dup() const override { return new TeslaDisclosure(*this); }
+
+    // Appended to the serialized BSM before signing and verifying; empty without disclosure
+    static std::string signedSuffix(const TeslaDisclosure* disclosure);
+
+    // The disclosure carried by an SPDU, possibly inside its hybrid part; NULL if none
+    static TeslaDisclosure* find(omnetpp::cPacket* spdu);
+};
+
+/**
+ * Compact BSM sent on the CTAC "compress" decisions instead of a full SPDU.
+ *
+ * It carries the kinematics as deltas from the last full BSM of the sender
+ * (identified by its msgCnt), which the receivers rebuild against the state
+ * they cached from that BSM. There is no signature: a MAC keyed with the
+ * keyIndex-th key of the sender's chain, disclosed later (see TeslaKeyChain).
+ */
+class CompactSpdu : public CompactSpdu_Base
+{
+  public:
+    // header: protocolVersion(1) + contentType(1) + psid(1) + keyIndex(1)
+    // + tempId(4) + msgCnt(1) + msgId(4, simulation-only) + refMsgCnt(1) + secMark(2)
+    // + dLat(2) + dLon(2) + dSpeed(1) + dHeading(2)
+    // + disclosedKey(16) + tag(8)
+    static const long HEADER_SIZE = 4;
+    static const long DELTA_SIZE = 4 + 1 + 4 + 1 + 2 + 2 + 2 + 1 + 2;
+    static const long WIRE_SIZE = HEADER_SIZE + DELTA_SIZE + TeslaKeyChain::KEY_SIZE + TeslaKeyChain::TAG_SIZE;
+
+    // position deltas are in cm
+    static const int POSITION_STEP = 10;
+
+    CompactSpdu(const char* name = "CompactSPDU", short kind = 0) :
+        CompactSpdu_Base(name, kind)
+    {
+        disclosedKey.fill(0);
+        tag.fill(0);
+        setByteLength(WIRE_SIZE);
+    }
+
+    CompactSpdu(const CompactSpdu& other) :
+        CompactSpdu_Base(other)
+    {
+    }
+
+    CompactSpdu& operator=(const CompactSpdu& other)
+    {
+        if (&other == this)
+            return *this;
+        CompactSpdu_Base::operator=(other);
+        return *this;
+    }
+
+    virtual CompactSpdu* dup() const override { return new CompactSpdu(*this); }
+
+    // Bytes covered by the MAC: every field but the disclosed key and the tag
+    std::vector<uint8_t> getMacInput() const;
+};
+
+#endif
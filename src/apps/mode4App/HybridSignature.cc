@@ -0,0 +1,130 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/HybridSignature.h"
+#include "apps/mode4App/CertificateUtils.h"
+#include "apps/mode4App/pqcdsa.h"
+
+#include <chrono>
+
+using namespace omnetpp;
+
+Register_Class(HybridSignature);
+
+const long HybridSignature::HEADER_SIZE;
+const long HybridSignature::DIGEST_SIZE;
+
+void HybridSignature::setSignature(const PqcSignatureBytes& signature)
+{
+    HybridSignature_Base::setSignature(signature);
+    updateLength();
+}
+
+void HybridSignature::setCert(const Certificate& cert)
+{
+    HybridSignature_Base::setCert(cert);
+    setCertIncluded(true);
+    updateLength();
+}
+
+long HybridSignature::getCertMetadataSize() const
+{
+    return getCertIncluded() ? pqcdsa::algorithmInfo(getCert().getAlgoName()).certMetadataSize() : 0;
+}
+
+void HybridSignature::updateLength()
+{
+    // set before anything is encapsulated in it
+    setByteLength(HEADER_SIZE + getSignatureSize() + getCertMetadataSize() + getPublicKeySize() + getDigestSize());
+}
+
+HybridSignature* HybridSignature::find(cPacket* spdu)
+{
+    for (cPacket* p = spdu->getEncapsulatedPacket(); p != nullptr; p = p->getEncapsulatedPacket())
+    {
+        if (HybridSignature* hybrid = dynamic_cast<HybridSignature*>(p))
+            return hybrid;
+    }
+    return nullptr;
+}
+
+HybridVerifier::Result HybridVerifier::check(const HybridSignature* hybrid, const std::string& dataHex,
+    simtime_t now, double& verifyMs)
+{
+    verifyMs = 0;
+
+    // the PQC certificate comes once, then by digest
+    const Certificate* cert = nullptr;
+    if (hybrid->getCertIncluded())
+    {
+        Certificate& cached = certs_[computeHashedId8(hybrid->getCert())];
+        cached = hybrid->getCert();
+        cert = &cached;
+    }
+    else
+    {
+        auto it = certs_.find(hybrid->getCertDigest());
+        if (it == certs_.end())
+            return NO_CERTIFICATE;
+        cert = &it->second;
+    }
+
+    std::vector<uint8_t> pkBytes(cert->getPublicKeyArraySize());
+    for (size_t i = 0; i < pkBytes.size(); ++i)
+        pkBytes[i] = cert->getPublicKey(i);
+    std::string pubKeyHex = pqcdsa::prefixKeyWithCertAlgo(pqcdsa::toHex(pkBytes.data(), pkBytes.size()), cert->getAlgoName());
+    const std::vector<uint8_t>& sig = hybrid->getSignature();
+    std::string sigHex = pqcdsa::toHex(sig.data(), sig.size());
+
+    if (!hybrid->getComposite())
+    {
+        Pending pending = { dataHex, sigHex, pubKeyHex, now, cert->getSubjectId() };
+        queue_.push_back(pending);
+        while (queueLimit_ > 0 && queue_.size() > queueLimit_)
+        {
+            queue_.pop_front();
+            dropped_++;
+        }
+        return QUEUED;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ok = pqcdsa::verify(dataHex, sigHex, pubKeyHex);
+    auto end = std::chrono::high_resolution_clock::now();
+    verifyMs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    return ok ? VERIFIED : FAILED;
+}
+
+std::vector<HybridVerifier::Outcome> HybridVerifier::verifyQueued(unsigned int budget)
+{
+    std::vector<Outcome> outcomes;
+    while (!queue_.empty() && (budget == 0 || outcomes.size() < budget))
+    {
+        const Pending& pending = queue_.front();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        bool ok = pqcdsa::verify(pending.dataHex, pending.sigHex, pending.pubKeyHex);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        Outcome outcome;
+        outcome.verified = ok;
+        outcome.queued = pending.queued;
+        outcome.verifyMs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+        outcome.sender = pending.sender;
+        outcomes.push_back(outcome);
+        queue_.pop_front();
+    }
+    return outcomes;
+}
@@ -0,0 +1,145 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_HYBRIDSIGNATURE_H_
+#define _LTE_HYBRIDSIGNATURE_H_
+
+#include <omnetpp.h>
+#include <array>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "apps/mode4App/HybridSignature_m.h"
+
+/**
+ * PQC part of a hybrid SPDU (hybridMode of Mode4App), encapsulated in it.
+ *
+ * The SPDU itself keeps its ECDSA P-256 signature and certificate; this part
+ * adds a PQC signature over the same data and identifies the PQC certificate
+ * of the sender, included when it changed and every hybridPqcCertInterval
+ * PQC signatures, by its HashedId8 otherwise.
+ *
+ * In "composite" mode the SPDU carries it every time and is valid only when
+ * both signatures are; in "dual" mode it comes every hybridPqcInterval BSMs
+ * and the receivers verify it after the fact (see HybridVerifier).
+ */
+class HybridSignature : public HybridSignature_Base
+{
+  public:
+    // algorithm and mode(1) + signature length(2)
+    static const long HEADER_SIZE = 3;
+    static const long DIGEST_SIZE = 8;
+
+    HybridSignature(const char* name = "HybridSignature", short kind = 0) :
+        HybridSignature_Base(name, kind)
+    {
+        certDigest.fill(0);
+    }
+
+    HybridSignature(const HybridSignature& other) :
+        HybridSignature_Base(other)
+    {
+    }
+
+    HybridSignature& operator=(const HybridSignature& other)
+    {
+        if (&other == this)
+            return *this;
+        HybridSignature_Base::operator=(other);
+        return *this;
+    }
+
+    virtual HybridSignature* dup() const override { return new HybridSignature(*this); }
+
+    // the length follows the signature and whether the certificate is included
+    virtual void setSignature(const PqcSignatureBytes& signature) override;
+    virtual void setCert(const Certificate& cert) override;
+
+    // Bytes of each element on the wire, for the size columns of the logs
+    long getSignatureSize() const { return getSignature().size(); }
+    long getPublicKeySize() const { return getCertIncluded() ? getCert().getPublicKeyArraySize() : 0; }
+    // certificate fields but the verification key, from the algorithm registry of pqcdsa
+    long getCertMetadataSize() const;
+    long getDigestSize() const { return getCertIncluded() ? 0 : DIGEST_SIZE; }
+
+    // The hybrid part of an SPDU, NULL for a single-algorithm one
+    static HybridSignature* find(omnetpp::cPacket* spdu);
+
+  private:
+    void updateLength();
+};
+
+/**
+ * Receiver side of the hybrid SPDUs: cache of the PQC certificates and queue
+ * of the PQC signatures verified off the reception path, bounded by the
+ * hybridLazyVerifyQueue parameter of the applications.
+ */
+class HybridVerifier
+{
+  public:
+    enum Result { VERIFIED, FAILED, NO_CERTIFICATE, QUEUED };
+
+    // outcome of a queued verification
+    struct Outcome
+    {
+        bool verified;
+        omnetpp::simtime_t queued;
+        double verifyMs;
+        std::string sender;
+    };
+
+    /**
+     * Checks the PQC signature of an SPDU over "dataHex": at once for a
+     * composite SPDU, queued otherwise.
+     *
+     * @param verifyMs wall-clock verification time, 0 unless verified now
+     */
+    Result check(const HybridSignature* hybrid, const std::string& dataHex, omnetpp::simtime_t now, double& verifyMs);
+
+    // At most "limit" signatures wait for verification, the oldest are dropped (0 for no limit)
+    void setQueueLimit(unsigned int limit) { queueLimit_ = limit; }
+
+    // Queued signatures dropped since the last call
+    unsigned int takeDropped()
+    {
+        unsigned int dropped = dropped_;
+        dropped_ = 0;
+        return dropped;
+    }
+
+    bool hasQueued() const { return !queue_.empty(); }
+
+    // Verifies the oldest queued signatures, at most "budget" of them (all with 0)
+    std::vector<Outcome> verifyQueued(unsigned int budget);
+
+  private:
+    struct Pending
+    {
+        std::string dataHex;
+        std::string sigHex;
+        std::string pubKeyHex;
+        omnetpp::simtime_t queued;
+        std::string sender;
+    };
+
+    std::map<CertDigest, Certificate> certs_;
+    std::deque<Pending> queue_;
+    unsigned int queueLimit_ = 0;
+    unsigned int dropped_ = 0;
+};
+
+#endif
@@ -0,0 +1,102 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/J2945CongestionControl.h"
+
+#include <cmath>
+
+#include "veins/base/utils/Heading.h"
+
+// the transmission ticks of the application are exact multiples of 100 ms,
+// accept an ITT reached up to this early
+static const simtime_t ITT_TOLERANCE = SimTime(1, SIMTIME_MS);
+
+J2945CongestionControl::J2945CongestionControl(const Params& params) :
+    params_(params),
+    cbr_(0),
+    density_(0),
+    itt_(params.minItt),
+    txPower_(params.maxTxPower),
+    lastTx_(-1),
+    lastSpeed_(0),
+    lastHeading_(0),
+    trackingError_(0)
+{
+    if (params_.minItt <= SIMTIME_ZERO || params_.maxItt < params_.minItt)
+        throw cRuntimeError("J2945CongestionControl - invalid ITT range [%s, %s]",
+            params_.minItt.str().c_str(), params_.maxItt.str().c_str());
+    if (params_.maxChanUtil <= params_.minChanUtil)
+        throw cRuntimeError("J2945CongestionControl - maxChanUtil must be larger than minChanUtil");
+    if (params_.trackingErrMax <= params_.trackingErrMin)
+        throw cRuntimeError("J2945CongestionControl - trackingErrMax must be larger than trackingErrMin");
+    if (params_.densityCoefficient <= 0)
+        throw cRuntimeError("J2945CongestionControl - densityCoefficient must be positive");
+}
+
+void J2945CongestionControl::updateCbr(double cbr)
+{
+    cbr_ = params_.cbrWeight * cbr + (1 - params_.cbrWeight) * cbr_;
+}
+
+void J2945CongestionControl::update(int neighbours)
+{
+    density_ = params_.densityWeight * neighbours + (1 - params_.densityWeight) * density_;
+
+    itt_ = params_.minItt * (density_ / params_.densityCoefficient);
+    if (itt_ < params_.minItt)
+        itt_ = params_.minItt;
+    else if (itt_ > params_.maxItt)
+        itt_ = params_.maxItt;
+
+    if (cbr_ <= params_.minChanUtil)
+        txPower_ = params_.maxTxPower;
+    else if (cbr_ >= params_.maxChanUtil)
+        txPower_ = params_.minTxPower;
+    else
+        txPower_ = params_.maxTxPower - (params_.maxTxPower - params_.minTxPower)
+            * (cbr_ - params_.minChanUtil) / (params_.maxChanUtil - params_.minChanUtil);
+}
+
+bool J2945CongestionControl::ittElapsed(simtime_t now) const
+{
+    return lastTx_ < SIMTIME_ZERO || now - lastTx_ >= itt_ - ITT_TOLERANCE;
+}
+
+double J2945CongestionControl::trackingProbability(const veins::Coord& position, simtime_t now)
+{
+    if (lastTx_ < SIMTIME_ZERO)
+        return 1;
+
+    // where the neighbours believe we are, from the last BSM (the y axis of
+    // veins grows southwards, which Heading::toCoord() accounts for)
+    double travelled = lastSpeed_ * (now - lastTx_).dbl();
+    veins::Coord estimate = lastPosition_ + veins::Heading(lastHeading_).toCoord() * travelled;
+    trackingError_ = position.distance(estimate);
+
+    if (trackingError_ < params_.trackingErrMin)
+        return 0;
+    if (trackingError_ >= params_.trackingErrMax)
+        return 1;
+    return (trackingError_ - params_.trackingErrMin) / (params_.trackingErrMax - params_.trackingErrMin);
+}
+
+void J2945CongestionControl::transmitted(simtime_t now, const veins::Coord& position, double speed, double heading)
+{
+    lastTx_ = now;
+    lastPosition_ = position;
+    lastSpeed_ = speed;
+    lastHeading_ = heading;
+    trackingError_ = 0;
+}
@@ -0,0 +1,104 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_J2945CONGESTIONCONTROL_H_
+#define _LTE_J2945CONGESTIONCONTROL_H_
+
+#include <omnetpp.h>
+
+#include "common/LteCommon.h"
+#include "veins/base/utils/Coord.h"
+
+/**
+ * SAE J2945/1 style congestion control of the BSM transmissions.
+ *
+ * - the channel busy ratio reported by the PHY every 100 ms is smoothed
+ *   (exponential average, weight cbrWeight) and sets the transmit power,
+ *   maxTxPower up to minChanUtil, minTxPower from maxChanUtil, linear between;
+ * - the vehicles heard within densityRange in the last densityWindow (counted
+ *   by Mode4App in its NeighbourTable), smoothed with weight densityWeight,
+ *   set the inter-transmit time
+ *   ITT = minItt * N / densityCoefficient, clamped to [minItt, maxItt];
+ * - between two ITT-driven transmissions, a BSM is also sent when the position
+ *   the neighbours extrapolate from the last BSM (dead reckoning) drifts from
+ *   the actual one: never below trackingErrMin, always above trackingErrMax,
+ *   with a linearly growing probability between.
+ *
+ * The object holds no module state: Mode4App feeds it and applies its outputs
+ * (congestionControl = "j2945").
+ */
+class J2945CongestionControl
+{
+  public:
+    struct Params
+    {
+        double cbrWeight;
+        double densityWeight;
+        double densityRange;           // m
+        simtime_t densityWindow;
+        double densityCoefficient;     // vehicles per minItt step
+        simtime_t minItt;
+        simtime_t maxItt;
+        double minTxPower;             // dBm
+        double maxTxPower;             // dBm
+        double minChanUtil;
+        double maxChanUtil;
+        double trackingErrMin;         // m
+        double trackingErrMax;         // m
+    };
+
+    explicit J2945CongestionControl(const Params& params);
+
+    // New CBR report of the PHY, in [0,1]
+    void updateCbr(double cbr);
+
+    // Recomputes the smoothed density, the ITT and the power (every CBR report),
+    // "neighbours" vehicles being heard within densityRange in the last densityWindow
+    void update(int neighbours);
+
+    // Whether the ITT elapsed since the last transmission
+    bool ittElapsed(simtime_t now) const;
+
+    // Probability of a transmission triggered by the tracking error at the given position
+    double trackingProbability(const veins::Coord& position, simtime_t now);
+
+    // A BSM was sent with the given kinematics (heading in radians)
+    void transmitted(simtime_t now, const veins::Coord& position, double speed, double heading);
+
+    simtime_t getItt() const { return itt_; }
+    double getTxPower() const { return txPower_; }
+    double getSmoothedCbr() const { return cbr_; }
+    double getDensity() const { return density_; }
+    double getTrackingError() const { return trackingError_; }
+    double getDensityRange() const { return params_.densityRange; }
+    simtime_t getDensityWindow() const { return params_.densityWindow; }
+
+  private:
+    Params params_;
+
+    double cbr_;
+    double density_;
+    simtime_t itt_;
+    double txPower_;
+
+    // kinematics announced by the last BSM, -1 before the first one
+    simtime_t lastTx_;
+    veins::Coord lastPosition_;
+    double lastSpeed_;
+    double lastHeading_;
+    double trackingError_;
+};
+
+#endif
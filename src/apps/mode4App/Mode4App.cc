@@ -1,9 +1,14 @@
 #include "apps/mode4App/Mode4App.h"
+#include "apps/mode4App/CertificateUtils.h"
 #include "common/LteControlInfo.h"
-#include "stack/phy/packet/cbr_m.h"
+#include "stack/phy/packet/Cbr.h"
+#include "common/LteProfiler.h"
+#include "common/LteLog.h"
+#include "stack/mac/layer/LteSpsTiming.h"
 
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/base/modules/BaseMobility.h"
+#include "world/mobility/HighwayMobility.h"
 #include "veins/base/utils/Coord.h"
 #include "apps/mode4App/IcaSpdu_m.h"
 #include <chrono>
@@ -14,31 +19,13 @@
 #include <sys/stat.h>
 #include <openssl/evp.h>
 #include <array>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
 
 
 Define_Module(Mode4App);
 
-// Compute HashedId8 = last 8 bytes of SHA-256 over canonical cert serialization
-// per IEEE 1609.2 Section 6.3.29
-static std::array<uint8_t,8> computeHashedId8(const Certificate& c) {
-    std::ostringstream os;
-    os << (int)c.getVersion() << '|' << (int)c.getCertType() << '|'
-       << (int)c.getIssuerType() << '|' << c.getSubjectId() << '|'
-       << (int)c.getAppPermPsid() << '|' << c.getAlgoName();
-    for (size_t i = 0; i < c.getPublicKeyArraySize(); i++)
-        os << (int)c.getPublicKey(i) << ',';
-    std::string s = os.str();
-
-    uint8_t hash[32];
-    unsigned int len = 0;
-    EVP_Digest(s.data(), s.size(), hash, &len, EVP_sha256(), nullptr);
-
-    std::array<uint8_t,8> id8;
-    std::memcpy(id8.data(), hash + 24, 8);  // last 8 bytes
-    return id8;
-}
-
 static std::string getLogDirectory()
 {
     // Get configuration name from OMNeT++ to create scenario-specific log directory
@@ -77,6 +64,7 @@ static inline void appendCsv(const std::string& path,
                              const std::string& header,
                              const std::vector<std::string>& cols)
 {
+    LTE_PROFILE_SCOPE("Mode4App", "appendCsv");
     // Write header once if file is new/empty
     bool writeHeader = false;
     {
@@ -95,6 +83,7 @@ static inline void appendCsv(const std::string& path,
         f << cols[i];
     }
     f << '\n';
+    LTE_PROFILE_COUNT("Mode4App", "csvRows", 1);
 }
 
 
@@ -115,18 +104,56 @@ static std::string icaBodyHex(const IcaWarn& w)
     return pqcdsa::toHex(reinterpret_cast<const uint8_t*>(os.str().data()), os.str().size());
 }
 
-static veins::Coord getNodePositionNow(cModule* context, simtime_t t) {
-    for (cModule* m = context; m; m = m->getParentModule()) {
-        if (auto* mob = m->getSubmodule("veinsmobility")) {
-            if (auto* tm = dynamic_cast<veins::TraCIMobility*>(mob))
-                return tm->getPositionAt(t);
-            if (auto* bm = dynamic_cast<veins::BaseMobility*>(mob))
-                return bm->getPositionAt(t);
-        }
-    }
+// mobility of the node as the binder resolved it at registration
+static veins::Coord getNodePositionNow(const LteBinder::NodeHandles* node, simtime_t t) {
+    if (node && node->traciMobility)
+        return node->traciMobility->getPositionAt(t);
+    if (node && node->mobility)
+        return node->mobility->getPositionAt(t);
     return veins::Coord(0,0,0); // fallback if not found
 }
 
+// speed (m/s) and heading (rad) from TraCI (or the built-in highway) mobility
+static void getNodeKinematics(const LteBinder::NodeHandles* node, double& speed, double& heading)
+{
+    speed = 0.0;
+    heading = 0.0;
+    if (!node)
+        return;
+    if (node->traciMobility) {
+        speed   = node->traciMobility->getSpeed();
+        heading = node->traciMobility->getHeading().getRad();
+    }
+    else if (node->highwayMobility) {
+        speed   = node->highwayMobility->getSpeed();
+        heading = node->highwayMobility->getHeading().getRad();
+    }
+}
+
+// Self-signed explicit BSM certificate of a key pair
+static Certificate buildCertificate(const pqcdsa::KeyPair& kp, const char* subject)
+{
+    Certificate cert;
+    cert.setAlgoName(pqcdsa::prettyNameFromTag(pqcdsa::algoTagFromKey(kp.pubHex)).c_str());
+    cert.setSubjectId(subject);
+
+    auto pkBytes = pqcdsa::fromHex(kp.pubHex);
+    cert.setPublicKeyArraySize(pkBytes.size());
+    for (size_t i = 0; i < pkBytes.size(); ++i)
+        cert.setPublicKey(i, pkBytes[i]);
+    cert.setVersion(3);
+    cert.setCertType(0);           // explicit
+    cert.setIssuerType(1);         // self-signed
+    cert.setAppPermPsid(0x20);     // BSM
+    cert.setValidityStart(0);
+    cert.setValidityDuration(9223372036854775807LL);
+    return cert;
+}
+
+// Note: header preserves the typo "Numer of Vehicles" for compatibility
+static const std::string V2V_LOG_HEADER =
+    "t,receiver,sender,msgId,lat,lon,dist_m,delay_ms,Numer of Vehicles,verified,spdu_overhead,cert_metadata,digest_size,pk_size,sig_size,bsm_data_size,spdu_size,Algorithm,signerType";
+
 void Mode4App::initialize(int stage)
 {
     Mode4BaseApp::initialize(stage);
@@ -140,30 +167,52 @@ void Mode4App::initialize(int stage)
     } else if (stage==inet::INITSTAGE_APPLICATION_LAYER) {
 
         std::string algo = par("cryptoAlgo").stdstringValue();
+        const pqcdsa::AlgorithmInfo* algoInfo = pqcdsa::findAlgorithm(algo);
+        if (!algoInfo)
+            throw cRuntimeError("Mode4App::initialize - unknown cryptoAlgo \"%s\"", algo.c_str());
+        if (!pqcdsa::isAvailable(*algoInfo))
+            throw cRuntimeError("Mode4App::initialize - cryptoAlgo \"%s\" is not enabled in liboqs", algo.c_str());
         pqcdsa::setAlgorithm(algo);
 
-        keyPair = pqcdsa::generateKeyPair();
-
-        std::string tag   = pqcdsa::algoTagFromKey(keyPair.pubHex);
-        std::string label = pqcdsa::prettyNameFromTag(tag);
-        Cert.setAlgoName(label.c_str());
-
-        EV_FATAL << "--- PQC Key Information ---" << endl;
-        EV_FATAL << "Public Key Length: " << keyPair.pubKeyLength << " bytes" << endl;
-        EV_FATAL << "Public Key Length after string: " << strlen(keyPair.pubHex.c_str()) << " bytes" << endl;
-        EV_FATAL << "---------------------------" << endl;
-        Cert.setSubjectId(getParentModule()->getFullName());
-
-        auto pkBytes = pqcdsa::fromHex(keyPair.pubHex);
-        Cert.setPublicKeyArraySize(pkBytes.size());
-        for (size_t i = 0; i < pkBytes.size(); ++i)
-            Cert.setPublicKey(i, pkBytes[i]);
-        Cert.setVersion(3);
-        Cert.setCertType(0);           // explicit
-        Cert.setIssuerType(1);         // self-signed
-        Cert.setAppPermPsid(0x20);     // BSM
-        Cert.setValidityStart(0);
-        Cert.setValidityDuration(9223372036854775807LL);
+        // hybrid mode: ECDSA signature and certificate as usual, plus a PQC key pair
+        std::string hybridMode = par("hybridMode").stdstringValue();
+        if (hybridMode == "dual")
+            hybridMode_ = HYBRID_DUAL;
+        else if (hybridMode == "composite")
+            hybridMode_ = HYBRID_COMPOSITE;
+        else if (hybridMode != "off")
+            throw cRuntimeError("Mode4App::initialize - unknown hybridMode \"%s\"", hybridMode.c_str());
+
+        if (hybridMode_ == HYBRID_OFF) {
+            keyPair = pqcdsa::generateKeyPair();
+        } else {
+            std::string pqcAlgo = par("hybridPqcAlgo").stdstringValue();
+            if (!pqcdsa::isPostQuantum(pqcAlgo))
+                throw cRuntimeError("Mode4App::initialize - hybridPqcAlgo \"%s\" is not a PQC algorithm", pqcAlgo.c_str());
+            if (!pqcdsa::isAvailable(pqcdsa::algorithmInfo(pqcAlgo)))
+                throw cRuntimeError("Mode4App::initialize - hybridPqcAlgo \"%s\" is not enabled in liboqs", pqcAlgo.c_str());
+            hybridPqcInterval_ = par("hybridPqcInterval").intValue();
+            hybridPqcCertInterval_ = par("hybridPqcCertInterval").intValue();
+            if (hybridPqcInterval_ < 1 || hybridPqcCertInterval_ < 1)
+                throw cRuntimeError("Mode4App::initialize - invalid hybridPqcInterval or hybridPqcCertInterval");
+
+            keyPair = pqcdsa::generateKeyPair("ecdsa");
+            pqcKeyPair_ = pqcdsa::generateKeyPair(pqcAlgo);
+            pqcCert_ = buildCertificate(pqcKeyPair_, getParentModule()->getFullName());
+            pqcDigest_ = computeHashedId8(pqcCert_);
+        }
+        hybridLazyVerifyPeriod_ = par("hybridLazyVerifyPeriod");
+        hybridLazyVerifyBudget_ = par("hybridLazyVerifyBudget").intValue();
+        if (par("hybridLazyVerifyQueue").intValue() < 0)
+            throw cRuntimeError("Mode4App::initialize - invalid hybridLazyVerifyQueue");
+        hybridVerifier_.setQueueLimit(par("hybridLazyVerifyQueue").intValue());
+        pqcVerifyEvt_ = new cMessage("pqcVerify");
+
+        LTE_EV_DIAG << "--- PQC Key Information ---" << endl;
+        LTE_EV_DIAG << "Public Key Length: " << keyPair.pubKeyLength << " bytes" << endl;
+        LTE_EV_DIAG << "Public Key Length after string: " << strlen(keyPair.pubHex.c_str()) << " bytes" << endl;
+        LTE_EV_DIAG << "---------------------------" << endl;
+        Cert = buildCertificate(keyPair, getParentModule()->getFullName());
 
         bsmSeq = 0;
         certInterval_ = par("certInterval").intValue();
@@ -205,6 +254,16 @@ void Mode4App::initialize(int stage)
         signatureTimeMs_  = registerSignal("signatureTimeMs");
         verifyTimeMs_      = registerSignal("verifyTimeMs");
 
+        hybridPqcSignedSignal_ = registerSignal("hybridPqcSigned");
+        hybridPqcBytesSignal_ = registerSignal("hybridPqcBytes");
+        pqcSignatureTimeMsSignal_ = registerSignal("pqcSignatureTimeMs");
+        pqcVerifyTimeMsSignal_ = registerSignal("pqcVerifyTimeMs");
+        hybridPqcVerifiedSignal_ = registerSignal("hybridPqcVerified");
+        hybridPqcFailedSignal_ = registerSignal("hybridPqcFailed");
+        hybridPqcNoCertSignal_ = registerSignal("hybridPqcNoCert");
+        hybridPqcVerifyDelaySignal_ = registerSignal("hybridPqcVerifyDelay");
+        hybridPqcDroppedSignal_ = registerSignal("hybridPqcDropped");
+
         // CTAC parameters and signals
         ctacEnabled_ = par("ctacEnabled").boolValue();
         ctacCohorts_ = par("ctacCohorts").intValue();
@@ -223,15 +282,110 @@ void Mode4App::initialize(int stage)
         ctacOverrideSafetySignal_ = registerSignal("ctacOverrideSafety");
         ctrlOverheadBytesSignal_ = registerSignal("ctrlOverheadBytes");
         ctacCohortIdSignal_ = registerSignal("ctacCohortId");
+
+        compactChainLength_ = par("compactChainLength").intValue();
+        if (compactChainLength_ < 1 || compactChainLength_ > 255)
+            throw cRuntimeError("Mode4App::initialize - compactChainLength must be in [1, 255]");
+        compactSentSignal_ = registerSignal("compactSent");
+        compactBytesSavedSignal_ = registerSignal("compactBytesSaved");
+        compactReceivedSignal_ = registerSignal("compactReceived");
+        compactReconstructedSignal_ = registerSignal("compactReconstructed");
+        compactReconstructFailedSignal_ = registerSignal("compactReconstructFailed");
+        compactVerifiedSignal_ = registerSignal("compactVerified");
+        compactAuthFailedSignal_ = registerSignal("compactAuthFailed");
+        compactUnverifiedSignal_ = registerSignal("compactUnverified");
+
+        // just-in-time generation: the MAC of this vehicle tells when its occasions are
+        std::string generationMode = par("generationMode").stdstringValue();
+        if (generationMode == "sps")
+            spsAligned_ = true;
+        else if (generationMode != "periodic")
+            throw cRuntimeError("Mode4App::initialize - unknown generationMode \"%s\"", generationMode.c_str());
+        spsLead_ = par("spsLeadTime");
+        if (spsLead_ < SIMTIME_ZERO)
+            throw cRuntimeError("Mode4App::initialize - spsLeadTime cannot be negative");
+        spsRealignSignal_ = registerSignal("spsRealign");
+        if (spsAligned_)
+        {
+            spsTxTimingSignal_ = registerSignal("spsTxTiming");
+            getParentModule()->subscribe(spsTxTimingSignal_, this);
+        }
+
+        std::string congestionControl = par("congestionControl").stdstringValue();
+        if (congestionControl == "j2945")
+        {
+            J2945CongestionControl::Params params;
+            params.cbrWeight = par("ccCbrWeight");
+            params.densityWeight = par("ccDensityWeight");
+            params.densityRange = par("ccDensityRange");
+            params.densityWindow = par("ccDensityWindow");
+            params.densityCoefficient = par("ccDensityCoefficient");
+            params.minItt = par("ccMinItt");
+            params.maxItt = par("ccMaxItt");
+            params.minTxPower = par("ccMinTxPower");
+            params.maxTxPower = par("ccMaxTxPower");
+            params.minChanUtil = par("ccMinChanUtil");
+            params.maxChanUtil = par("ccMaxChanUtil");
+            params.trackingErrMin = par("ccTrackingErrMin");
+            params.trackingErrMax = par("ccTrackingErrMax");
+            congestion_ = new J2945CongestionControl(params);
+
+            // the power is applied to the sidelink PHY of this vehicle
+            phy_ = check_and_cast<LtePhyVUeMode4*>(getParentModule()->getSubmodule("lteNic")->getSubmodule("phy"));
+            phy_->setD2dTxPower(congestion_->getTxPower());
+        }
+        else if (congestionControl != "none")
+            throw cRuntimeError("Mode4App::initialize - unknown congestionControl \"%s\"", congestionControl.c_str());
+        ccIttSignal_ = registerSignal("ccItt");
+        ccTxPowerSignal_ = registerSignal("ccTxPower");
+        ccCbrSignal_ = registerSignal("ccCbr");
+        ccDensitySignal_ = registerSignal("ccDensity");
+        ccTrackingTxSignal_ = registerSignal("ccTrackingTx");
+        ccSkippedSignal_ = registerSignal("ccSkipped");
+
+        neighbours_ = new NeighbourTable(par("neighbourExpiry"));
+        neighbourCountSignal_ = registerSignal("neighbourCount");
+        neighbourAoISignal_ = registerSignal("neighbourAoI");
+        neighbourMsgCntGapSignal_ = registerSignal("neighbourMsgCntGap");
+
+        ReceptionMetrics::Params metrics;
+        metrics.distanceBin = par("metricsDistanceBin");
+        metrics.distanceBins = par("metricsDistanceBins");
+        metrics.ipgBin = par("metricsIpgBin");
+        metrics.ipgBins = par("metricsIpgBins");
+        metrics.linkTimeout = par("metricsLinkTimeout");
+        metrics.perLink = par("metricsPerLink");
+        receptionMetrics_ = new ReceptionMetrics(metrics);
     }
 }
 
 void Mode4App::handleLowerMessage(cMessage* msg)
 {
+    LTE_PROFILE_SCOPE("Mode4App", "handleLowerMessage");
     if (msg->isName("CBR")) {
         Cbr* cbrPkt = check_and_cast<Cbr*>(msg);
         double channel_load = cbrPkt->getCbr();
         emit(cbr_, channel_load);
+
+        // the reports come every 100 ms: the neighbour table is aged and sampled at the same pace
+        neighbours_->expire(simTime());
+        emit(neighbourCountSignal_, (long)neighbours_->size());
+        if (neighbours_->size() > 0)
+            emit(neighbourAoISignal_, neighbours_->meanAgeOfInformation(simTime()));
+
+        if (congestion_)
+        {
+            // so are the J2945/1 parameters
+            congestion_->updateCbr(channel_load);
+            veins::Coord me = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
+            congestion_->update(neighbours_->countWithin(me, congestion_->getDensityRange(), simTime(),
+                congestion_->getDensityWindow()));
+            phy_->setD2dTxPower(congestion_->getTxPower());
+            emit(ccCbrSignal_, congestion_->getSmoothedCbr());
+            emit(ccDensitySignal_, congestion_->getDensity());
+            emit(ccIttSignal_, congestion_->getItt());
+            emit(ccTxPowerSignal_, congestion_->getTxPower());
+        }
         delete cbrPkt;
     }
 //    Do not delete
@@ -462,6 +616,9 @@ void Mode4App::handleLowerMessage(cMessage* msg)
         delete s;
         return;
     }
+    else if (auto* compact = dynamic_cast<CompactSpdu*>(msg)) {
+        handleCompact(compact);
+    }
     else {
         SPDU* spdu = dynamic_cast<SPDU*>(msg);
         if (!spdu) {
@@ -469,7 +626,7 @@ void Mode4App::handleLowerMessage(cMessage* msg)
             delete msg;
             return;
         }
-        veins::Coord rx = getNodePositionNow(this, simTime());
+        veins::Coord rx = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
         simtime_t delay = simTime() - spdu->getTimestamp();
 
         const char* hostName = getParentModule()->getFullName();
@@ -482,6 +639,7 @@ void Mode4App::handleLowerMessage(cMessage* msg)
         const BSM& b = spdu->getBsm();
         std::ostringstream os;
         os << b.getMsgId() << ',' << b.getLat() << ',' << b.getLon() << ',' << b.getHeading_j() << ',' << b.getSpeed_j();
+        os << TeslaDisclosure::signedSuffix(TeslaDisclosure::find(spdu));
         std::string bsmHex = pqcdsa::toHex(reinterpret_cast<const uint8_t*>(os.str().data()), os.str().size());
 
         // Note: bsm_rx_*.csv logging is currently disabled (see commented code below line 522)
@@ -528,15 +686,47 @@ void Mode4App::handleLowerMessage(cMessage* msg)
             auto verifyUs = std::chrono::duration_cast<std::chrono::microseconds>(verifyEnd - verifyStart).count();
             emit(verifyTimeMs_, verifyUs / 1000.0);
         }
+        // hybrid SPDU: the ECDSA signature above is the hot path
+        HybridSignature* hybrid = HybridSignature::find(spdu);
+        if (hybrid && !hybridCheck(hybrid, bsmHex))
+            ok = false;
+
         if (ok) {
             emit(verified_, long(1));
         }
+
+        // a sender of compact BSMs: they are rebuilt against this one, with the new key chain
+        TeslaDisclosure* disclosure = TeslaDisclosure::find(spdu);
+        if (ok && disclosure) {
+            uint32_t tempId = (uint32_t)strtoul(b.getTempId(), nullptr, 16);
+            auto known = compactPeers_.find(tempId);
+            if (known != compactPeers_.end()) {
+                authenticateCompacts(tempId, known->second, disclosure->getDisclosedIndex(), disclosure->getDisclosedKey());
+                if (!known->second.pending.empty())   // their key was lost
+                    emit(compactUnverifiedSignal_, (long)known->second.pending.size());
+            }
+            CompactPeer& peer = compactPeers_[tempId];
+            peer.reference = b;
+            peer.sender = useCert->getSubjectId();
+            peer.trustedKey = disclosure->getAnchor();
+            peer.trustedIndex = 0;
+            peer.pending.clear();
+        }
         // Recover position from fixed-point millimeters
         veins::Coord tx(b.getLat() / 1000.0, b.getLon() / 1000.0, 0.0);
 
         // Distance in meters
         double dist_m = rx.distance(tx);
 
+        // the metrics count every BSM received, the neighbour table only trusts verified ones
+        uint32_t senderId = (uint32_t)strtoul(b.getTempId(), nullptr, 16);
+        receptionMetrics_->received(senderId, b.getMsgId(), spdu->getTimestamp(), dist_m, ok, simTime());
+        if (ok) {
+            neighbours_->update(senderId, tx, b.getSpeed_j() * 0.02, b.getHeading_j() * 0.0125, b.getMsgCnt(),
+                spdu->getTimestamp(), true, simTime());
+            emit(neighbourMsgCntGapSignal_, (long)neighbours_->find(senderId)->msgCntGap);
+        }
+
         // ============================================================================
         // V2V Reception Logging (identical schema to RSU logging)
         // ============================================================================
@@ -565,14 +755,20 @@ void Mode4App::handleLowerMessage(cMessage* msg)
             if (isDigestMode) {
                 digestSize = 8;  // HashedId8
             } else if (useCert) {
-                // Full cert in packet
-                certMetadata = 105;  // cert fields excluding pubkey
-                long derPubKeySize = useCert->getPublicKeyArraySize();
-                bool isEcdsa = (algoName.find("ECDSA") != std::string::npos
-                             || algoName.find("ecdsa") != std::string::npos
-                             || algoName.find("P-256") != std::string::npos
-                             || algoName.find("P-384") != std::string::npos);
-                pkSize = isEcdsa ? (derPubKeySize - 26) : derPubKeySize;
+                // Full cert in packet, sized by the algorithm registry
+                const pqcdsa::AlgorithmInfo& info = pqcdsa::algorithmInfo(algoName);
+                certMetadata = info.certMetadataSize();  // cert fields excluding pubkey
+                pkSize = info.publicKeySize;
+            }
+
+            // PQC part of a hybrid SPDU: its own header, signature and certificate or digest
+            if (hybrid) {
+                spduOverhead += HybridSignature::HEADER_SIZE;
+                certMetadata += hybrid->getCertMetadataSize();
+                digestSize += hybrid->getDigestSize();
+                pkSize += hybrid->getPublicKeySize();
+                sigSize += hybrid->getSignatureSize();
+                algoName += std::string("+") + hybrid->getAlgoName();
             }
 
             long bsmDataSize = 1 + 4 + 4 + 2 + 4 + 4 + 2  // msgCnt+msgId+tempId+secMark+lat+lon+elev
@@ -582,17 +778,13 @@ void Mode4App::handleLowerMessage(cMessage* msg)
                              + 2                             // brakes
                              + 2 + 1;                        // vehWidth+vehLength = 43 bytes
 
-            // Note: header preserves the typo "Numer of Vehicles" for compatibility
-            const std::string header =
-                "t,receiver,sender,msgId,lat,lon,dist_m,delay_ms,Numer of Vehicles,verified,spdu_overhead,cert_metadata,digest_size,pk_size,sig_size,bsm_data_size,spdu_size,Algorithm,signerType";
-
             std::ostringstream t;   t << std::fixed << std::setprecision(6) << simTime().dbl();
             std::ostringstream lat; lat << std::fixed << std::setprecision(6) << b.getLat() / 1000.0;
             std::ostringstream lon; lon << std::fixed << std::setprecision(6) << b.getLon() / 1000.0;
             std::ostringstream dms; dms << std::fixed << std::setprecision(3) << delay_ms;
             std::ostringstream dst; dst << std::fixed << std::setprecision(3) << dist_m;
 
-            appendCsv(v2vPath, header, {
+            appendCsv(v2vPath, V2V_LOG_HEADER, {
                 t.str(),
                 std::string(getParentModule()->getFullName()),  // receiver = carNoIp[n]
                 senderStr,
@@ -663,7 +855,9 @@ void Mode4App::handleSelfMessage(cMessage* msg)
     if (msg == sendEvt) {
         emit(bsmOpportunitySignal_, 1);          // ALWAYS, before the gate
 
-        if (!ctacEnabled_) {
+        if (congestion_ && !congestionAllows()) {
+            emit(ccSkippedSignal_, 1);           // neither the ITT nor the tracking error: no BSM
+        } else if (!ctacEnabled_) {
             ++bsmSeq;                            // Increment ONLY when BSM generated
             generateAndSendSPDU();               // unchanged legacy path
             lastFullTx_ = simTime();
@@ -676,8 +870,12 @@ void Mode4App::handleSelfMessage(cMessage* msg)
                     break;
                 case CTAC_COMPRESS:
                     ++bsmSeq;                    // Increment for compressed BSM too
-                    generateAndSendCompact();    // see implementation below
-                    emit(ctacCompressedSignal_, 1);
+                    if (generateAndSendCompact()) {
+                        emit(ctacCompressedSignal_, 1);
+                    } else {
+                        generateAndSendSPDU();   // nothing to compress against: full BSM
+                        lastFullTx_ = simTime();
+                    }
                     break;
                 case CTAC_DEFER:
                     numDeferred_++;              // Count deferred, but DON'T increment bsmSeq
@@ -686,8 +884,22 @@ void Mode4App::handleSelfMessage(cMessage* msg)
             }
         }
 
+        if (spsAligned_ && spsPeriod_ > SIMTIME_ZERO)
+        {
+            // next occasion of the reservation, leaving the lead time to build and sign the BSM
+            nextSpsTx_ += spsPeriod_;
+            while (nextSpsTx_ - spsLead_ <= simTime())
+                nextSpsTx_ += spsPeriod_;
+            scheduleAt(nextSpsTx_ - spsLead_, sendEvt);
+        }
+        else
+        {
 //        scheduleAt(simTime() + par("sendInterval").doubleValue(), sendEvt);
-        scheduleAt(simTime() + 0.1, sendEvt);
+            scheduleAt(simTime() + 0.1, sendEvt);
+        }
+    }
+    else if (msg == pqcVerifyEvt_) {
+        verifyQueuedPqc();
     }
     else {
         // Delete any other unexpected self-messages
@@ -695,8 +907,31 @@ void Mode4App::handleSelfMessage(cMessage* msg)
     }
 }
 
+void Mode4App::receiveSignal(cComponent* source, simsignal_t signalID, cObject* obj, cObject* details)
+{
+    Enter_Method_Silent();
+
+    LteSpsTiming* timing = dynamic_cast<LteSpsTiming*>(obj);
+    if (signalID != spsTxTimingSignal_ || timing == NULL || !timing->isPeriodic())
+        return;
+
+    // the BSM that triggered the reservation goes out at its first occasion:
+    // the next one is built just before the following occasion
+    spsPeriod_ = timing->getPeriod();
+    nextSpsTx_ = timing->getNextTx() + spsPeriod_;
+    while (nextSpsTx_ - spsLead_ <= simTime())
+        nextSpsTx_ += spsPeriod_;
+
+    cancelEvent(sendEvt);
+    scheduleAt(nextSpsTx_ - spsLead_, sendEvt);
+    emit(spsRealignSignal_, 1);
+
+    EV_INFO << "Mode4App::receiveSignal - BSM generation realigned, next occasion at " << nextSpsTx_ << endl;
+}
+
 void Mode4App::generateAndSendSPDU()
 {
+    LTE_PROFILE_SCOPE("Mode4App", "generateAndSendSPDU");
     BSM bsm;
     bsm.setMsgId(bsmSeq);
 
@@ -709,30 +944,37 @@ void Mode4App::generateAndSendSPDU()
     }
     bsm.setSecMark((uint16_t)((int64_t)(simTime().dbl() * 1000) % 60000));
 
-    veins::Coord me = getNodePositionNow(this, simTime());
+    veins::Coord me = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
     // Store OMNeT++ coords as fixed-point millimeters (not 1e7 — that overflows
     // int32_t for simulation coords in meters, e.g. 500m * 1e7 > INT32_MAX)
     bsm.setLat((int32_t)(me.x * 1000));
     bsm.setLon((int32_t)(me.y * 1000));
 
-    // Fetch speed and heading from TraCI mobility
-    double speed   = 0.0;
-    double heading = 0.0;
-    for (cModule* m = this; m; m = m->getParentModule()) {
-        if (auto* mob = m->getSubmodule("veinsmobility")) {
-            if (auto* tm = dynamic_cast<veins::TraCIMobility*>(mob)) {
-                speed   = tm->getSpeed();
-                heading = tm->getHeading().getRad();
-                break;
-            }
-        }
-    }
+    double speed, heading;
+    getNodeKinematics(binder_->getNodeHandles(nodeId_), speed, heading);
     bsm.setSpeed_j((uint16_t)(speed / 0.02));
     bsm.setHeading_j((uint16_t)(heading / 0.0125));
 
+    // With compact BSMs, the full SPDU discloses the last key used and anchors a new chain
+    TeslaDisclosure* disclosure = nullptr;
+    if (ctacEnabled_ && ctacCompressMode_) {
+        disclosure = new TeslaDisclosure();
+        if (!keyChain_.isEmpty()) {
+            disclosure->setDisclosedIndex(compactIndex_);
+            disclosure->setDisclosedKey(keyChain_.getKey(compactIndex_));
+        }
+        TeslaKeyChain::Key seed;
+        for (size_t i = 0; i < seed.size(); i++)
+            seed[i] = (uint8_t)intuniform(0, 255);
+        keyChain_.generate(seed, compactChainLength_);
+        compactIndex_ = 0;
+        disclosure->setAnchor(keyChain_.getAnchor());
+    }
+
     // Serialize BSM to hex (using J2735 integer fields)
     std::ostringstream os;
     os << bsm.getMsgId() << ',' << bsm.getLat() << ',' << bsm.getLon() << ',' << bsm.getHeading_j() << ',' << bsm.getSpeed_j();
+    os << TeslaDisclosure::signedSuffix(disclosure);
     std::string bsmHex = pqcdsa::toHex(reinterpret_cast<const uint8_t*>(os.str().data()), os.str().size());
 
     // Sign with Falcon
@@ -742,6 +984,8 @@ void Mode4App::generateAndSendSPDU()
     auto sigTime = std::chrono::duration_cast<std::chrono::microseconds>(sigEnd - sigStart).count();
     emit(signatureTimeMs_, sigTime / 1000.0);
 
+    HybridSignature* hybrid = hybridSign(bsmHex);
+
 //    auto start_time = std::chrono::high_resolution_clock::now();
 //    const bool ok = pqcdsa::verify(bodyHex, sigHex, pubKeyHex);
 //    auto end_time = std::chrono::high_resolution_clock::now();
@@ -803,26 +1047,13 @@ void Mode4App::generateAndSendSPDU()
 
     // 2. Certificate: 1609.2 explicit cert
     //    version(1) + type(1) + issuer(9) + toBeSigned[cracaId(3) + crlSeries(2)
-    //    + validityPeriod(8) + appPermissions(~12) + verifyKeyIndicator(~2)]
-    //    + CA signature on cert (same algo): included in certOverhead
-    //    certOverhead covers all cert fields EXCEPT the raw verification key.
-    //    ECDSA: certOverhead(105) + pubkey(65) = 170B (matches literature ~170B)
-    //    PQC:   certOverhead(105) + pubkey(actual raw size from algorithm)
+    //    + validityPeriod(8) + appPermissions(~12) + verifyKeyIndicator(~2)] = 41
+    //    + CA signature on cert (same algo) + raw verification key, both sized
+    //    by the algorithm registry (pqcdsa::AlgorithmInfo).
+    //    ECDSA: 41 + signature(64) + pubkey(65) = 170B (matches literature ~170B)
     //
     //    Internal storage uses DER (91B for ECDSA) but wire uses raw point (65B).
-    //    For PQC, internal and wire sizes are the same (no DER wrapper).
-    long certOverhead  = 105;
-    long derPubKeySize = Cert.getPublicKeyArraySize();  // internal storage size
-    // ECDSA keys are stored internally as DER SubjectPublicKeyInfo (91B for P-256),
-    // but the 1609.2 wire format uses the raw uncompressed EC point (65B).
-    // PQC keys (Falcon, Dilithium) have no DER wrapper — internal = wire size.
-    std::string algo(Cert.getAlgoName());
-    bool isEcdsa = (algo.find("ECDSA") != std::string::npos
-                 || algo.find("ecdsa") != std::string::npos
-                 || algo.find("P-256") != std::string::npos
-                 || algo.find("P-384") != std::string::npos);
-    long rawPubKeySize = isEcdsa ? (derPubKeySize - 26) : derPubKeySize;
-    long certSize = certOverhead + rawPubKeySize;
+    long certSize = pqcdsa::algorithmInfo(Cert.getAlgoName()).certSize();
 
     // 3. SPDU 1609.2 Ieee1609Dot2Data wrapper + HeaderInfo
     //    protocolVersion(1) + contentType(1) + hashAlgorithm(1) + psid(~3)
@@ -832,14 +1063,29 @@ void Mode4App::generateAndSendSPDU()
     long totalByteLength = spduOverhead + bsmSize + spdu->getSignatureArraySize() + certOrDigestSize;
     spdu->setByteLength(totalByteLength);
 
-    EV_FATAL << "CRITICAL TEST: signature size : "<< spdu->getSignatureArraySize() <<endl;
+    // the encapsulated parts add their own length to the SPDU
+    if (hybrid) {
+        emit(hybridPqcBytesSignal_, hybrid->getByteLength());
+        if (disclosure)
+            hybrid->encapsulate(disclosure);
+        spdu->encapsulate(hybrid);
+    } else if (disclosure) {
+        spdu->encapsulate(disclosure);
+    }
+    if (disclosure) {
+        lastFullBsm_ = bsm;
+        hasFullBsm_ = true;
+        fullDigestBytes_ = spdu->getByteLength() - certOrDigestSize + 8;
+    }
 
-    EV_FATAL << "CRITICAL TEST: BSM size " << bsmSize << " bytes and Certificate size is "
+    LTE_EV_DIAG << "CRITICAL TEST: signature size : "<< spdu->getSignatureArraySize() <<endl;
+
+    LTE_EV_DIAG << "CRITICAL TEST: BSM size " << bsmSize << " bytes and Certificate size is "
             << certSize <<" bytes and public key size is "<< Cert.getPublicKeyArraySize() <<endl;
 
-    EV_FATAL << "CRITICAL TEST: fixed size is " << size_ << " bytes and calculated size is " << totalByteLength <<" bytes"<<endl;
+    LTE_EV_DIAG << "CRITICAL TEST: fixed size is " << size_ << " bytes and calculated size is " << totalByteLength <<" bytes"<<endl;
 
-    EV_FATAL << "CRITICAL TEST: calculating the SPDU size " << spdu->getByteLength() << " bytes." << endl;
+    LTE_EV_DIAG << "CRITICAL TEST: calculating the SPDU size " << spdu->getByteLength() << " bytes." << endl;
 
 
     // --- C-V2X MODE 4 SENDING LOGIC ---
@@ -852,11 +1098,85 @@ void Mode4App::generateAndSendSPDU()
     lteControlInfo->setDuration(duration_);
     spdu->setControlInfo(lteControlInfo);
     spdu->setTimestamp(simTime());
-    EV_FATAL << "CRITICAL TEST: Time of Creating the SPDU " << spdu->getTimestamp().dbl() * 1000.0 << endl;
+    LTE_EV_DIAG << "CRITICAL TEST: Time of Creating the SPDU " << spdu->getTimestamp().dbl() * 1000.0 << endl;
     Mode4BaseApp::sendLowerPackets(spdu);
 
     EV_INFO << "TX BSM#" << bsmSeq << "  speed=" << speed << "  sig=" << sigHex.substr(0,12) << "...\n";
     emit(sentMsg_, (long)1);
+
+    // the neighbours now extrapolate from these kinematics
+    if (congestion_)
+        congestion_->transmitted(simTime(), me, speed, heading);
+}
+
+HybridSignature* Mode4App::hybridSign(const std::string& bsmHex)
+{
+    if (hybridMode_ == HYBRID_OFF || (hybridMode_ == HYBRID_DUAL && bsmSeq % hybridPqcInterval_ != 0))
+        return nullptr;
+
+    auto sigStart = std::chrono::high_resolution_clock::now();
+    std::string sigHex = pqcdsa::sign(bsmHex, pqcKeyPair_.privHex);
+    auto sigEnd = std::chrono::high_resolution_clock::now();
+    emit(pqcSignatureTimeMsSignal_, std::chrono::duration_cast<std::chrono::microseconds>(sigEnd - sigStart).count() / 1000.0);
+
+    HybridSignature* hybrid = new HybridSignature();
+    hybrid->setComposite(hybridMode_ == HYBRID_COMPOSITE);
+    hybrid->setAlgoName(pqcCert_.getAlgoName());
+    hybrid->setSignature(pqcdsa::fromHex(sigHex));
+
+    // the PQC certificate is large: sent when new and periodically for the late receivers, by digest otherwise
+    ++pqcSignatures_;
+    if (!pqcCertSent_ || pqcSignatures_ % hybridPqcCertInterval_ == 0) {
+        hybrid->setCert(pqcCert_);
+        pqcCertSent_ = true;
+    } else {
+        hybrid->setCertDigest(pqcDigest_);
+    }
+
+    emit(hybridPqcSignedSignal_, 1);
+    return hybrid;
+}
+
+bool Mode4App::hybridCheck(HybridSignature* hybrid, const std::string& bsmHex)
+{
+    double verifyMs = 0;
+    switch (hybridVerifier_.check(hybrid, bsmHex, simTime(), verifyMs)) {
+        case HybridVerifier::VERIFIED:
+            emit(pqcVerifyTimeMsSignal_, verifyMs);
+            emit(hybridPqcVerifiedSignal_, 1);
+            return true;
+        case HybridVerifier::FAILED:
+            emit(pqcVerifyTimeMsSignal_, verifyMs);
+            emit(hybridPqcFailedSignal_, 1);
+            return false;
+        case HybridVerifier::NO_CERTIFICATE:
+            // a composite SPDU needs both signatures, a dual one stands on its ECDSA signature
+            emit(hybridPqcNoCertSignal_, 1);
+            return !hybrid->getComposite();
+        case HybridVerifier::QUEUED:
+            if (unsigned int dropped = hybridVerifier_.takeDropped())
+                emit(hybridPqcDroppedSignal_, dropped);
+            if (!pqcVerifyEvt_->isScheduled())
+                scheduleAt(simTime() + hybridLazyVerifyPeriod_, pqcVerifyEvt_);
+            return true;
+    }
+    return true;
+}
+
+void Mode4App::verifyQueuedPqc()
+{
+    for (const HybridVerifier::Outcome& outcome : hybridVerifier_.verifyQueued(hybridLazyVerifyBudget_)) {
+        emit(pqcVerifyTimeMsSignal_, outcome.verifyMs);
+        emit(hybridPqcVerifyDelaySignal_, simTime() - outcome.queued);
+        if (outcome.verified) {
+            emit(hybridPqcVerifiedSignal_, 1);
+        } else {
+            emit(hybridPqcFailedSignal_, 1);
+            EV_WARN << "PQC signature of " << outcome.sender << " received at " << outcome.queued << " is INVALID\n";
+        }
+    }
+    if (hybridVerifier_.hasQueued())
+        scheduleAt(simTime() + hybridLazyVerifyPeriod_, pqcVerifyEvt_);
 }
 
 // ============================================================================
@@ -891,25 +1211,15 @@ int Mode4App::myCohort()
     // vehicles traveling in the same direction (platoon members) are in the same cohort.
     // This is critical for safety: you need to hear BSMs from vehicles directly ahead/behind.
 
-    // Get velocity vector from TraCI mobility
-    double vx = 0.0;
-    double vy = 0.0;
-    bool hasVelocity = false;
-
-    for (cModule* m = this; m; m = m->getParentModule()) {
-        if (auto* mob = m->getSubmodule("veinsmobility")) {
-            if (auto* tm = dynamic_cast<veins::TraCIMobility*>(mob)) {
-                vx = tm->getSpeed() * cos(tm->getHeading().getRad());
-                vy = tm->getSpeed() * sin(tm->getHeading().getRad());
-                hasVelocity = true;
-                break;
-            }
-        }
-    }
+    // Velocity vector of this vehicle
+    double speed, heading;
+    getNodeKinematics(binder_->getNodeHandles(nodeId_), speed, heading);
+    double vx = speed * cos(heading);
+    double vy = speed * sin(heading);
 
     int cohort = 0;
 
-    if (hasVelocity && (vx != 0.0 || vy != 0.0)) {
+    if (vx != 0.0 || vy != 0.0) {
         // Calculate heading in degrees (0° = East, 90° = North, 180° = West, 270° = South)
         double heading_rad = atan2(vy, vx);
         double heading_deg = heading_rad * 180.0 / M_PI;
@@ -937,7 +1247,7 @@ int Mode4App::myCohort()
         }
     } else {
         // Fallback for stopped vehicles: use spatial hash
-        veins::Coord p = getNodePositionNow(this, simTime());
+        veins::Coord p = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
         int cx = (int)floor(p.x / ctacCellSize_);
         int cy = (int)floor(p.y / ctacCellSize_);
         unsigned int h = ((unsigned int)cx * 73856093u) ^ ((unsigned int)cy * 19349663u);
@@ -955,36 +1265,201 @@ bool Mode4App::safetyEventActive()
     return false;
 }
 
-void Mode4App::generateAndSendCompact()
+bool Mode4App::generateAndSendCompact()
 {
-    // For v1: Implement as a minimal BSM with digest-only cert.
-    // This is a simplified version of generateAndSendSPDU that always uses digest
-    // and could optionally use a reduced payload.
-    // For now, defer to the standard path with certInterval forced to non-zero
-    // (digest-only) to avoid transmitting full certificate.
-    //
-    // TODO: Implement a truly reduced payload if needed for compress mode.
-    // For this version, we simply defer (no transmission).
-    // This is acceptable per spec: "If time is short, implement
-    // generateAndSendCompact() as a direct call to the deferral path"
+    LTE_PROFILE_SCOPE("Mode4App", "generateAndSendCompact");
+    if (!hasFullBsm_ || compactIndex_ >= keyChain_.getLength())
+        return false;
+
+    veins::Coord me = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
+    double speed, heading;
+    getNodeKinematics(binder_->getNodeHandles(nodeId_), speed, heading);
+
+    // deltas from the last full BSM, in the units of the compact fields
+    long dLat = lround(((int32_t)(me.x * 1000) - lastFullBsm_.getLat()) / (double)CompactSpdu::POSITION_STEP);
+    long dLon = lround(((int32_t)(me.y * 1000) - lastFullBsm_.getLon()) / (double)CompactSpdu::POSITION_STEP);
+    long dSpeed = (long)(uint16_t)(speed / 0.02) - lastFullBsm_.getSpeed_j();
+    long dHeading = (long)(uint16_t)(heading / 0.0125) - lastFullBsm_.getHeading_j();
+    if (dLat < INT16_MIN || dLat > INT16_MAX || dLon < INT16_MIN || dLon > INT16_MAX
+        || dSpeed < INT8_MIN || dSpeed > INT8_MAX || dHeading < INT16_MIN || dHeading > INT16_MAX)
+        return false;
+
+    unsigned int index = ++compactIndex_;
+
+    CompactSpdu* compact = new CompactSpdu();
+    compact->setTempId((uint32_t)nodeId_);
+    compact->setMsgCnt(bsmSeq % 128);
+    compact->setMsgId(bsmSeq);
+    compact->setRefMsgCnt(lastFullBsm_.getMsgCnt());
+    compact->setSecMark((uint16_t)((int64_t)(simTime().dbl() * 1000) % 60000));
+    compact->setDLat((int16_t)dLat);
+    compact->setDLon((int16_t)dLon);
+    compact->setDSpeed((int8_t)dSpeed);
+    compact->setDHeading((int16_t)dHeading);
+    compact->setKeyIndex(index);
+    compact->setDisclosedKey(keyChain_.getKey(index - 1));
+    compact->setTag(TeslaKeyChain::mac(keyChain_.getKey(index), compact->getMacInput()));
+
+    auto lteControlInfo = new FlowControlInfoNonIp();
+    lteControlInfo->setDirection(D2D_MULTI);
+    lteControlInfo->setLcid(5);
+    lteControlInfo->setPriority(2);
+    lteControlInfo->setCreationTime(simTime());
+    lteControlInfo->setSrcAddr(nodeId_);
+    lteControlInfo->setDuration(duration_);
+    compact->setControlInfo(lteControlInfo);
+    compact->setTimestamp(simTime());
+    Mode4BaseApp::sendLowerPackets(compact);
+
+    EV_INFO << "TX compact BSM#" << bsmSeq << " key " << index << "/" << keyChain_.getLength() << '\n';
+    emit(sentMsg_, (long)1);
+    emit(compactSentSignal_, 1);
+    emit(compactBytesSavedSignal_, fullDigestBytes_ - CompactSpdu::WIRE_SIZE);
+
+    if (congestion_)
+        congestion_->transmitted(simTime(), me, speed, heading);
+    return true;
+}
+
+void Mode4App::handleCompact(CompactSpdu* compact)
+{
+    LTE_PROFILE_SCOPE("Mode4App", "handleCompact");
+    emit(compactReceivedSignal_, 1);
+
+    // rebuilt only against the full BSM the deltas refer to
+    auto it = compactPeers_.find(compact->getTempId());
+    if (it == compactPeers_.end() || it->second.reference.getMsgCnt() != compact->getRefMsgCnt()) {
+        EV_INFO << "RX compact BSM#" << compact->getMsgId() << " without its reference full BSM, dropped\n";
+        emit(compactReconstructFailedSignal_, 1);
+        delete compact;
+        return;
+    }
+    CompactPeer& peer = it->second;
+
+    const BSM& ref = peer.reference;
+    veins::Coord tx((ref.getLat() + compact->getDLat() * CompactSpdu::POSITION_STEP) / 1000.0,
+        (ref.getLon() + compact->getDLon() * CompactSpdu::POSITION_STEP) / 1000.0, 0.0);
+    veins::Coord rx = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
+    double dist_m = rx.distance(tx);
+    const double delay_ms = (simTime() - compact->getTimestamp()).dbl() * 1000.0;
+
+    // the disclosed key authenticates the previous compact SPDUs
+    unsigned int index = compact->getKeyIndex();
+    if (index > 1)
+        authenticateCompacts(compact->getTempId(), peer, index - 1, compact->getDisclosedKey());
+
+    // the key of the MAC must still be secret
+    if (index <= peer.trustedIndex) {
+        emit(compactAuthFailedSignal_, 1);
+    }
+    else {
+        PendingCompact& pending = peer.pending[index];
+        pending.tag = compact->getTag();
+        pending.macInput = compact->getMacInput();
+        pending.msgCnt = compact->getMsgCnt();
+        pending.distance = dist_m;
+    }
+
+    emit(compactReconstructedSignal_, 1);
+    emit(delay_, simTime() - compact->getTimestamp());
+    emit(received_, long(1));
+    // verified only when its key is disclosed (authenticateCompacts)
+    neighbours_->update(compact->getTempId(), tx, (ref.getSpeed_j() + compact->getDSpeed()) * 0.02,
+        (ref.getHeading_j() + compact->getDHeading()) * 0.0125, compact->getMsgCnt(), compact->getTimestamp(),
+        false, simTime());
+    emit(neighbourMsgCntGapSignal_, (long)neighbours_->find(compact->getTempId())->msgCntGap);
+    receptionMetrics_->received(compact->getTempId(), compact->getMsgId(), compact->getTimestamp(), dist_m, false,
+        simTime());
+
+    if (logV2vRx_) {
+        // same schema as the full SPDUs, with the MAC as signature; not verified yet, the
+        // MAC is checked when its key is disclosed (compactVerified)
+        const std::string v2vPath = getLogDirectory() + "/v2v_logs.csv";
+        std::ostringstream t;   t << std::fixed << std::setprecision(6) << simTime().dbl();
+        std::ostringstream lat; lat << std::fixed << std::setprecision(6) << tx.x;
+        std::ostringstream lon; lon << std::fixed << std::setprecision(6) << tx.y;
+        std::ostringstream dms; dms << std::fixed << std::setprecision(3) << delay_ms;
+        std::ostringstream dst; dst << std::fixed << std::setprecision(3) << dist_m;
+
+        appendCsv(v2vPath, V2V_LOG_HEADER, {
+            t.str(),
+            std::string(getParentModule()->getFullName()),
+            peer.sender,
+            std::to_string(compact->getMsgId()),
+            lat.str(),
+            lon.str(),
+            dst.str(),
+            dms.str(),
+            std::to_string(getNumVehicles()),
+            "0",
+            std::to_string(CompactSpdu::HEADER_SIZE),
+            "0",
+            "0",
+            "0",
+            std::to_string(TeslaKeyChain::TAG_SIZE),
+            std::to_string(CompactSpdu::DELTA_SIZE),
+            std::to_string(compact->getByteLength()),
+            "TESLA-compact",
+            "0"
+        });
+    }
 
-    // Do nothing - effectively defers the transmission
-    // In future versions, this could send a reduced BSM
+    EV_INFO << "RX compact BSM#" << compact->getMsgId() << " from " << peer.sender << " key " << index << '\n';
+    delete compact;
+}
+
+void Mode4App::authenticateCompacts(uint32_t tempId, CompactPeer& peer, unsigned int index,
+    const TeslaKeyChain::Key& key)
+{
+    if (index <= peer.trustedIndex)
+        return;     // already known
+    if (!TeslaKeyChain::authenticate(key, index, peer.trustedKey, peer.trustedIndex)) {
+        emit(compactAuthFailedSignal_, 1);
+        return;
+    }
+
+    auto it = peer.pending.begin();
+    while (it != peer.pending.end() && it->first <= index) {
+        const PendingCompact& pending = it->second;
+        TeslaKeyChain::Key k = TeslaKeyChain::derive(key, index, it->first);
+        if (TeslaKeyChain::mac(k, pending.macInput) == pending.tag) {
+            emit(compactVerifiedSignal_, 1);
+            emit(verified_, long(1));
+            receptionMetrics_->authenticated(tempId, pending.distance);
+            neighbours_->authenticated(tempId, pending.msgCnt);
+        }
+        else {
+            // forged kinematics must not stay in the neighbour table
+            emit(compactAuthFailedSignal_, 1);
+            neighbours_->rejected(tempId, pending.msgCnt);
+        }
+        it = peer.pending.erase(it);
+    }
+    peer.trustedKey = key;
+    peer.trustedIndex = index;
+}
+
+bool Mode4App::congestionAllows()
+{
+    if (congestion_->ittElapsed(simTime()))
+        return true;
+
+    // before the ITT, only when the neighbours lost track of this vehicle
+    veins::Coord me = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
+    double p = congestion_->trackingProbability(me, simTime());
+    if (p <= 0 || (p < 1 && uniform(0, 1) >= p))
+        return false;
+
+    emit(ccTrackingTxSignal_, 1);
+    return true;
 }
 
 int Mode4App::getNumVehicles() const
 {
+    // every registered UE but this one, without scanning the list on each reception
     auto ueList = binder_->getUeList();
-    if (!ueList) return 0;
-
-    int count = 0;
-    for (auto* info : *ueList) {
-        if (!info) continue;
-        // Skip our own node id (count only other vehicles)
-        if (info->id == nodeId_) continue;
-        ++count;
-    }
-    return count;
+    if (!ueList || ueList->empty()) return 0;
+    return (int)ueList->size() - 1;
 }
 
 // ============================================================================
@@ -995,13 +1470,15 @@ void Mode4App::finish()
 {
     simtime_t lifetime = simTime() - entryTime;
     emit(lifetimeSignal, lifetime);
-    EV_FATAL << "LIFETIME::" << lifetime << endl;
+    LTE_EV_DIAG << "LIFETIME::" << lifetime << endl;
 
     recordScalar("icaReceived", icaReceived_);
     recordScalar("icaExpected", icaExpected_);
     const double pdr = (icaExpected_ > 0) ? (double)icaReceived_ / (double)icaExpected_ : 0.0;
     recordScalar("icaPDR", pdr);
 
+    receptionMetrics_->record(this);
+
     // CTAC control overhead (zero by design in this version - no coordination messages)
     emit(ctrlOverheadBytesSignal_, 0);
 
@@ -1015,10 +1492,17 @@ void Mode4App::finish()
     });
 
     cancelAndDelete(sendEvt);
+    cancelAndDelete(pqcVerifyEvt_);
 }
 
 Mode4App::~Mode4App()
 {
+    if (spsTxTimingSignal_ != SIMSIGNAL_NULL && getParentModule()->isSubscribed(spsTxTimingSignal_, this))
+        getParentModule()->unsubscribe(spsTxTimingSignal_, this);
+
+    delete congestion_;
+    delete neighbours_;
+    delete receptionMetrics_;
 
     binder_->unregisterNode(nodeId_);
 
@@ -32,17 +32,25 @@
 #include "apps/mode4App/SPDU_m.h"
 #include "apps/mode4App/pqcdsa.h"
 #include "apps/mode4App/IcaWarn_m.h"
+#include "apps/mode4App/CompactSpdu.h"
+#include "apps/mode4App/HybridSignature.h"
+#include "apps/mode4App/J2945CongestionControl.h"
+#include "apps/mode4App/NeighbourTable.h"
+#include "apps/mode4App/ReceptionMetrics.h"
+#include "stack/phy/layer/LtePhyVUeMode4.h"
 
 #include <array>
 #include <map>
 
-class Mode4App : public Mode4BaseApp {
+class Mode4App : public Mode4BaseApp, public cListener {
 
 public:
     ~Mode4App() override;
 
     enum CtacDecision { CTAC_FULL, CTAC_COMPRESS, CTAC_DEFER };
 
+    enum HybridMode { HYBRID_OFF, HYBRID_DUAL, HYBRID_COMPOSITE };
+
 protected:
     //sender
     int size_;
@@ -90,6 +98,23 @@ protected:
     std::array<uint8_t,8> ownDigest_;                               // cached HashedId8 of own cert
     std::map<std::array<uint8_t,8>, Certificate> certCache_;        // receiver cert cache
 
+    // hybrid ECDSA + PQC signatures (hybridMode); keyPair and Cert are then the ECDSA ones
+    HybridMode hybridMode_ = HYBRID_OFF;
+    int       hybridPqcInterval_ = 1;       // a PQC signature every N BSMs ("dual")
+    int       hybridPqcCertInterval_ = 5;   // PQC certificate every N PQC signatures
+    pqcdsa::KeyPair pqcKeyPair_;
+    Certificate pqcCert_;
+    std::array<uint8_t,8> pqcDigest_;
+    bool      pqcCertSent_ = false;
+    long      pqcSignatures_ = 0;
+    HybridVerifier hybridVerifier_;         // PQC certificates and signatures of the received SPDUs
+    cMessage* pqcVerifyEvt_ = nullptr;      // verification of the queued PQC signatures
+    simtime_t hybridLazyVerifyPeriod_;
+    int       hybridLazyVerifyBudget_ = 0;
+    simsignal_t hybridPqcSignedSignal_, hybridPqcBytesSignal_, pqcSignatureTimeMsSignal_;
+    simsignal_t pqcVerifyTimeMsSignal_, hybridPqcVerifiedSignal_, hybridPqcFailedSignal_;
+    simsignal_t hybridPqcNoCertSignal_, hybridPqcVerifyDelaySignal_, hybridPqcDroppedSignal_;
+
     cMessage* sendEvt = nullptr;
     int       bsmSeq  = 0;
 
@@ -103,8 +128,60 @@ protected:
     bool      ctacSafetyOverride_ = true;
     simtime_t lastFullTx_ = SIMTIME_ZERO;
     long      numDeferred_ = 0;
+
+    // compact BSMs (CTAC "compress"), sender side
+    unsigned int compactChainLength_ = 16;  // compact SPDUs at most between two full ones
+    BSM       lastFullBsm_;                 // reference of the deltas
+    bool      hasFullBsm_ = false;
+    TeslaKeyChain keyChain_;                // chain anchored in the last full SPDU
+    unsigned int compactIndex_ = 0;         // compact SPDUs sent on it
+    long      fullDigestBytes_ = 0;         // size of the last full SPDU with a digest signer
+
+    // receiver side: a compact SPDU waiting for the key of its MAC
+    struct PendingCompact
+    {
+        TeslaKeyChain::Tag tag;
+        std::vector<uint8_t> macInput;
+        uint8_t msgCnt;
+        double distance;                    // m, at the reception
+    };
+    // receiver side: state of each sender from its last verified full SPDU
+    struct CompactPeer
+    {
+        BSM reference;
+        std::string sender;
+        TeslaKeyChain::Key trustedKey;      // latest authenticated key of the chain
+        unsigned int trustedIndex = 0;
+        std::map<unsigned int, PendingCompact> pending;     // by key index
+    };
+    std::map<uint32_t, CompactPeer> compactPeers_;
+
+    simsignal_t compactSentSignal_, compactBytesSavedSignal_, compactReceivedSignal_;
+    simsignal_t compactReconstructedSignal_, compactReconstructFailedSignal_;
+    simsignal_t compactVerifiedSignal_, compactAuthFailedSignal_, compactUnverifiedSignal_;
     bool      logV2vRx_ = true;
 
+    // generation aligned with the SPS occasions of the MAC (generationMode = "sps")
+    bool      spsAligned_ = false;
+    simtime_t spsLead_;                     // generation before the occasion
+    simtime_t spsPeriod_ = SIMTIME_ZERO;    // 0 until the MAC announced a reservation
+    simtime_t nextSpsTx_ = SIMTIME_ZERO;    // occasion targeted by the next BSM
+    simsignal_t spsTxTimingSignal_ = SIMSIGNAL_NULL;
+    simsignal_t spsRealignSignal_ = SIMSIGNAL_NULL;
+
+    // vehicles heard, from the verified BSMs and the rebuilt compact ones
+    NeighbourTable* neighbours_ = nullptr;
+    simsignal_t neighbourCountSignal_, neighbourAoISignal_, neighbourMsgCntGapSignal_;
+
+    // IPG, AoI and PDR per distance of the BSMs received, recorded at finish()
+    ReceptionMetrics* receptionMetrics_ = nullptr;
+
+    // J2945/1 congestion control (congestionControl = "j2945"), NULL when disabled
+    J2945CongestionControl* congestion_ = nullptr;
+    LtePhyVUeMode4* phy_ = nullptr;
+    simsignal_t ccIttSignal_, ccTxPowerSignal_, ccCbrSignal_, ccDensitySignal_;
+    simsignal_t ccTrackingTxSignal_, ccSkippedSignal_;
+
     simsignal_t bsmOpportunitySignal_, ctacDeferredSignal_, ctacCompressedSignal_;
     simsignal_t ctacOverrideAoISignal_, ctacOverrideSafetySignal_;
     simsignal_t ctrlOverheadBytesSignal_, ctacCohortIdSignal_;
@@ -119,16 +196,34 @@ protected:
 
    void handleSelfMessage(cMessage* msg) override;
 
+   // new reservation announced by the MAC (spsTxTiming)
+   void receiveSignal(cComponent* source, simsignal_t signalID, cObject* obj, cObject* details) override;
+
    void sendLowerPackets(cPacket* pkt);
 
    void generateAndSendSPDU();
-   void generateAndSendCompact();
+   // PQC part of the SPDU signing "bsmHex" in hybrid mode, NULL when this BSM has none
+   HybridSignature* hybridSign(const std::string& bsmHex);
+   // checks the PQC part of a received SPDU; false if it invalidates the SPDU
+   bool hybridCheck(HybridSignature* hybrid, const std::string& bsmHex);
+   void verifyQueuedPqc();
+   // false when no compact SPDU can be sent (no reference, chain used up, deltas out of range)
+   bool generateAndSendCompact();
+   void handleCompact(CompactSpdu* compact);
+   // checks the pending compact SPDUs of the peer up to the disclosed key; they count as verified from then on
+   void authenticateCompacts(uint32_t tempId, CompactPeer& peer, unsigned int index, const TeslaKeyChain::Key& key);
 
    CtacDecision ctacDecide();
    int  myCohort();
    bool safetyEventActive();
+
+   // whether the J2945/1 congestion control lets a BSM out at this opportunity
+   bool congestionAllows();
    int  getNumVehicles() const;
 
+  public:
+   // what this vehicle knows of its neighbours from their BSMs
+   const NeighbourTable& getNeighbourTable() const { return *neighbours_; }
 };
 
 #endif
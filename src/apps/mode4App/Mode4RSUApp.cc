@@ -1,6 +1,8 @@
 #include "apps/mode4App/Mode4RSUApp.h"
+#include "apps/mode4App/CertificateUtils.h"
+#include "apps/mode4App/CompactSpdu.h"
 #include "common/LteControlInfo.h"
-#include "stack/phy/packet/cbr_m.h"
+#include "stack/phy/packet/Cbr.h"
 #include <sstream>
 #include "apps/mode4App/IcaWarn_m.h"          // the new message
 #include <nlohmann/json.hpp>
@@ -19,6 +21,7 @@ using nlohmann::json;
 #include "veins/base/modules/BaseMobility.h"
 #include "veins/base/utils/Coord.h"
 #include "apps/mode4App/IcaSpdu_m.h"
+#include "common/LteLog.h"
 
 Define_Module(Mode4RSUApp);
 //using namespace lte::apps::mode4App;
@@ -115,36 +118,15 @@ static std::string icaBodyHex(const IcaWarn& w)
     return pqcdsa::toHex(reinterpret_cast<const uint8_t*>(os.str().data()), os.str().size());
 }
 
-static veins::Coord getNodePositionNow(cModule* context, simtime_t t) {
-    for (cModule* m = context; m; m = m->getParentModule()) {
-        if (auto* mob = m->getSubmodule("veinsmobility")) {
-            if (auto* tm = dynamic_cast<veins::TraCIMobility*>(mob))
-                return tm->getPositionAt(t);
-            if (auto* bm = dynamic_cast<veins::BaseMobility*>(mob))
-                return bm->getPositionAt(t);
-        }
-    }
+// mobility of the node as the binder resolved it at registration
+static veins::Coord getNodePositionNow(const LteBinder::NodeHandles* node, simtime_t t) {
+    if (node && node->traciMobility)
+        return node->traciMobility->getPositionAt(t);
+    if (node && node->mobility)
+        return node->mobility->getPositionAt(t);
     return veins::Coord(0,0,0); // fallback if not found
 }
 
-static std::array<uint8_t,8> computeHashedId8(const Certificate& c) {
-    std::ostringstream os;
-    os << (int)c.getVersion() << '|' << (int)c.getCertType() << '|'
-       << (int)c.getIssuerType() << '|' << c.getSubjectId() << '|'
-       << (int)c.getAppPermPsid() << '|' << c.getAlgoName();
-    for (size_t i = 0; i < c.getPublicKeyArraySize(); i++)
-        os << (int)c.getPublicKey(i) << ',';
-    std::string s = os.str();
-
-    uint8_t hash[32];
-    unsigned int len = 0;
-    EVP_Digest(s.data(), s.size(), hash, &len, EVP_sha256(), nullptr);
-
-    std::array<uint8_t,8> id8;
-    std::memcpy(id8.data(), hash + 24, 8);
-    return id8;
-}
-
 void Mode4RSUApp::openNonBlockingUdp_(int port)
 {
     sockFd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
@@ -216,7 +198,7 @@ void Mode4RSUApp::initialize(int stage)
         std::string tag   = pqcdsa::algoTagFromKey(keyPair_.pubHex);
         std::string label = pqcdsa::prettyNameFromTag(tag);
         cert_.setAlgoName(label.c_str());
-        EV_FATAL << "Public Key Length: " << keyPair_.pubKeyLength << " bytes" << endl;
+        LTE_EV_DIAG << "Public Key Length: " << keyPair_.pubKeyLength << " bytes" << endl;
         auto pkBytes = pqcdsa::fromHex(keyPair_.pubHex);
 
         cert_.setSubjectId(getParentModule()->getParentModule()->getFullName());
@@ -246,6 +228,18 @@ void Mode4RSUApp::initialize(int stage)
         icaSignMs = registerSignal("icaSignMs");
         verifyTimeMs_ = registerSignal("verifyTimeMs");
 
+        hybridLazyVerifyPeriod_ = par("hybridLazyVerifyPeriod");
+        hybridLazyVerifyBudget_ = par("hybridLazyVerifyBudget").intValue();
+        if (par("hybridLazyVerifyQueue").intValue() < 0)
+            throw cRuntimeError("Mode4RSUApp::initialize - invalid hybridLazyVerifyQueue");
+        hybridVerifier_.setQueueLimit(par("hybridLazyVerifyQueue").intValue());
+        pqcVerifyEvt_ = new cMessage("pqcVerify");
+        pqcVerifyTimeMs_ = registerSignal("pqcVerifyTimeMs");
+        hybridPqcVerified_ = registerSignal("hybridPqcVerified");
+        hybridPqcFailed_ = registerSignal("hybridPqcFailed");
+        hybridPqcNoCert_ = registerSignal("hybridPqcNoCert");
+        hybridPqcVerifyDelay_ = registerSignal("hybridPqcVerifyDelay");
+        hybridPqcDropped_ = registerSignal("hybridPqcDropped");
     }
 }
 
@@ -328,16 +322,10 @@ void Mode4RSUApp::broadcastIca(IcaWarn* w)
     spdu->setControlInfo(ci);
 
     spdu->setTimestamp(simTime());
-    // 1609.2 wrapper (28) + IcaWarn payload (64) + cert overhead (105)
-    long icaWrapperAndPayload = 28 + 64 + 105;
-    long icaDerPkSize = spdu->getCert().getPublicKeyArraySize();
-    std::string icaAlgo(spdu->getCert().getAlgoName());
-    bool icaIsEcdsa = (icaAlgo.find("ECDSA") != std::string::npos
-                    || icaAlgo.find("ecdsa") != std::string::npos
-                    || icaAlgo.find("P-256") != std::string::npos
-                    || icaAlgo.find("P-384") != std::string::npos);
-    long icaRawPkSize = icaIsEcdsa ? (icaDerPkSize - 26) : icaDerPkSize;
-    spdu->setByteLength(icaWrapperAndPayload + spdu->getSignatureArraySize() + icaRawPkSize);
+    // 1609.2 wrapper (28) + IcaWarn payload (64) + certificate
+    long icaWrapperAndPayload = 28 + 64;
+    long icaCertSize = pqcdsa::algorithmInfo(spdu->getCert().getAlgoName()).certSize();
+    spdu->setByteLength(icaWrapperAndPayload + spdu->getSignatureArraySize() + icaCertSize);
 
     // 5) send
     Mode4BaseApp::sendLowerPackets(spdu);
@@ -379,10 +367,25 @@ void Mode4RSUApp::handleSelfMessage(cMessage* msg)
     //     scheduleAt(simTime() + par("socketPollInterval"), sockPollEvt_);
     //     return;
     // }
+    if (msg == pqcVerifyEvt_) {
+        verifyQueuedPqc();
+        return;
+    }
     // RSU has no other timers
     delete msg;
 }
 
+void Mode4RSUApp::verifyQueuedPqc()
+{
+    for (const HybridVerifier::Outcome& outcome : hybridVerifier_.verifyQueued(hybridLazyVerifyBudget_)) {
+        emit(pqcVerifyTimeMs_, outcome.verifyMs);
+        emit(hybridPqcVerifyDelay_, simTime() - outcome.queued);
+        emit(outcome.verified ? hybridPqcVerified_ : hybridPqcFailed_, 1);
+    }
+    if (hybridVerifier_.hasQueued())
+        scheduleAt(simTime() + hybridLazyVerifyPeriod_, pqcVerifyEvt_);
+}
+
 void Mode4RSUApp::handleLowerMessage(cMessage* msg)
 {
     if (msg->isName("CBR")) {
@@ -409,7 +412,7 @@ void Mode4RSUApp::handleLowerMessage(cMessage* msg)
 
     EV<< "CRITICAL TEST: Received Timestamp: "<< simTime().dbl() * 1000.0 << endl;
     // RSU receiver position (meters)
-    veins::Coord rsu = getNodePositionNow(this, simTime());
+    veins::Coord rsu = getNodePositionNow(binder_->getNodeHandles(nodeId_), simTime());
 
     // Transmitter position recovered from J2735 integer fields
     const BSM& b = spdu->getBsm();
@@ -421,6 +424,7 @@ void Mode4RSUApp::handleLowerMessage(cMessage* msg)
     // Verification (must match sender's serialization exactly)
     std::ostringstream os;
     os << b.getMsgId() << ',' << b.getLat() << ',' << b.getLon() << ',' << b.getHeading_j() << ',' << b.getSpeed_j();
+    os << TeslaDisclosure::signedSuffix(TeslaDisclosure::find(spdu));
     std::string bsmHex = pqcdsa::toHex(reinterpret_cast<const uint8_t*>(os.str().data()), os.str().size());
 
     // Cert cache: resolve certificate from signerType
@@ -463,6 +467,34 @@ void Mode4RSUApp::handleLowerMessage(cMessage* msg)
         auto verifyUs = std::chrono::duration_cast<std::chrono::microseconds>(verifyEnd - verifyStart).count();
         emit(verifyTimeMs_, verifyUs / 1000.0);
     }
+
+    // hybrid SPDU: ECDSA checked above, the PQC signature now if composite, later otherwise
+    HybridSignature* hybrid = HybridSignature::find(spdu);
+    if (hybrid) {
+        double pqcMs = 0;
+        switch (hybridVerifier_.check(hybrid, bsmHex, simTime(), pqcMs)) {
+            case HybridVerifier::VERIFIED:
+                emit(pqcVerifyTimeMs_, pqcMs);
+                emit(hybridPqcVerified_, 1);
+                break;
+            case HybridVerifier::FAILED:
+                emit(pqcVerifyTimeMs_, pqcMs);
+                emit(hybridPqcFailed_, 1);
+                ok = false;
+                break;
+            case HybridVerifier::NO_CERTIFICATE:
+                emit(hybridPqcNoCert_, 1);
+                if (hybrid->getComposite())
+                    ok = false;
+                break;
+            case HybridVerifier::QUEUED:
+                if (unsigned int dropped = hybridVerifier_.takeDropped())
+                    emit(hybridPqcDropped_, dropped);
+                if (!pqcVerifyEvt_->isScheduled())
+                    scheduleAt(simTime() + hybridLazyVerifyPeriod_, pqcVerifyEvt_);
+                break;
+        }
+    }
     if (ok) emit(rsuVerifiedMsg, 1);
 
     EV_INFO << "RSU RX BSM#" << b.getMsgId()
@@ -492,14 +524,20 @@ void Mode4RSUApp::handleLowerMessage(cMessage* msg)
         digestSize = 8;  // HashedId8
         // pk_size stays 0 — not in packet
     } else if (useCert) {
-        // Full cert in packet
-        certMetadata = 105;  // cert fields excluding pubkey
-        long derPubKeySize = useCert->getPublicKeyArraySize();
-        bool isEcdsa = (algoName.find("ECDSA") != std::string::npos
-                     || algoName.find("ecdsa") != std::string::npos
-                     || algoName.find("P-256") != std::string::npos
-                     || algoName.find("P-384") != std::string::npos);
-        pkSize = isEcdsa ? (derPubKeySize - 26) : derPubKeySize;
+        // Full cert in packet, sized by the algorithm registry
+        const pqcdsa::AlgorithmInfo& info = pqcdsa::algorithmInfo(algoName);
+        certMetadata = info.certMetadataSize();  // cert fields excluding pubkey
+        pkSize = info.publicKeySize;
+    }
+
+    // PQC part of a hybrid SPDU: its own header, signature and certificate or digest
+    if (hybrid) {
+        spduOverhead += HybridSignature::HEADER_SIZE;
+        certMetadata += hybrid->getCertMetadataSize();
+        digestSize += hybrid->getDigestSize();
+        pkSize += hybrid->getPublicKeySize();
+        sigSize += hybrid->getSignatureSize();
+        algoName += std::string("+") + hybrid->getAlgoName();
     }
 
     long bsmDataSize = 1 + 4 + 4 + 2 + 4 + 4 + 2  // msgCnt+msgId+tempId+secMark+lat+lon+elev
@@ -550,6 +588,8 @@ void Mode4RSUApp::handleLowerMessage(cMessage* msg)
 void Mode4RSUApp::finish()
 {
     simtime_t endtime = simTime();
+    cancelAndDelete(pqcVerifyEvt_);
+    pqcVerifyEvt_ = nullptr;
 }
 
 Mode4RSUApp::~Mode4RSUApp()
@@ -8,6 +8,7 @@
 #include "apps/mode4App/pqcdsa.h"
 #include "corenetwork/binder/LteBinder.h"
 #include "apps/mode4App/IcaWarn_m.h"
+#include "apps/mode4App/HybridSignature.h"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -42,6 +43,18 @@ class Mode4RSUApp : public Mode4BaseApp
 
     std::map<std::array<uint8_t,8>, Certificate> certCache_;  // receiver cert cache
 
+    // PQC parts of the hybrid SPDUs, the dual ones verified every hybridLazyVerifyPeriod
+    HybridVerifier hybridVerifier_;
+    cMessage*    pqcVerifyEvt_ = nullptr;
+    simtime_t    hybridLazyVerifyPeriod_;
+    int          hybridLazyVerifyBudget_ = 0;
+    simsignal_t  pqcVerifyTimeMs_ = SIMSIGNAL_NULL;
+    simsignal_t  hybridPqcVerified_ = SIMSIGNAL_NULL;
+    simsignal_t  hybridPqcFailed_ = SIMSIGNAL_NULL;
+    simsignal_t  hybridPqcNoCert_ = SIMSIGNAL_NULL;
+    simsignal_t  hybridPqcVerifyDelay_ = SIMSIGNAL_NULL;
+    simsignal_t  hybridPqcDropped_ = SIMSIGNAL_NULL;
+
     LteBinder* binder_;
     MacNodeId nodeId_;
 
@@ -53,6 +66,7 @@ class Mode4RSUApp : public Mode4BaseApp
     void socketRead();
     void broadcastIca(IcaWarn* w);
     void finish();
+    void verifyQueuedPqc();
     int getNumVehicles() const;
 
 };
@@ -0,0 +1,220 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/NeighbourTable.h"
+
+#include <algorithm>
+
+using namespace omnetpp;
+
+// msgCnt of the BSMs wraps at 128
+static const unsigned int MSG_CNT_MODULO = 128;
+
+static const size_t INITIAL_SLOTS = 64;
+static const unsigned int INITIAL_SHIFT = 32 - 6;
+
+NeighbourTable::NeighbourTable(simtime_t expiry) :
+    expiry_(expiry),
+    slots_(INITIAL_SLOTS),
+    shift_(INITIAL_SHIFT),
+    size_(0)
+{
+    if (expiry_ <= SIMTIME_ZERO)
+        throw cRuntimeError("NeighbourTable - expiry must be positive");
+}
+
+size_t NeighbourTable::home(uint32_t id) const
+{
+    // Fibonacci hashing, the tempIds being consecutive node ids
+    return (uint32_t)(id * 2654435769u) >> shift_;
+}
+
+size_t NeighbourTable::indexOf(uint32_t id) const
+{
+    size_t mask = slots_.size() - 1;
+    for (size_t i = home(id); slots_[i].used; i = (i + 1) & mask)
+    {
+        if (slots_[i].entry.id == id)
+            return i;
+    }
+    return slots_.size();
+}
+
+void NeighbourTable::update(uint32_t id, const veins::Coord& position, double speed, double heading,
+    uint8_t msgCnt, simtime_t generated, bool verified, simtime_t now)
+{
+    size_t index = indexOf(id);
+    if (index == slots_.size())
+    {
+        // at most half full
+        if (2 * (size_ + 1) > slots_.size())
+            grow();
+
+        size_t mask = slots_.size() - 1;
+        index = home(id);
+        while (slots_[index].used)
+            index = (index + 1) & mask;
+
+        Slot& slot = slots_[index];
+        slot.used = true;
+        slot.entry = Entry();
+        slot.entry.id = id;
+        slot.entry.msgCntGap = 0;
+        slot.entry.received = 0;
+        slot.entry.missed = 0;
+        size_++;
+    }
+    else
+    {
+        Entry& known = slots_[index].entry;
+        known.msgCntGap = (msgCnt + MSG_CNT_MODULO - known.msgCnt - 1) % MSG_CNT_MODULO;
+        known.missed += known.msgCntGap;
+    }
+
+    Entry& entry = slots_[index].entry;
+    entry.position = position;
+    entry.speed = speed;
+    entry.heading = heading;
+    entry.msgCnt = msgCnt;
+    entry.generated = generated;
+    entry.lastHeard = now;
+    entry.verified = verified;
+    entry.received++;
+}
+
+void NeighbourTable::authenticated(uint32_t id, uint8_t msgCnt)
+{
+    size_t index = indexOf(id);
+    if (index != slots_.size() && slots_[index].entry.msgCnt == msgCnt)
+        slots_[index].entry.verified = true;
+}
+
+void NeighbourTable::rejected(uint32_t id, uint8_t msgCnt)
+{
+    size_t index = indexOf(id);
+    if (index != slots_.size() && slots_[index].entry.msgCnt == msgCnt)
+        erase(index);
+}
+
+void NeighbourTable::erase(size_t index)
+{
+    // backward shift: moves back the entries that probed past the freed slot
+    size_t mask = slots_.size() - 1;
+    size_t hole = index;
+    for (size_t i = (hole + 1) & mask; slots_[i].used; i = (i + 1) & mask)
+    {
+        size_t h = home(slots_[i].entry.id);
+        // the entry can move to the hole unless its home lies in (hole, i]
+        bool between = (hole <= i) ? (h > hole && h <= i) : (h > hole || h <= i);
+        if (!between)
+        {
+            slots_[hole] = slots_[i];
+            hole = i;
+        }
+    }
+    slots_[hole].used = false;
+    size_--;
+}
+
+void NeighbourTable::expire(simtime_t now)
+{
+    for (size_t i = 0; i < slots_.size();)
+    {
+        // a shifted entry lands in slot i, check it again
+        if (slots_[i].used && now - slots_[i].entry.lastHeard > expiry_)
+            erase(i);
+        else
+            i++;
+    }
+}
+
+void NeighbourTable::grow()
+{
+    std::vector<Slot> old(2 * slots_.size());
+    old.swap(slots_);
+    shift_--;
+
+    size_t mask = slots_.size() - 1;
+    for (const Slot& slot : old)
+    {
+        if (!slot.used)
+            continue;
+        size_t i = home(slot.entry.id);
+        while (slots_[i].used)
+            i = (i + 1) & mask;
+        slots_[i] = slot;
+    }
+}
+
+const NeighbourTable::Entry* NeighbourTable::find(uint32_t id) const
+{
+    size_t index = indexOf(id);
+    return index == slots_.size() ? nullptr : &slots_[index].entry;
+}
+
+int NeighbourTable::countWithin(const veins::Coord& center, double range, simtime_t now, simtime_t maxAge) const
+{
+    int count = 0;
+    double range2 = range * range;
+    for (const Slot& slot : slots_)
+    {
+        if (slot.used && now - slot.entry.lastHeard <= maxAge && center.sqrdist(slot.entry.position) <= range2)
+            count++;
+    }
+    return count;
+}
+
+std::vector<const NeighbourTable::Entry*> NeighbourTable::nearest(const veins::Coord& center, size_t k,
+    simtime_t now, simtime_t maxAge) const
+{
+    std::vector<std::pair<double, const Entry*> > candidates;
+    for (const Slot& slot : slots_)
+    {
+        if (slot.used && now - slot.entry.lastHeard <= maxAge)
+            candidates.push_back(std::make_pair(center.sqrdist(slot.entry.position), &slot.entry));
+    }
+
+    k = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(),
+        [](const std::pair<double, const Entry*>& a, const std::pair<double, const Entry*>& b) {
+            return a.first < b.first;
+        });
+
+    std::vector<const Entry*> result;
+    result.reserve(k);
+    for (size_t i = 0; i < k; i++)
+        result.push_back(candidates[i].second);
+    return result;
+}
+
+simtime_t NeighbourTable::ageOfInformation(uint32_t id, simtime_t now) const
+{
+    const Entry* entry = find(id);
+    return entry ? now - entry->generated : SimTime(-1);
+}
+
+simtime_t NeighbourTable::meanAgeOfInformation(simtime_t now) const
+{
+    if (size_ == 0)
+        return SIMTIME_ZERO;
+
+    simtime_t total = SIMTIME_ZERO;
+    for (const Slot& slot : slots_)
+    {
+        if (slot.used)
+            total += now - slot.entry.generated;
+    }
+    return total / (double)size_;
+}
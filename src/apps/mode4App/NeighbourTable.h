@@ -0,0 +1,111 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_NEIGHBOURTABLE_H_
+#define _LTE_NEIGHBOURTABLE_H_
+
+#include <omnetpp.h>
+#include <vector>
+
+#include "veins/base/utils/Coord.h"
+
+/**
+ * Neighbours of a vehicle as its BSMs describe them: what the application
+ * knows of the vehicles around, rather than the ground truth of the binder
+ * or of the mobility modules.
+ *
+ * One entry per sender (BSM tempId) with the kinematics of its last BSM,
+ * the losses seen in its msgCnt sequence and whether the BSM was verified.
+ * A BSM authenticated after its reception (a compact SPDU, whose MAC key
+ * is disclosed later) is confirmed by authenticated(), or its entry
+ * removed by rejected() when the check fails.
+ * Entries not refreshed for "expiry" are removed by expire(); the queries
+ * also take a maximum age, to look at a shorter window.
+ *
+ * Flat open-addressing hash map (linear probing, backward-shift deletion):
+ * the table is updated on every reception and queried on every CBR report.
+ */
+class NeighbourTable
+{
+  public:
+    struct Entry
+    {
+        uint32_t id;                // tempId of the BSMs
+        veins::Coord position;
+        double speed;               // m/s
+        double heading;             // rad
+        uint8_t msgCnt;
+        unsigned int msgCntGap;     // BSMs missed just before the last one
+        unsigned long received;
+        unsigned long missed;
+        omnetpp::simtime_t generated;   // generation time of the last BSM
+        omnetpp::simtime_t lastHeard;
+        bool verified;
+    };
+
+    explicit NeighbourTable(omnetpp::simtime_t expiry);
+
+    // A BSM was received from "id"
+    void update(uint32_t id, const veins::Coord& position, double speed, double heading, uint8_t msgCnt,
+        omnetpp::simtime_t generated, bool verified, omnetpp::simtime_t now);
+
+    // The BSM msgCnt of "id", received unverified, was authenticated: the entry becomes verified if it is the last one
+    void authenticated(uint32_t id, uint8_t msgCnt);
+
+    // The BSM msgCnt of "id" failed its authentication: the entry is removed if it comes from it
+    void rejected(uint32_t id, uint8_t msgCnt);
+
+    // Removes the neighbours not heard for the expiry time
+    void expire(omnetpp::simtime_t now);
+
+    // NULL if unknown
+    const Entry* find(uint32_t id) const;
+
+    size_t size() const { return size_; }
+
+    // Neighbours heard in the last maxAge whose last position is within range of "center", with
+    // the ones whose last BSM still waits for its authentication
+    int countWithin(const veins::Coord& center, double range, omnetpp::simtime_t now, omnetpp::simtime_t maxAge) const;
+
+    // The k neighbours heard in the last maxAge closest to "center", closest first
+    std::vector<const Entry*> nearest(const veins::Coord& center, size_t k, omnetpp::simtime_t now,
+        omnetpp::simtime_t maxAge) const;
+
+    // Age of the information held about "id", -1 if unknown
+    omnetpp::simtime_t ageOfInformation(uint32_t id, omnetpp::simtime_t now) const;
+
+    // Mean age of the information over the table, 0 if empty
+    omnetpp::simtime_t meanAgeOfInformation(omnetpp::simtime_t now) const;
+
+  private:
+    struct Slot
+    {
+        Slot() : used(false) {}
+        bool used;
+        Entry entry;
+    };
+
+    omnetpp::simtime_t expiry_;
+    std::vector<Slot> slots_;   // power of two
+    unsigned int shift_;        // 32 - log2(slots_.size())
+    size_t size_;
+
+    size_t home(uint32_t id) const;
+    size_t indexOf(uint32_t id) const;   // slots_.size() if absent
+    void erase(size_t index);
+    void grow();
+};
+
+#endif
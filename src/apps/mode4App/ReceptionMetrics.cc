@@ -0,0 +1,192 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/ReceptionMetrics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace omnetpp;
+
+ReceptionMetrics::ReceptionMetrics(const Params& params) :
+    params_(params),
+    ipgHistogram_("bsmIpg")
+{
+    if (params_.distanceBin <= 0 || params_.distanceBins < 1)
+        throw cRuntimeError("ReceptionMetrics - invalid distance bins");
+    if (params_.ipgBin <= SIMTIME_ZERO || params_.ipgBins < 1)
+        throw cRuntimeError("ReceptionMetrics - invalid IPG bins");
+
+    ipgHistogram_.setStrategy(new cFixedRangeHistogramStrategy(0, (params_.ipgBin * params_.ipgBins).dbl(),
+        params_.ipgBins, cHistogram::MODE_REALS));
+    verified_.resize(params_.distanceBins, 0);
+    unverified_.resize(params_.distanceBins, 0);
+    missed_.resize(params_.distanceBins, 0);
+}
+
+int ReceptionMetrics::distanceBinOf(double distance) const
+{
+    return std::min((int)(distance / params_.distanceBin), params_.distanceBins - 1);
+}
+
+std::string ReceptionMetrics::distanceBinName(int bin) const
+{
+    std::ostringstream name;
+    name << bin * params_.distanceBin << "-";
+    if (bin == params_.distanceBins - 1)
+        name << "inf";
+    else
+        name << (bin + 1) * params_.distanceBin;
+    name << "m";
+    return name.str();
+}
+
+void ReceptionMetrics::received(uint32_t sender, long msgId, simtime_t generated, double distance, bool verified,
+    simtime_t now)
+{
+    int bin = distanceBinOf(distance);
+    (verified ? verified_ : unverified_)[bin]++;
+
+    auto it = links_.find(sender);
+    if (it == links_.end())
+    {
+        Link link = Link();
+        link.lastMsgId = msgId;
+        link.lastRx = now;
+        link.lastGenerated = generated;
+        link.received = 1;
+        link.verified = verified ? 1 : 0;
+        links_[sender] = link;
+        return;
+    }
+
+    Link& link = it->second;
+    link.received++;
+    if (verified)
+        link.verified++;
+
+    simtime_t gap = now - link.lastRx;
+    bool up = gap <= params_.linkTimeout;
+    if (up)
+    {
+        ipgHistogram_.collect(gap);
+        link.ipgSum += gap.dbl();
+        link.ipgs++;
+
+        // the AoI grows linearly from its value at the last reception
+        double aoiBefore = (link.lastRx - link.lastGenerated).dbl();
+        link.upTime += gap.dbl();
+        link.aoiArea += gap.dbl() * (aoiBefore + gap.dbl() / 2);
+    }
+    link.lastRx = now;
+
+    // duplicates and late BSMs bring nothing new
+    if (msgId <= link.lastMsgId)
+        return;
+
+    if (up)
+    {
+        unsigned long lost = msgId - link.lastMsgId - 1;
+        link.missed += lost;
+        missed_[bin] += lost;
+
+        double peak = (now - link.lastGenerated).dbl();
+        link.peakAoISum += peak;
+        link.peakAoIMax = std::max(link.peakAoIMax, peak);
+        link.peaks++;
+    }
+    link.lastMsgId = msgId;
+    link.lastGenerated = generated;
+}
+
+void ReceptionMetrics::authenticated(uint32_t sender, double distance)
+{
+    int bin = distanceBinOf(distance);
+    if (unverified_[bin] > 0)
+    {
+        unverified_[bin]--;
+        verified_[bin]++;
+    }
+
+    auto it = links_.find(sender);
+    if (it != links_.end())
+        it->second.verified++;
+}
+
+void ReceptionMetrics::record(cComponent* owner)
+{
+    unsigned long received = 0, verified = 0, missed = 0, peaks = 0;
+    double upTime = 0, aoiArea = 0, peakAoISum = 0, peakAoIMax = 0;
+    for (const auto& entry : links_)
+    {
+        const Link& link = entry.second;
+        received += link.received;
+        verified += link.verified;
+        missed += link.missed;
+        upTime += link.upTime;
+        aoiArea += link.aoiArea;
+        peakAoISum += link.peakAoISum;
+        peakAoIMax = std::max(peakAoIMax, link.peakAoIMax);
+        peaks += link.peaks;
+
+        if (params_.perLink)
+        {
+            std::ostringstream prefix;
+            prefix << "bsmLink:" << std::hex << std::setfill('0') << std::setw(8) << entry.first << ":";
+            owner->recordScalar((prefix.str() + "received").c_str(), link.received);
+            owner->recordScalar((prefix.str() + "missed").c_str(), link.missed);
+            owner->recordScalar((prefix.str() + "pdr").c_str(), (double)link.received / (link.received + link.missed));
+            if (link.ipgs > 0)
+                owner->recordScalar((prefix.str() + "ipgMean").c_str(), link.ipgSum / link.ipgs, "s");
+            if (link.upTime > 0)
+                owner->recordScalar((prefix.str() + "aoiMean").c_str(), link.aoiArea / link.upTime, "s");
+            if (link.peaks > 0)
+                owner->recordScalar((prefix.str() + "peakAoIMean").c_str(), link.peakAoISum / link.peaks, "s");
+        }
+    }
+
+    owner->recordScalar("bsmLinks", links_.size());
+    owner->recordScalar("bsmReceived", received);
+    owner->recordScalar("bsmReceivedVerified", verified);
+    owner->recordScalar("bsmMissed", missed);
+    if (received > 0)
+        owner->recordScalar("bsmPdr", (double)received / (received + missed));
+
+    if (upTime > 0)
+        owner->recordScalar("bsmAoI:mean", aoiArea / upTime, "s");
+    if (peaks > 0)
+    {
+        owner->recordScalar("bsmAoI:peakMean", peakAoISum / peaks, "s");
+        owner->recordScalar("bsmAoI:peakMax", peakAoIMax, "s");
+    }
+
+    if (ipgHistogram_.getCount() > 0)
+        owner->recordStatistic(&ipgHistogram_, "s");
+
+    for (int bin = 0; bin < params_.distanceBins; bin++)
+    {
+        unsigned long binReceived = verified_[bin] + unverified_[bin];
+        if (binReceived == 0)
+            continue;
+
+        std::string prefix = "bsmPdr:" + distanceBinName(bin) + ":";
+        owner->recordScalar((prefix + "verified").c_str(), verified_[bin]);
+        owner->recordScalar((prefix + "unverified").c_str(), unverified_[bin]);
+        owner->recordScalar((prefix + "missed").c_str(), missed_[bin]);
+        owner->recordScalar((prefix + "pdr").c_str(), (double)binReceived / (binReceived + missed_[bin]));
+        owner->recordScalar((prefix + "pdrVerified").c_str(), (double)verified_[bin] / (binReceived + missed_[bin]));
+    }
+}
@@ -0,0 +1,104 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_RECEPTIONMETRICS_H_
+#define _LTE_RECEPTIONMETRICS_H_
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Reception metrics of the BSMs of a vehicle, computed while the simulation
+ * runs instead of from the per-packet v2v_logs.csv.
+ *
+ * For each sender (each link towards this receiver) it follows:
+ * - the inter-packet gap (IPG) between two receptions;
+ * - the age of information: its time average, integrated over the periods
+ *   the link is up, and its peaks, just before each fresher BSM;
+ * - the BSMs lost in between, from the gaps in the msgId sequence, which
+ *   counts only the generated BSMs.
+ * A link is up from its first reception until linkTimeout without any.
+ *
+ * Receptions, verified or not, and losses are binned by distance at the
+ * reception, losses going to the bin of the reception that revealed them:
+ * the PDR of a bin is received / (received + missed). A BSM authenticated
+ * after its reception (a compact SPDU, by the later disclosure of its key)
+ * moves from unverified to verified. The IPG goes to a histogram with
+ * ipgBins bins of ipgBin; nothing is stored per packet.
+ *
+ * record() writes the IPG histogram ("bsmIpg") and the totals of the receiver
+ * as scalars ("bsmPdr:<from>-<to>m:...", "bsmAoI:..."), and with perLink the
+ * ones of each link ("bsmLink:<sender>:...").
+ */
+class ReceptionMetrics
+{
+  public:
+    struct Params
+    {
+        double distanceBin;             // m
+        int distanceBins;               // the last one also takes any longer distance
+        omnetpp::simtime_t ipgBin;
+        int ipgBins;                    // longer gaps are counted as overflows
+        omnetpp::simtime_t linkTimeout;
+        bool perLink;
+    };
+
+    explicit ReceptionMetrics(const Params& params);
+
+    // The msgId-th BSM of "sender", generated at "generated", was received at the given distance
+    void received(uint32_t sender, long msgId, omnetpp::simtime_t generated, double distance, bool verified,
+        omnetpp::simtime_t now);
+
+    // A BSM of "sender" received unverified at the given distance was authenticated afterwards
+    void authenticated(uint32_t sender, double distance);
+
+    void record(omnetpp::cComponent* owner);
+
+  private:
+    struct Link
+    {
+        long lastMsgId;
+        omnetpp::simtime_t lastRx;
+        omnetpp::simtime_t lastGenerated;   // of the freshest BSM received
+
+        unsigned long received;
+        unsigned long verified;
+        unsigned long missed;
+
+        double upTime;          // s, while the link is up
+        double aoiArea;         // s^2, integral of the AoI over upTime
+        double ipgSum;          // s
+        unsigned long ipgs;
+        double peakAoISum;      // s
+        double peakAoIMax;      // s
+        unsigned long peaks;
+    };
+
+    Params params_;
+    std::unordered_map<uint32_t, Link> links_;
+
+    omnetpp::cHistogram ipgHistogram_;
+    std::vector<unsigned long> verified_;      // per distance bin
+    std::vector<unsigned long> unverified_;
+    std::vector<unsigned long> missed_;
+
+    int distanceBinOf(double distance) const;
+    std::string distanceBinName(int bin) const;
+};
+
+#endif
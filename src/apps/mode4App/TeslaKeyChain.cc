@@ -0,0 +1,81 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "apps/mode4App/TeslaKeyChain.h"
+
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+const size_t TeslaKeyChain::KEY_SIZE;
+const size_t TeslaKeyChain::TAG_SIZE;
+
+TeslaKeyChain::Key TeslaKeyChain::oneWay(const Key& key)
+{
+    uint8_t hash[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    EVP_Digest(key.data(), key.size(), hash, &len, EVP_sha256(), nullptr);
+
+    Key next;
+    std::memcpy(next.data(), hash, KEY_SIZE);
+    return next;
+}
+
+TeslaKeyChain::Tag TeslaKeyChain::mac(const Key& key, const std::vector<uint8_t>& data)
+{
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    HMAC(EVP_sha256(), key.data(), (int)key.size(), data.data(), data.size(), digest, &len);
+
+    Tag tag;
+    std::memcpy(tag.data(), digest, TAG_SIZE);
+    return tag;
+}
+
+bool TeslaKeyChain::authenticate(const Key& key, unsigned int index, const Key& trusted, unsigned int trustedIndex)
+{
+    if (index <= trustedIndex)
+        return false;
+    return derive(key, index, trustedIndex) == trusted;
+}
+
+TeslaKeyChain::Key TeslaKeyChain::derive(const Key& key, unsigned int keyIndex, unsigned int index)
+{
+    Key k = key;
+    for (unsigned int i = index; i < keyIndex; i++)
+        k = oneWay(k);
+    return k;
+}
+
+std::string TeslaKeyChain::toHex(const Key& key)
+{
+    static const char* digits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2 * KEY_SIZE);
+    for (size_t i = 0; i < KEY_SIZE; i++)
+    {
+        hex += digits[key[i] >> 4];
+        hex += digits[key[i] & 0xf];
+    }
+    return hex;
+}
+
+void TeslaKeyChain::generate(const Key& seed, unsigned int length)
+{
+    keys_.resize(length + 1);
+    keys_[length] = seed;
+    for (unsigned int i = length; i > 0; i--)
+        keys_[i - 1] = oneWay(keys_[i]);
+}
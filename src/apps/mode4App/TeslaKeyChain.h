@@ -0,0 +1,72 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_TESLAKEYCHAIN_H_
+#define _LTE_TESLAKEYCHAIN_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * One-way key chain of the TESLA-style authentication of the compact BSMs
+ * (ctacInactive = "compress").
+ *
+ * K_n is drawn at random and K_(i-1) = F(K_i): the anchor K_0, carried by a
+ * signed full SPDU, commits to the whole chain. The i-th compact SPDU after
+ * that full SPDU is authenticated by a MAC keyed with K_i and discloses
+ * K_(i-1); the last key used is disclosed by the next full SPDU. A receiver
+ * accepts a disclosed key when it hashes back to a key it already trusts,
+ * then checks the MACs of the compact SPDUs it kept for it.
+ */
+class TeslaKeyChain
+{
+  public:
+    static const size_t KEY_SIZE = 16;
+    static const size_t TAG_SIZE = 8;
+
+    typedef std::array<uint8_t, KEY_SIZE> Key;
+    typedef std::array<uint8_t, TAG_SIZE> Tag;
+
+    // F: SHA-256 truncated to the key size
+    static Key oneWay(const Key& key);
+
+    // HMAC-SHA256 truncated to the tag size
+    static Tag mac(const Key& key, const std::vector<uint8_t>& data);
+
+    // Whether "key", at position "index" of a chain, hashes to "trusted" at position "trustedIndex"
+    static bool authenticate(const Key& key, unsigned int index, const Key& trusted, unsigned int trustedIndex);
+
+    // Key at position "index", derived from a later key of the same chain
+    static Key derive(const Key& key, unsigned int keyIndex, unsigned int index);
+
+    static std::string toHex(const Key& key);
+
+    TeslaKeyChain() {}
+
+    // Builds a chain of "length" keys after the anchor, from the random K_length
+    void generate(const Key& seed, unsigned int length);
+
+    bool isEmpty() const { return keys_.empty(); }
+    unsigned int getLength() const { return keys_.empty() ? 0 : keys_.size() - 1; }
+    const Key& getAnchor() const { return keys_.at(0); }
+    const Key& getKey(unsigned int index) const { return keys_.at(index); }
+
+  private:
+    std::vector<Key> keys_;     // keys_[i] = K_i
+};
+
+#endif
@@ -1,5 +1,6 @@
 // pqcdsa.cc
 #include "pqcdsa.h"
+#include "common/LteProfiler.h"
 
 #include <stdexcept>
 #include <cstring>
@@ -19,22 +20,56 @@
 
 namespace {
 
-// ---- Algorithm enum & lookup ----
+// ---- Algorithm registry & lookup ----
+
+using pqcdsa::AlgorithmInfo;
+typedef const AlgorithmInfo* Alg;
+
+// liboqs names spelled out rather than the OQS_SIG_alg_* macros, which come and go
+// between liboqs releases: an algorithm missing from the build fails at key generation.
+// Built on first use, pqcdsa may be called from static initializers (benchmarks).
+static const std::vector<AlgorithmInfo>& registry() {
+    static const std::vector<AlgorithmInfo> algorithms = {
+        // tag                    prettyName               alias        oqsId                        lvl  pk     sig    var    cert  keyGen  sign    verify
+        { "ecdsa",                "ECDSA P-256",           "p256",      nullptr,                     1,   65,    64,    false, 41,   0.02,   0.03,   0.09 },
+        { "falcon-512",           "Falcon-512",            "falcon",    "Falcon-padded-512",         1,   897,   666,   false, 41,   7.0,    0.20,   0.04 },
+        { "falcon-512-unpadded",  "Falcon-512 (unpadded)", nullptr,     "Falcon-512",                1,   897,   752,   true,  41,   7.0,    0.20,   0.04 },
+        { "falcon-1024",          "Falcon-1024",           nullptr,     "Falcon-padded-1024",        5,   1793,  1280,  false, 41,   21.0,   0.40,   0.08 },
+        { "dilithium-2",          "Dilithium 2",           "dilithium", "Dilithium2",                2,   1312,  2420,  false, 41,   0.03,   0.08,   0.03 },
+        { "ml-dsa-44",            "ML-DSA-44",             nullptr,     "ML-DSA-44",                 2,   1312,  2420,  false, 41,   0.03,   0.09,   0.03 },
+        { "ml-dsa-65",            "ML-DSA-65",             nullptr,     "ML-DSA-65",                 3,   1952,  3309,  false, 41,   0.05,   0.14,   0.05 },
+        { "sphincs-sha2-128s",    "SPHINCS+-SHA2-128s",    nullptr,     "SPHINCS+-SHA2-128s-simple", 1,   32,    7856,  false, 41,   15.0,   115.0,  0.12 },
+        { "sphincs-sha2-128f",    "SPHINCS+-SHA2-128f",    nullptr,     "SPHINCS+-SHA2-128f-simple", 1,   32,    17088, false, 41,   0.25,   5.5,    0.35 },
+        { "mayo-1",               "MAYO-1",                nullptr,     "MAYO-1",                    1,   1420,  454,   false, 41,   0.08,   0.15,   0.06 },
+        { "mayo-2",               "MAYO-2",                nullptr,     "MAYO-2",                    1,   4912,  186,   false, 41,   0.20,   0.20,   0.07 },
+    };
+    return algorithms;
+}
 
-enum class Alg { ECDSA_P256, FALCON_512, DILITHIUM_2 };
+// lower case letters and digits only: "Dilithium 2" matches "dilithium-2"
+static std::string normalizeName(const std::string& s) {
+    std::string out;
+    for (char ch : s)
+        if (std::isalnum(static_cast<unsigned char>(ch)))
+            out += static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return out;
+}
 
-static std::string toLower(std::string s) {
-    for (auto& ch : s) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-    return s;
+static Alg findAlg(const std::string& name) {
+    const std::string n = normalizeName(name);
+    for (const AlgorithmInfo& info : registry()) {
+        if (n == normalizeName(info.tag) || n == normalizeName(info.prettyName)
+            || (info.alias && n == normalizeName(info.alias)))
+            return &info;
+    }
+    return nullptr;
 }
 
-static Alg algFromName(const std::string& nameIn) {
-    const std::string s = toLower(nameIn);
-    if (s == "ecdsa" || s == "ecdsa-p256" || s == "p256" || s.find("ecdsa") != std::string::npos)
-        return Alg::ECDSA_P256;
-    if (s == "falcon-512" || s == "falcon" || s.find("falcon") != std::string::npos)
-        return Alg::FALCON_512;
-    return Alg::DILITHIUM_2;
+static Alg algFromName(const std::string& name) {
+    Alg alg = findAlg(name);
+    if (!alg)
+        throw std::invalid_argument("unknown signature algorithm \"" + name + "\"");
+    return alg;
 }
 
 static std::string g_algoOverride;
@@ -43,21 +78,11 @@ static Alg getDefaultAlg() {
     if (!g_algoOverride.empty())
         return algFromName(g_algoOverride);
     const char* env = std::getenv("PQCDSA_ALGO");
-    return env ? algFromName(env) : Alg::ECDSA_P256;
+    return env ? algFromName(env) : &registry().front();
 }
 
-static const char* algTag(Alg a) {
-    switch (a) {
-        case Alg::ECDSA_P256:   return "ecdsa";
-        case Alg::FALCON_512:   return "falcon-512";
-        case Alg::DILITHIUM_2:  return "dilithium-2";
-    }
-    return "dilithium-2";
-}
-
-static const char* oqsAlgId(Alg a) {
-    return (a == Alg::FALCON_512) ? OQS_SIG_alg_falcon_padded_512
-                                  : OQS_SIG_alg_dilithium_2;
+static bool isEcdsa(Alg a) {
+    return a->oqsId == nullptr;
 }
 
 // ---- Hex helpers ----
@@ -224,8 +249,8 @@ static bool ecdsaVerify(const std::vector<uint8_t>& msg,
 
 static std::string oqsSign(const std::vector<uint8_t>& msg, Alg alg,
                             const std::vector<uint8_t>& sk) {
-    OQS_SIG* sig = OQS_SIG_new(oqsAlgId(alg));
-    if (!sig) throw std::runtime_error("OQS alg unavailable");
+    OQS_SIG* sig = OQS_SIG_new(alg->oqsId);
+    if (!sig) throw std::runtime_error(std::string("OQS alg unavailable: ") + alg->oqsId);
 
     std::vector<uint8_t> signature(sig->length_signature);
     size_t sigLen = 0;
@@ -240,7 +265,7 @@ static std::string oqsSign(const std::vector<uint8_t>& msg, Alg alg,
 static bool oqsVerify(const std::vector<uint8_t>& msg, Alg alg,
                        const std::vector<uint8_t>& sigBytes,
                        const std::vector<uint8_t>& pk) {
-    OQS_SIG* sig = OQS_SIG_new(oqsAlgId(alg));
+    OQS_SIG* sig = OQS_SIG_new(alg->oqsId);
     if (!sig) return false;
     bool ok = OQS_SIG_verify(sig, msg.data(), msg.size(),
                               sigBytes.data(), sigBytes.size(), pk.data()) == OQS_SUCCESS;
@@ -262,12 +287,27 @@ std::vector<uint8_t> fromHex(const std::string& maybePrefixedHex) {
     return decodeHex(maybePrefixedHex);
 }
 
-KeyPair generateKeyPair() {
+const std::vector<AlgorithmInfo>& algorithms() {
+    return registry();
+}
+
+const AlgorithmInfo* findAlgorithm(const std::string& name) {
+    return findAlg(name);
+}
+
+const AlgorithmInfo& algorithmInfo(const std::string& name) {
+    return *algFromName(name);
+}
+
+bool isAvailable(const AlgorithmInfo& info) {
+    return info.oqsId == nullptr || OQS_SIG_alg_is_enabled(info.oqsId);
+}
+
+static KeyPair generateKeyPairFor(Alg alg) {
     KeyPair kp;
-    Alg alg = getDefaultAlg();
-    const char* tag = algTag(alg);
+    const char* tag = alg->tag;
 
-    if (alg == Alg::ECDSA_P256) {
+    if (isEcdsa(alg)) {
         std::vector<uint8_t> pubDer, privDer;
         genECDSAp256(pubDer, privDer);
         kp.pubHex       = std::string("ALG:") + tag + ":" + bytesToHex(pubDer.data(), pubDer.size());
@@ -277,8 +317,8 @@ KeyPair generateKeyPair() {
         return kp;
     }
 
-    OQS_SIG* sig = OQS_SIG_new(oqsAlgId(alg));
-    if (!sig) throw std::runtime_error("OQS alg unavailable");
+    OQS_SIG* sig = OQS_SIG_new(alg->oqsId);
+    if (!sig) throw std::runtime_error(std::string("OQS alg unavailable: ") + alg->oqsId);
 
     std::vector<uint8_t> pk(sig->length_public_key);
     std::vector<uint8_t> sk(sig->length_secret_key);
@@ -294,50 +334,60 @@ KeyPair generateKeyPair() {
     return kp;
 }
 
+KeyPair generateKeyPair() {
+    return generateKeyPairFor(getDefaultAlg());
+}
+
+KeyPair generateKeyPair(const std::string& algoName) {
+    return generateKeyPairFor(algFromName(algoName));
+}
+
+bool isPostQuantum(const std::string& algoName) {
+    Alg alg = findAlg(algoName);
+    return alg && !isEcdsa(alg);
+}
+
 std::string sign(const std::string& dataHex, const std::string& privHex) {
+    LTE_PROFILE_SCOPE("pqcdsa", "sign");
     Alg alg = algFromPrefixed(privHex);
     std::vector<uint8_t> msg = decodeHex(dataHex);
     std::vector<uint8_t> sk  = decodeHex(privHex);
 
-    if (alg == Alg::ECDSA_P256)
+    if (isEcdsa(alg))
         return ecdsaSign(msg, sk);
     return oqsSign(msg, alg, sk);
 }
 
 bool verify(const std::string& dataHex, const std::string& sigHex, const std::string& pubHex) {
+    LTE_PROFILE_SCOPE("pqcdsa", "verify");
     Alg alg = algFromPrefixed(pubHex);
     std::vector<uint8_t> msg = decodeHex(dataHex);
     std::vector<uint8_t> sig = decodeHex(sigHex);
     std::vector<uint8_t> pk  = decodeHex(pubHex);
 
-    if (alg == Alg::ECDSA_P256)
+    if (isEcdsa(alg))
         return ecdsaVerify(msg, sig, pk);
     return oqsVerify(msg, alg, sig, pk);
 }
 
 std::string algoTagFromKey(const std::string& prefixedHex) {
     try {
-        return algTag(algFromPrefixed(prefixedHex));
+        return algFromPrefixed(prefixedHex)->tag;
     } catch (...) {
-        return algTag(getDefaultAlg());
+        return getDefaultAlg()->tag;
     }
 }
 
 std::string prettyNameFromTag(const std::string& tag) {
-    Alg a = algFromName(tag);
-    switch (a) {
-        case Alg::ECDSA_P256:   return "ECDSA P-256";
-        case Alg::FALCON_512:   return "Falcon-512";
-        case Alg::DILITHIUM_2:  return "Dilithium 2";
-    }
-    return "Dilithium 2";
+    return algFromName(tag)->prettyName;
 }
 
 std::string prefixKeyWithCertAlgo(const std::string& rawHex, const std::string& certAlgoName) {
-    return std::string("ALG:") + algTag(algFromName(certAlgoName)) + ":" + rawHex;
+    return std::string("ALG:") + algFromName(certAlgoName)->tag + ":" + rawHex;
 }
 
 void setAlgorithm(const std::string& name) {
+    algFromName(name);  // unknown names fail here, not at the first key generation
     g_algoOverride = name;
 }
 
@@ -13,8 +13,55 @@ struct KeyPair {
     size_t privKeyLength = 0;
 };
 
+// Signature algorithm of the registry, see algorithms()
+struct AlgorithmInfo {
+    const char* tag;          // in the key prefixes and the cryptoAlgo parameter, e.g. "falcon-512"
+    const char* prettyName;   // algoName of the certificates, e.g. "Falcon-512"
+    const char* alias;        // other accepted name, or nullptr
+    const char* oqsId;        // liboqs algorithm name, nullptr for ECDSA (OpenSSL)
+    int nistLevel;
+
+    // Bytes on the wire: the raw verification key (uncompressed point for ECDSA, whose keys
+    // are stored as DER) and the signature, its maximum for the variable-length ones
+    size_t publicKeySize;
+    size_t signatureSize;
+    bool variableSignature;
+
+    // IEEE 1609.2 explicit certificate: certFieldsSize bytes of fields, the signature of the
+    // issuer, of the same algorithm, and the verification key
+    size_t certFieldsSize;
+
+    // Reference latencies, liboqs and OpenSSL on a 3 GHz x86-64 with AVX2;
+    // BM_PqcKeyGen, BM_PqcSign and BM_PqcVerify measure them on the host
+    double keyGenMs;
+    double signMs;
+    double verifyMs;
+
+    size_t certMetadataSize() const { return certFieldsSize + signatureSize; }
+    size_t certSize() const { return certMetadataSize() + publicKeySize; }
+};
+
+// Every algorithm known to pqcdsa, ECDSA P-256 first
+const std::vector<AlgorithmInfo>& algorithms();
+
+// Algorithm by tag, certificate algoName or alias (case, spaces and dashes ignored); nullptr if unknown
+const AlgorithmInfo* findAlgorithm(const std::string& name);
+
+// As findAlgorithm, throws std::invalid_argument if unknown
+const AlgorithmInfo& algorithmInfo(const std::string& name);
+
+// Whether the liboqs build supports the algorithm (always true for ECDSA)
+bool isAvailable(const AlgorithmInfo& info);
+
 KeyPair generateKeyPair();
 
+// Key pair of the given algorithm, whatever the one selected by setAlgorithm/PQCDSA_ALGO.
+// The hybrid (migration) mode holds an ECDSA and a PQC key pair at the same time.
+KeyPair generateKeyPair(const std::string& algoName);
+
+// Whether the algorithm name (or tag) designates a post-quantum scheme
+bool isPostQuantum(const std::string& algoName);
+
 std::string sign(const std::string& dataHex, const std::string& privHex);
 
 bool verify(const std::string& dataHex, const std::string& sigHex, const std::string& pubHex);
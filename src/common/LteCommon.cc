@@ -539,12 +539,14 @@ cModule* getMacByMacNodeId(MacNodeId nodeId)
 {
     // UE might have left the simulation, return NULL in this case
     // since we do not have a MAC-Module anymore
-	int id = getBinder()->getOmnetId(nodeId);
-	if (id == 0){
-		return NULL;
-	}
+    LteBinder* binder = getBinder();
+    const LteBinder::NodeHandles* handles = binder->getNodeHandles(nodeId);
+    if (handles == NULL)
+        return NULL;
+    if (handles->mac != NULL)
+        return handles->mac;
 	// TODO fix for relays
-	return (getSimulation()->getModule(getBinder()->getOmnetId(nodeId))->getSubmodule("lteNic")->getSubmodule("mac"));
+	return (getSimulation()->getModule(binder->getOmnetId(nodeId))->getSubmodule("lteNic")->getSubmodule("mac"));
 }
 
 cModule* getRlcByMacNodeId(MacNodeId nodeId, LteRlcType rlcType)
@@ -11,6 +11,7 @@
 #define _LTE_LTECONTROLINFO_H_
 
 #include "common/LteControlInfo_m.h"
+#include "common/LteObjectPool.h"
 #include <vector>
 
 class UserTxParams;
@@ -101,6 +102,8 @@ class UserControlInfo : public UserControlInfo_Base
     FeedbackRequest feedbackReq;
     void setCoord(const inet::Coord& coord);
     inet::Coord getCoord() const;
+
+    LTE_POOLED_OBJECT(UserControlInfo)
 };
 
 Register_Class(UserControlInfo);
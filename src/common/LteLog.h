@@ -0,0 +1,57 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTELOG_H_
+#define _LTE_LTELOG_H_
+
+#include <omnetpp.h>
+
+/**
+ * Compile-time log levels of the project.
+ *
+ * Statements below LTE_LOG_MIN_LEVEL are removed by the compiler together
+ * with the evaluation of their arguments; the others go through the usual
+ * OMNeT++ EV_* macros and their runtime filtering. Debug builds keep
+ * everything (LTE_LOG_MIN_LEVEL defaults to LTE_LOGLEVEL_TRACE).
+ *
+ * The "makefiles-release" target of the top-level Makefile builds with
+ * LTE_LOG_MIN_LEVEL=LTE_LOGLEVEL_WARN and sets the OMNeT++
+ * COMPILETIME_LOGLEVEL to match, so plain EV/EV_INFO statements are removed
+ * as well.
+ *
+ * LTE_EV_DIAG is for the diagnostics traced at fatal level so that they are
+ * printed whatever the runtime log level: they are kept in debug builds only.
+ */
+#define LTE_LOGLEVEL_TRACE   0
+#define LTE_LOGLEVEL_DEBUG   1
+#define LTE_LOGLEVEL_DETAIL  2
+#define LTE_LOGLEVEL_INFO    3
+#define LTE_LOGLEVEL_DIAG    4
+#define LTE_LOGLEVEL_WARN    5
+#define LTE_LOGLEVEL_ERROR   6
+#define LTE_LOGLEVEL_OFF     7
+
+#ifndef LTE_LOG_MIN_LEVEL
+#define LTE_LOG_MIN_LEVEL LTE_LOGLEVEL_TRACE
+#endif
+
+#define LTE_LOG_ENABLED(level) ((level) >= LTE_LOG_MIN_LEVEL)
+
+// constant condition: the statement and its arguments are dropped when disabled
+#define LTE_LOG(level, stream) if (!LTE_LOG_ENABLED(level)) ; else stream
+
+#define LTE_EV_TRACE   LTE_LOG(LTE_LOGLEVEL_TRACE, EV_TRACE)
+#define LTE_EV_DEBUG   LTE_LOG(LTE_LOGLEVEL_DEBUG, EV_DEBUG)
+#define LTE_EV_DETAIL  LTE_LOG(LTE_LOGLEVEL_DETAIL, EV_DETAIL)
+#define LTE_EV         LTE_LOG(LTE_LOGLEVEL_INFO, EV_INFO)
+#define LTE_EV_DIAG    LTE_LOG(LTE_LOGLEVEL_DIAG, EV_FATAL)
+#define LTE_EV_WARN    LTE_LOG(LTE_LOGLEVEL_WARN, EV_WARN)
+#define LTE_EV_ERROR   LTE_LOG(LTE_LOGLEVEL_ERROR, EV_ERROR)
+
+#endif
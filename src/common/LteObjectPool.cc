@@ -0,0 +1,96 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "common/LteObjectPool.h"
+
+#include <new>
+#include <omnetpp.h>
+
+LteObjectPool::LteObjectPool(const char* typeName, size_t objectSize) :
+    typeName_(typeName),
+    objectSize_(objectSize),
+    live_(0),
+    highWater_(0),
+    allocations_(0),
+    heapFallbacks_(0)
+{
+    registry().push_back(this);
+}
+
+std::vector<LteObjectPool*>& LteObjectPool::registry()
+{
+    // never destroyed, like the pools themselves
+    static std::vector<LteObjectPool*>* pools = new std::vector<LteObjectPool*>();
+    return *pools;
+}
+
+const std::vector<LteObjectPool*>& LteObjectPool::getPools()
+{
+    return registry();
+}
+
+void LteObjectPool::grow()
+{
+    char* chunk = static_cast<char*>(::operator new(objectSize_ * CHUNK_OBJECTS));
+    chunks_.push_back(chunk);
+
+    // hand out the blocks in address order
+    for (unsigned int i = CHUNK_OBJECTS; i > 0; i--)
+        freeList_.push_back(chunk + (i - 1) * objectSize_);
+}
+
+void* LteObjectPool::allocate(size_t size)
+{
+    allocations_++;
+    if (size != objectSize_)
+    {
+        heapFallbacks_++;
+        return ::operator new(size);
+    }
+
+    if (freeList_.empty())
+        grow();
+
+    void* p = freeList_.back();
+    freeList_.pop_back();
+
+    if (++live_ > highWater_)
+        highWater_ = live_;
+    return p;
+}
+
+void LteObjectPool::release(void* p, size_t size)
+{
+    if (p == NULL)
+        return;
+
+    if (size != objectSize_)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    live_--;
+    freeList_.push_back(p);
+}
+
+void LteObjectPool::recordStatistics(omnetpp::cComponent* owner)
+{
+    const std::vector<LteObjectPool*>& pools = getPools();
+    for (unsigned int i = 0; i < pools.size(); i++)
+    {
+        const LteObjectPool* pool = pools[i];
+        std::string prefix = "pool:" + pool->getTypeName() + ":";
+        owner->recordScalar((prefix + "live").c_str(), pool->getLive());
+        owner->recordScalar((prefix + "highWater").c_str(), pool->getHighWater());
+        owner->recordScalar((prefix + "allocations").c_str(), pool->getAllocations());
+        owner->recordScalar((prefix + "heapFallbacks").c_str(), pool->getHeapFallbacks());
+        owner->recordScalar((prefix + "chunks").c_str(), pool->getChunks());
+    }
+}
@@ -0,0 +1,100 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTEOBJECTPOOL_H_
+#define _LTE_LTEOBJECTPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace omnetpp { class cComponent; }
+
+/**
+ * Free-list allocator for the message classes created and deleted on every
+ * TTI (air frames, control infos, SCIs, grants, CSR and CBR reports).
+ *
+ * A class opts in with LTE_POOLED_OBJECT(Class) in its body: its operator
+ * new/delete then take blocks of exactly sizeof(Class) from chunks of
+ * CHUNK_OBJECTS blocks, which are never returned to the heap but recycled.
+ * Requests of another size (a derived class without its own pool) go to the
+ * global heap, so subclassing a pooled class stays safe.
+ *
+ * Each pool keeps live, high-water and allocation counters; the binder
+ * records them as scalars at finish(). Pools are not thread safe: messages
+ * are created and deleted by the simulation thread only.
+ *
+ * Building with -DLTE_NO_OBJECT_POOLS turns LTE_POOLED_OBJECT into nothing.
+ */
+class LteObjectPool
+{
+  public:
+    static const unsigned int CHUNK_OBJECTS = 64;
+
+    LteObjectPool(const char* typeName, size_t objectSize);
+
+    void* allocate(size_t size);
+    void release(void* p, size_t size);
+
+    const std::string& getTypeName() const { return typeName_; }
+    uint64_t getLive() const { return live_; }
+    uint64_t getHighWater() const { return highWater_; }
+    uint64_t getAllocations() const { return allocations_; }
+    uint64_t getHeapFallbacks() const { return heapFallbacks_; }
+    size_t getChunks() const { return chunks_.size(); }
+
+    // All the pools created so far, in order of first use
+    static const std::vector<LteObjectPool*>& getPools();
+
+    // Records the counters of every pool as scalars of the given component
+    static void recordStatistics(omnetpp::cComponent* owner);
+
+  private:
+    std::string typeName_;
+    size_t objectSize_;
+
+    std::vector<void*> freeList_;
+    std::vector<char*> chunks_;
+
+    uint64_t live_;
+    uint64_t highWater_;
+    uint64_t allocations_;
+    uint64_t heapFallbacks_;
+
+    void grow();
+
+    static std::vector<LteObjectPool*>& registry();
+};
+
+/**
+ * The pool of class T. It is created on first use and deliberately never
+ * destroyed, so objects deleted during the network teardown still find it.
+ */
+template <class T>
+LteObjectPool& lteObjectPoolOf(const char* typeName)
+{
+    static LteObjectPool* pool = new LteObjectPool(typeName, sizeof(T));
+    return *pool;
+}
+
+#ifndef LTE_NO_OBJECT_POOLS
+
+#define LTE_POOLED_OBJECT(T) \
+  public: \
+    static void* operator new(size_t size) { return lteObjectPoolOf<T>(#T).allocate(size); } \
+    static void operator delete(void* p, size_t size) { lteObjectPoolOf<T>(#T).release(p, size); }
+
+#else
+
+#define LTE_POOLED_OBJECT(T)
+
+#endif
+
+#endif
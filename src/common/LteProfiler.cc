@@ -0,0 +1,173 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "common/LteProfiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+namespace {
+
+// Log-linear histogram: 8 sub-buckets for every power of two of the duration in ns
+const int SUB_BUCKET_BITS = 3;
+const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const int NUM_BUCKETS = 64 * SUB_BUCKETS;
+
+inline int bucketOf(uint64_t ns)
+{
+    if (ns < SUB_BUCKETS)
+        return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int sub = (int)((ns >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+// Upper bound (in ns) of the durations falling in a bucket
+inline uint64_t bucketUpperBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return (uint64_t)bucket;
+    int msb = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t sub = (uint64_t)(bucket % SUB_BUCKETS);
+    uint64_t base = (uint64_t)1 << msb;
+    return base + ((sub + 1) << (msb - SUB_BUCKET_BITS)) - 1;
+}
+
+thread_local uint64_t allocations_ = 0;
+
+} // unnamed namespace
+
+LteProfiler::Section::Section(const char* g, const char* n) :
+    group(g), name(n), histogram(NUM_BUCKETS, 0)
+{
+}
+
+void LteProfiler::Section::addSample(uint64_t ns, uint64_t allocs)
+{
+    ++calls;
+    totalNs += ns;
+    allocations += allocs;
+    ++histogram[bucketOf(ns)];
+}
+
+uint64_t LteProfiler::Section::percentile(double p) const
+{
+    if (calls == 0)
+        return 0;
+    uint64_t target = (uint64_t)(p / 100.0 * calls);
+    if (target == 0)
+        target = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < NUM_BUCKETS; b++)
+    {
+        seen += histogram[b];
+        if (seen >= target)
+            return bucketUpperBound(b);
+    }
+    return bucketUpperBound(NUM_BUCKETS - 1);
+}
+
+LteProfiler* LteProfiler::getInstance()
+{
+    static LteProfiler instance;
+    return &instance;
+}
+
+LteProfiler::Section* LteProfiler::getSection(const char* group, const char* name)
+{
+    // Only reached once per call site, a linear search is fine
+    for (Section* s : sections_)
+    {
+        if (s->group == group && s->name == name)
+            return s;
+    }
+    Section* s = new Section(group, name);
+    sections_.push_back(s);
+    return s;
+}
+
+void LteProfiler::writeReport(const std::string& path) const
+{
+    std::ofstream f(path, std::ios::out | std::ios::trunc);
+    if (!f.is_open())
+        return;
+
+    f << "module,section,calls,total_ns,mean_ns,p50_ns,p99_ns,allocations,count\n";
+    for (const Section* s : sections_)
+    {
+        if (s->calls == 0 && s->count == 0)
+            continue;
+        f << s->group << ',' << s->name << ',' << s->calls << ',' << s->totalNs << ','
+          << (s->calls ? s->totalNs / s->calls : 0) << ','
+          << s->percentile(50) << ',' << s->percentile(99) << ','
+          << s->allocations << ',' << s->count << '\n';
+    }
+}
+
+void LteProfiler::reset()
+{
+    for (Section* s : sections_)
+    {
+        s->calls = 0;
+        s->totalNs = 0;
+        s->allocations = 0;
+        s->count = 0;
+        std::fill(s->histogram.begin(), s->histogram.end(), 0);
+    }
+}
+
+uint64_t LteProfiler::allocationCount()
+{
+    return allocations_;
+}
+
+#ifdef LTE_PROFILING
+
+// Counting replacements of the global allocation functions, so that scoped timers can
+// report how many heap allocations the profiled code performs.
+
+void* operator new(std::size_t size)
+{
+    ++allocations_;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    ++allocations_;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocations_;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocations_;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+#endif
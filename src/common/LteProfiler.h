@@ -0,0 +1,117 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTEPROFILER_H_
+#define _LTE_LTEPROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Lightweight wall-clock profiler for simulation hot paths.
+ *
+ * Code is instrumented with the LTE_PROFILE_SCOPE / LTE_PROFILE_COUNT macros below.
+ * Samples are aggregated per (module type, section) and written by the binder at
+ * finish() as a flat CSV report: calls, total ns, p50/p99, heap allocations and
+ * the free counters (frames delivered, interferers, candidate CSRs, purged PDUs...).
+ *
+ * Everything compiles away unless the library is built with -DLTE_PROFILING
+ * (see the "makefiles-profiling" target of the top-level Makefile).
+ */
+class LteProfiler
+{
+  public:
+    struct Section
+    {
+        std::string group;         // module type, e.g. "LtePhyVUeMode4"
+        std::string name;          // instrumented function / block
+        uint64_t calls = 0;
+        uint64_t totalNs = 0;
+        uint64_t allocations = 0;  // heap allocations made inside the scope (nested scopes included)
+        uint64_t count = 0;        // free counter, see LTE_PROFILE_COUNT
+        std::vector<uint64_t> histogram;
+
+        Section(const char* g, const char* n);
+
+        void addSample(uint64_t ns, uint64_t allocs);
+
+        // Approximate percentile (0-100) of the recorded durations, in ns
+        uint64_t percentile(double p) const;
+    };
+
+    static LteProfiler* getInstance();
+
+    // Returns the section for (group, name), creating it on first use. Call sites cache the pointer.
+    Section* getSection(const char* group, const char* name);
+
+    // Writes the flat report, one line per section, to the given file
+    void writeReport(const std::string& path) const;
+
+    void reset();
+
+    // Number of heap allocations made so far by this thread (0 unless built with LTE_PROFILING)
+    static uint64_t allocationCount();
+
+  private:
+    LteProfiler() {}
+    std::vector<Section*> sections_;
+};
+
+/**
+ * RAII timer: adds the time spent between construction and destruction to a section
+ */
+class LteScopedTimer
+{
+  public:
+    explicit LteScopedTimer(LteProfiler::Section* section) :
+        section_(section),
+        allocs_(LteProfiler::allocationCount()),
+        start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~LteScopedTimer()
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+        section_->addSample((uint64_t)ns, LteProfiler::allocationCount() - allocs_);
+    }
+
+  private:
+    LteProfiler::Section* section_;
+    uint64_t allocs_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define LTE_PROFILE_CONCAT_(a, b) a##b
+#define LTE_PROFILE_CONCAT(a, b) LTE_PROFILE_CONCAT_(a, b)
+
+#ifdef LTE_PROFILING
+
+// Times the rest of the enclosing scope under (group, name)
+#define LTE_PROFILE_SCOPE(group, name) \
+    static LteProfiler::Section* LTE_PROFILE_CONCAT(lteProfSection_, __LINE__) = LteProfiler::getInstance()->getSection(group, name); \
+    LteScopedTimer LTE_PROFILE_CONCAT(lteProfTimer_, __LINE__)(LTE_PROFILE_CONCAT(lteProfSection_, __LINE__))
+
+// Adds n to the counter of (group, name) without timing anything
+#define LTE_PROFILE_COUNT(group, name, n) \
+    do { \
+        static LteProfiler::Section* lteProfCounter_ = LteProfiler::getInstance()->getSection(group, name); \
+        lteProfCounter_->count += (n); \
+    } while (0)
+
+#else
+
+#define LTE_PROFILE_SCOPE(group, name) do {} while (0)
+#define LTE_PROFILE_COUNT(group, name, n) do {} while (0)
+
+#endif
+
+#endif
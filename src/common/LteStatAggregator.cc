@@ -0,0 +1,169 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "common/LteStatAggregator.h"
+
+#include <sstream>
+
+using namespace omnetpp;
+
+static const char* suffixes[4] = { "count", "sum", "min", "max" };
+
+LteStatAggregator::LteStatAggregator() :
+    owner_(NULL),
+    distanceBin_(0)
+{
+}
+
+LteStatAggregator::~LteStatAggregator()
+{
+    for (unsigned int i = 0; i < active_.size(); i++)
+    {
+        Slot& slot = slots_[active_[i]];
+        for (int k = 0; k < 4; k++)
+            delete slot.vectors[k];
+    }
+}
+
+void LteStatAggregator::init(cComponent* owner, simtime_t bucket, double distanceBin, int distanceBins)
+{
+    if (bucket <= SIMTIME_ZERO)
+        throw cRuntimeError("LteStatAggregator::init - the aggregation period must be positive");
+    if (distanceBin <= 0 || distanceBins <= 0)
+        throw cRuntimeError("LteStatAggregator::init - distance bins must have a positive width and number");
+
+    owner_ = owner;
+    bucket_ = bucket;
+    bucketStart_ = SIMTIME_ZERO;
+
+    distanceBin_ = distanceBin;
+    received_.assign(distanceBins, 0);
+    decoded_.assign(distanceBins, 0);
+}
+
+void LteStatAggregator::collect(simsignal_t signal, double value)
+{
+    simtime_t now = simTime();
+    if (now >= bucketStart_ + bucket_)
+        closeBucket(now);
+
+    if (signal >= (simsignal_t)slots_.size())
+        slots_.resize(signal + 1, Slot());
+
+    Slot& slot = slots_[signal];
+    if (!slot.active)
+    {
+        slot.active = true;
+        active_.push_back(signal);
+    }
+
+    if (slot.count == 0 || value < slot.min)
+        slot.min = value;
+    if (slot.count == 0 || value > slot.max)
+        slot.max = value;
+    slot.count++;
+    slot.sum += value;
+}
+
+void LteStatAggregator::collectReception(double distance, bool decoded)
+{
+    if (distance < 0 || received_.empty())
+        return;
+
+    unsigned int bin = (unsigned int)(distance / distanceBin_);
+    if (bin >= received_.size())
+        bin = received_.size() - 1;
+
+    received_[bin]++;
+    if (decoded)
+        decoded_[bin]++;
+}
+
+void LteStatAggregator::closeBucket(simtime_t now)
+{
+    for (unsigned int i = 0; i < active_.size(); i++)
+    {
+        Slot& slot = slots_[active_[i]];
+        if (slot.count == 0)
+            continue;
+
+        if (slot.vectors[0] == NULL)
+        {
+            const char* name = cComponent::getSignalName(active_[i]);
+            for (int k = 0; k < 4; k++)
+            {
+                std::string vectorName = std::string("agg:") + name + ":" + suffixes[k];
+                slot.vectors[k] = new cOutVector(vectorName.c_str());
+            }
+        }
+
+        // samples are stamped with the start of their bucket
+        slot.vectors[0]->recordWithTimestamp(bucketStart_, slot.count);
+        slot.vectors[1]->recordWithTimestamp(bucketStart_, slot.sum);
+        slot.vectors[2]->recordWithTimestamp(bucketStart_, slot.min);
+        slot.vectors[3]->recordWithTimestamp(bucketStart_, slot.max);
+
+        if (slot.totalCount == 0 || slot.min < slot.totalMin)
+            slot.totalMin = slot.min;
+        if (slot.totalCount == 0 || slot.max > slot.totalMax)
+            slot.totalMax = slot.max;
+        slot.totalCount += slot.count;
+        slot.totalSum += slot.sum;
+
+        slot.count = 0;
+        slot.sum = 0;
+    }
+
+    // skip the buckets without samples
+    int64_t elapsed = (now - bucketStart_).raw() / bucket_.raw();
+    bucketStart_ += SimTime::fromRaw(bucket_.raw() * elapsed);
+}
+
+void LteStatAggregator::finish()
+{
+    if (owner_ == NULL)
+        return;
+
+    closeBucket(simTime());
+
+    for (unsigned int i = 0; i < active_.size(); i++)
+    {
+        const Slot& slot = slots_[active_[i]];
+        if (slot.totalCount == 0)
+            continue;
+
+        std::string prefix = std::string("agg:") + cComponent::getSignalName(active_[i]) + ":";
+        owner_->recordScalar((prefix + "count").c_str(), slot.totalCount);
+        owner_->recordScalar((prefix + "sum").c_str(), slot.totalSum);
+        owner_->recordScalar((prefix + "mean").c_str(), slot.totalSum / slot.totalCount);
+        owner_->recordScalar((prefix + "min").c_str(), slot.totalMin);
+        owner_->recordScalar((prefix + "max").c_str(), slot.totalMax);
+    }
+
+    for (unsigned int bin = 0; bin < received_.size(); bin++)
+    {
+        if (received_[bin] == 0)
+            continue;
+
+        std::ostringstream prefix;
+        prefix << "pdr:" << bin * distanceBin_ << "-";
+        if (bin == received_.size() - 1)
+            prefix << "inf";
+        else
+            prefix << (bin + 1) * distanceBin_;
+        prefix << "m:";
+
+        owner_->recordScalar((prefix.str() + "received").c_str(), received_[bin]);
+        owner_->recordScalar((prefix.str() + "decoded").c_str(), decoded_[bin]);
+        owner_->recordScalar((prefix.str() + "pdr").c_str(), (double)decoded_[bin] / received_[bin]);
+    }
+
+    // the counters are recorded once, even if finish() is called again
+    owner_ = NULL;
+}
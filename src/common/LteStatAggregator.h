@@ -0,0 +1,90 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTESTATAGGREGATOR_H_
+#define _LTE_LTESTATAGGREGATOR_H_
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Time-bucketed recorder for statistics produced every TTI.
+ *
+ * Instead of emitting one signal per event, a module hands its samples to
+ * collect(): they are folded into count/sum/min/max for the current bucket
+ * of the signal, and written as four output vectors
+ * ("agg:<signal>:count", ":sum", ":min", ":max") once per bucket with at
+ * least one sample. finish() adds the per-run totals as scalars.
+ *
+ * Receptions can also be binned by transmitter-receiver distance: finish()
+ * then records, for each bin, the received and decoded counts and the PDR
+ * ("pdr:<from>-<to>m:received", ":decoded", ":pdr").
+ *
+ * Slots are indexed by signal id, so collect() costs an array access.
+ */
+class LteStatAggregator
+{
+  public:
+    LteStatAggregator();
+    ~LteStatAggregator();
+
+    /**
+     * @param owner component the vectors and scalars are recorded for
+     * @param bucket aggregation period
+     * @param distanceBin width of the distance bins, in m
+     * @param distanceBins number of bins; the last one also takes any longer distance
+     */
+    void init(omnetpp::cComponent* owner, omnetpp::simtime_t bucket, double distanceBin, int distanceBins);
+
+    // Adds a sample of a signal to its current bucket
+    void collect(omnetpp::simsignal_t signal, double value);
+
+    // Adds a reception at the given distance to the PDR-vs-distance bins
+    void collectReception(double distance, bool decoded);
+
+    // Writes the last buckets and the per-run scalars
+    void finish();
+
+  private:
+    struct Slot
+    {
+        bool active;
+
+        // current bucket
+        uint64_t count;
+        double sum;
+        double min;
+        double max;
+
+        // whole run
+        uint64_t totalCount;
+        double totalSum;
+        double totalMin;
+        double totalMax;
+
+        omnetpp::cOutVector* vectors[4];    // count, sum, min, max; created on first write
+    };
+
+    omnetpp::cComponent* owner_;
+    omnetpp::simtime_t bucket_;
+    omnetpp::simtime_t bucketStart_;
+
+    std::vector<Slot> slots_;                   // indexed by signal id
+    std::vector<omnetpp::simsignal_t> active_;  // signals collected at least once
+
+    double distanceBin_;
+    std::vector<uint64_t> received_;
+    std::vector<uint64_t> decoded_;
+
+    // writes the buckets of all the signals and starts the one containing now
+    void closeBucket(omnetpp::simtime_t now);
+};
+
+#endif
@@ -0,0 +1,96 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "common/LteStreamRng.h"
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace omnetpp;
+
+LteStreamRng::LteStreamRng(int seedSet, uint32_t streamId) :
+    streamId_(streamId),
+    numDrawn_(0)
+{
+    seed(seedSet);
+}
+
+int LteStreamRng::getRunSeedSet()
+{
+    const char* seedSet = getEnvir()->getConfigEx()->getVariable(CFGVAR_SEEDSET);
+    return seedSet != NULL ? atoi(seedSet) : 0;
+}
+
+void LteStreamRng::seed(int seedSet)
+{
+    // the salt keeps these streams apart from any other use of the two numbers
+    std::seed_seq sequence{ (uint32_t)seedSet, streamId_, (uint32_t)0x4c54455au };
+    engine_.seed(sequence);
+    numDrawn_ = 0;
+}
+
+void LteStreamRng::initialize(int seedSet, int rngId, int numRngs, int parsimProcId, int parsimNumPartitions, cConfiguration *cfg)
+{
+    seed(seedSet);
+}
+
+void LteStreamRng::selfTest()
+{
+}
+
+uint32_t LteStreamRng::intRand()
+{
+    numDrawn_++;
+    return engine_();
+}
+
+uint32_t LteStreamRng::intRandMax()
+{
+    return engine_.max();
+}
+
+uint32_t LteStreamRng::intRand(uint32_t n)
+{
+    if (n == 0)
+        throw cRuntimeError("LteStreamRng::intRand(n) - n cannot be 0");
+
+    // rejection sampling, as cMersenneTwister: no modulo bias
+    uint32_t limit = engine_.max() - (uint32_t)(((uint64_t)engine_.max() + 1) % n);
+    uint32_t value;
+    do
+        value = intRand();
+    while (value > limit);
+    return value % n;
+}
+
+double LteStreamRng::doubleRand()
+{
+    return intRand() * (1.0 / 4294967296.0);
+}
+
+double LteStreamRng::doubleRandNonz()
+{
+    double value;
+    do
+        value = doubleRand();
+    while (value == 0);
+    return value;
+}
+
+double LteStreamRng::doubleRandIncl1()
+{
+    return intRand() * (1.0 / 4294967295.0);
+}
+
+std::string LteStreamRng::str() const
+{
+    std::stringstream out;
+    out << "stream " << streamId_ << ", " << numDrawn_ << " drawn";
+    return out.str();
+}
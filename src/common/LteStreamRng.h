@@ -0,0 +1,56 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTESTREAMRNG_H_
+#define _LTE_LTESTREAMRNG_H_
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <random>
+
+/**
+ * Private random stream of a simulation entity (e.g. the channel of a
+ * receiver), seeded from the seed set of the run and the id of the entity.
+ *
+ * The numbers drawn by an entity then depend neither on the draws of the
+ * others nor on the order in which the entities are processed, which is what
+ * the LteReceptionEngine needs to give the same results with any number of
+ * threads. Different runs (repetitions) still get different streams.
+ */
+class LteStreamRng : public omnetpp::cRNG
+{
+  public:
+    LteStreamRng(int seedSet, uint32_t streamId);
+
+    // The seed set of the current run
+    static int getRunSeedSet();
+
+    virtual void initialize(int seedSet, int rngId, int numRngs, int parsimProcId, int parsimNumPartitions, omnetpp::cConfiguration *cfg);
+    virtual void selfTest();
+
+    virtual unsigned long getNumbersDrawn() const { return numDrawn_; }
+
+    virtual uint32_t intRand();
+    virtual uint32_t intRandMax();
+    virtual uint32_t intRand(uint32_t n);
+    virtual double doubleRand();
+    virtual double doubleRandNonz();
+    virtual double doubleRandIncl1();
+
+    virtual std::string str() const;
+
+  private:
+    std::mt19937 engine_;
+    uint32_t streamId_;
+    unsigned long numDrawn_;
+
+    void seed(int seedSet);
+};
+
+#endif
@@ -12,6 +12,14 @@
 #include "inet/networklayer/common/L3AddressResolver.h"
 #include <cctype>
 #include "corenetwork/nodes/InternetMux.h"
+#include "common/LteProfiler.h"
+#include "common/LteObjectPool.h"
+#include "stack/phy/layer/LteReceptionEngine.h"
+#include "stack/phy/ChannelModel/LteChannelStateStore.h"
+#include "stack/phy/ChannelModel/LteLinkShadowing.h"
+#include "stack/phy/layer/LtePhyUe.h"
+#include "world/mobility/HighwayMobility.h"
+#include "veins/modules/mobility/traci/TraCIMobility.h"
 
 using namespace std;
 
@@ -634,6 +642,10 @@ void LteBinder::unregisterNode(MacNodeId id)
     if(nodeIds_.erase(id) != 1){
         EV_ERROR << "Cannot unregister node - node id \"" << id << "\" - not found";
     }
+    // the modules are deleted with the node
+    if (id < nodeHandles_.size())
+        nodeHandles_[id] = NodeHandles();
+    LteChannelStateStore::getInstance()->releaseNode(id);
     std::map<IPv4Address, MacNodeId>::iterator it;
     for(it = macNodeIdToIPAddress_.begin(); it != macNodeIdToIPAddress_.end(); )
     {
@@ -687,6 +699,23 @@ MacNodeId LteBinder::registerNode(cModule *module, LteNodeType type,
     // registering new node to LteBinder
 
     nodeIds_[macNodeId] = module->getId();
+    LteChannelStateStore::getInstance()->registerNode(macNodeId);
+
+    // the submodules exist before the node initializes
+    if (nodeHandles_.size() <= macNodeId)
+        nodeHandles_.resize(macNodeId + 1);
+    NodeHandles& handles = nodeHandles_[macNodeId];
+    handles = NodeHandles();
+    handles.node = module;
+    if (cModule* nic = module->getSubmodule("lteNic"))
+    {
+        handles.mac = dynamic_cast<LteMacBase*>(nic->getSubmodule("mac"));
+        handles.phy = dynamic_cast<LtePhyBase*>(nic->getSubmodule("phy"));
+        handles.phyUe = dynamic_cast<LtePhyUe*>(handles.phy);
+    }
+    handles.mobility = dynamic_cast<veins::BaseMobility*>(module->getSubmodule("veinsmobility"));
+    handles.traciMobility = dynamic_cast<veins::TraCIMobility*>(handles.mobility);
+    handles.highwayMobility = dynamic_cast<HighwayMobility*>(handles.mobility);
 
     module->par("macNodeId") = macNodeId;
 
@@ -745,11 +774,38 @@ void LteBinder::initialize(int stage)
         }
         nodesConfigured_ = false;
 
+        // the binder is unique in the network, so it configures the process-wide reception engine
+        LteReceptionEngine::getInstance()->configure(par("receptionThreads"), this);
+        LteChannelStateStore::getInstance()->configure(par("channelStateEviction"));
+        LteLinkShadowing::getInstance()->configure();
+
         // execute node creation and setup.
         // nodesConfiguration();
     }
 }
 
+void LteBinder::finish()
+{
+    // the binder is unique in the network, so it reports the process-wide message pools
+    if (par("poolStatistics").boolValue())
+        LteObjectPool::recordStatistics(this);
+
+    LteReceptionEngine* engine = LteReceptionEngine::getInstance();
+    if (engine->isEnabled())
+        engine->recordStatistics(this);
+
+    if (par("channelStateStatistics").boolValue())
+    {
+        LteChannelStateStore::getInstance()->recordStatistics(this);
+        LteLinkShadowing::getInstance()->recordStatistics(this);
+    }
+
+#ifdef LTE_PROFILING
+    // the binder is unique in the network, so it owns the process-wide profiling report
+    LteProfiler::getInstance()->writeReport(par("profileReport").stdstringValue());
+#endif
+}
+
 std::string LteBinder::increment_address(const char* address_string)  //TODO unused function
 {
     IPv4Address addr(address_string);
@@ -804,17 +860,13 @@ LteMacBase* LteBinder::getMacFromMacNodeId(MacNodeId id)
     if (id == 0)
         return NULL;
 
-    LteMacBase* mac;
-    if (macNodeIdToModule_.find(id) == macNodeIdToModule_.end())
-    {
-        mac = check_and_cast<LteMacBase*>(getMacByMacNodeId(id));
-        macNodeIdToModule_[id] = mac;
-    }
-    else
-    {
-        mac = macNodeIdToModule_[id];
-    }
-    return mac;
+    // NULL once the node has left the simulation
+    const NodeHandles* handles = getNodeHandles(id);
+    if (handles == NULL)
+        return NULL;
+    if (handles->mac == NULL)
+        throw cRuntimeError("LteBinder::getMacFromMacNodeId - node %d has no LTE MAC", id);
+    return handles->mac;
 }
 
 MacNodeId LteBinder::getNextHop(MacNodeId slaveId)
@@ -22,6 +22,14 @@
 
 using namespace inet;
 
+class LtePhyBase;
+class LtePhyUe;
+class HighwayMobility;
+namespace veins {
+class BaseMobility;
+class TraCIMobility;
+}
+
 /**
  * The LTE Binder module has one instance in the whole network.
  * It stores global mapping tables with OMNeT++ module IDs,
@@ -45,6 +53,28 @@ using namespace inet;
 
 class LteBinder : public cSimpleModule
 {
+  public:
+    /**
+     * Modules of a node the per-packet paths need, resolved once by
+     * registerNode() instead of walking the module tree and casting on
+     * every use. A member is NULL when the node has no such module.
+     */
+    struct NodeHandles
+    {
+        NodeHandles() :
+            node(NULL), mac(NULL), phy(NULL), phyUe(NULL), mobility(NULL), traciMobility(NULL), highwayMobility(NULL)
+        {
+        }
+
+        cModule* node;
+        LteMacBase* mac;                            // lteNic.mac
+        LtePhyBase* phy;                            // lteNic.phy
+        LtePhyUe* phyUe;                            // the same, if a UE PHY
+        veins::BaseMobility* mobility;              // veinsmobility
+        veins::TraCIMobility* traciMobility;        // the same, if TraCI
+        HighwayMobility* highwayMobility;           // the same, if the built-in highway/grid
+    };
+
   private:
     typedef std::map<MacNodeId, std::map<MacNodeId, bool> > DeployedUesMap;
     typedef std::map<MacCellId, LteDeployer*> DeployerList;
@@ -53,7 +83,7 @@ class LteBinder : public cSimpleModule
     std::map<IPv4Address, MacNodeId> macNodeIdToIPAddress_;
     std::map<long, MacNodeId> macNodeIdToNonIPAddress_;
     std::map<MacNodeId, char*> macNodeIdToModuleName_;
-    std::map<MacNodeId, LteMacBase*> macNodeIdToModule_;
+    std::vector<NodeHandles> nodeHandles_;   // indexed by MacNodeId, reset by unregisterNode()
     DeployerList deployersMap_;
     std::vector<MacNodeId> nextHop_; // MacNodeIdMaster --> MacNodeIdSlave
     std::map<int, OmnetId> nodeIds_;
@@ -111,6 +141,9 @@ class LteBinder : public cSimpleModule
     virtual void handleMessage(cMessage *msg)
     {
     }
+
+    // writes the profiling report (builds with LTE_PROFILING only)
+    virtual void finish();
     /**
      * Attaches the application module to a UE module.
      * At the moment only works with UDP
@@ -251,6 +284,20 @@ class LteBinder : public cSimpleModule
      */
     LteMacBase* getMacFromMacNodeId(MacNodeId id);
 
+    /**
+     * getNodeHandles() returns the modules of a node resolved
+     * when it registered, without any lookup in the module tree
+     *
+     * @param id MacNodeId of the node
+     * @return the handles, NULL if the node is unknown or has left the simulation
+     */
+    const NodeHandles* getNodeHandles(MacNodeId id) const
+    {
+        if (id >= nodeHandles_.size() || nodeHandles_[id].node == NULL)
+            return NULL;
+        return &nodeHandles_[id];
+    }
+
     /**
      * getNextHop() returns the master of
      * a given slave
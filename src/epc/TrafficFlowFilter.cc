@@ -11,11 +11,36 @@
 #include "inet/networklayer/contract/ipv4/IPv4ControlInfo.h"
 #include "inet/networklayer/ipv4/IPv4Datagram.h"
 #include "inet/networklayer/common/L3AddressResolver.h"
+#include <algorithm>
+#include <string>
 
 using namespace inet;
 
 Define_Module(TrafficFlowFilter);
 
+static const char* const TIER_NAMES[] = { "Full", "Addresses", "FirstKey", "None" };
+
+TrafficFlowFilter::TrafficFlowFilter() :
+    lastValid_(false),
+    lastKey_(L3Address(), TrafficFlowTemplate(L3Address(), UNSPECIFIED_PORT, UNSPECIFIED_PORT)),
+    lastTftId_(UNSPECIFIED_TFT),
+    lastHits_(0)
+{
+    std::fill(tierHits_, tierHits_ + TIER_NONE + 1, 0);
+}
+
+size_t TrafficFlowFilter::FlowKeyHash::operator()(const FlowKey& key) const
+{
+    // IPv4 addresses in all the filter tables so far
+    std::hash<std::string> strHash;
+    size_t h = key.firstKey.getType() == L3Address::IPv4 ? key.firstKey.toIPv4().getInt() : strHash(key.firstKey.str());
+    size_t a = key.addr.getType() == L3Address::IPv4 ? key.addr.toIPv4().getInt() : strHash(key.addr.str());
+    h = h * 0x9e3779b97f4a7c15ULL ^ a;
+    h = h * 0x9e3779b97f4a7c15ULL ^ key.srcPort;
+    h = h * 0x9e3779b97f4a7c15ULL ^ key.destPort;
+    return h;
+}
+
 void TrafficFlowFilter::initialize(int stage)
 {
     // wait until all the IP addresses are configured
@@ -31,6 +56,15 @@ void TrafficFlowFilter::initialize(int stage)
         error("TrafficFlowFilter::initialize - Error reading configuration from file %s", filename);
     loadFilterTable(filename);
     //=============================================
+
+    WATCH(lastHits_);
+}
+
+void TrafficFlowFilter::finish()
+{
+    recordScalar("tftLastFlowHits", lastHits_);
+    for (int tier = TIER_FULL; tier <= TIER_NONE; tier++)
+        recordScalar((std::string("tftHits") + TIER_NAMES[tier]).c_str(), tierHits_[tier]);
 }
 
 EpcNodeType TrafficFlowFilter::selectOwnerType(const char * type)
@@ -96,52 +130,59 @@ void TrafficFlowFilter::handleMessage(cMessage *msg)
 
 TrafficFlowTemplateId TrafficFlowFilter::findTrafficFlow(L3Address firstKey, TrafficFlowTemplate secondKey)
 {
-    TrafficFilterTemplateTable::iterator tftIt;
-    tftIt = filterTable_.find(firstKey);
+    FlowKey key(firstKey, secondKey);
 
-    // if no entry found
-    if (tftIt == filterTable_.end())
+    // same flow as the last datagram
+    if (lastValid_ && key == lastKey_)
     {
-        EV << "TrafficFlowFilter::findTrafficFlow - Cannot find tft list for destAddress " << firstKey << "." << endl;
-        return UNSPECIFIED_TFT;
+        lastHits_++;
+        return lastTftId_;
     }
 
-        // obtain the filter list associated to the given address
-    TrafficFilterTemplateList & filterList = tftIt->second;
+    ClassifierTier tier;
+    TrafficFlowTemplateId tftId = classify(key, tier);
+    tierHits_[tier]++;
 
-    // search for the second key within the list
-    TrafficFilterTemplateList::iterator templIt = filterList.begin(),
-        templFirst = filterList.begin(),
-        templEt = filterList.end();
+    lastValid_ = true;
+    lastKey_ = key;
+    lastTftId_ = tftId;
+    return tftId;
+}
 
+TrafficFlowTemplateId TrafficFlowFilter::classify(FlowKey key, ClassifierTier& tier) const
+{
     // try searching for the full entry (src-dest addresses and ports)
-    for (templIt = templFirst; templIt != templEt; templIt++)
+    auto it = classifier_.find(key);
+    if (it != classifier_.end())
     {
-        if ((*templIt) == secondKey)
-            return templIt->tftId;
+        tier = TIER_FULL;
+        return it->second;
     }
     EV << "TrafficFlowFilter::findTrafficFlow - Cannot find entry for the 4-tuple. Now trying with src and dest addresses" << endl;
 
     // if no result is found, try leaving port fields unspecified
-    secondKey.srcPort = secondKey.destPort = UNSPECIFIED_PORT;
-    for (templIt = templFirst; templIt != templEt; templIt++)
+    key.srcPort = key.destPort = UNSPECIFIED_PORT;
+    it = classifier_.find(key);
+    if (it != classifier_.end())
     {
-        if ((*templIt) == secondKey)
-            return templIt->tftId;
+        tier = TIER_ADDRESSES;
+        return it->second;
     }
     EV << "TrafficFlowFilter::findTrafficFlow - Cannot find entry for src and dest addresses. Now trying with first key only" << endl;
 
     // if no result is found again, search only for the first key
-    secondKey.addr.set(IPv4Address("0.0.0.0"));
-    for (templIt = templFirst; templIt != templEt; templIt++)
+    key.addr = L3Address(IPv4Address());
+    it = classifier_.find(key);
+    if (it != classifier_.end())
     {
-        if ((*templIt) == secondKey)
-            return templIt->tftId;
+        tier = TIER_FIRST_KEY;
+        return it->second;
     }
 
-    EV << "TrafficFlowFilter::findTrafficFlow - Cannot find entry for destAddress " << firstKey << " and values: ["
-       << secondKey.addr << "," << secondKey.destPort << "," << secondKey.srcPort << "]" << endl;
+    EV << "TrafficFlowFilter::findTrafficFlow - Cannot find entry for destAddress " << key.firstKey << " and values: ["
+       << key.addr << "," << key.destPort << "," << key.srcPort << "]" << endl;
 
+    tier = TIER_NONE;
     return UNSPECIFIED_TFT;
 }
 
@@ -151,7 +192,8 @@ bool TrafficFlowFilter::addTrafficFlow(L3Address firstKey, TrafficFlowTemplate t
        << tft.addr << "," << tft.destPort << "," << tft.srcPort << "]" << endl;
 
     // check if an entry for the given keys already exists
-    TrafficFlowTemplateId ret= findTrafficFlow(firstKey,tft);
+    ClassifierTier tier;
+    TrafficFlowTemplateId ret = classify(FlowKey(firstKey, tft), tier);
     if( ret ==! UNSPECIFIED_TFT )
     {
         EV << "TrafficFlowFilter::addTrafficFlow - skipping duplicate entry  with destAddress " << firstKey << " and values: ["
@@ -159,7 +201,9 @@ bool TrafficFlowFilter::addTrafficFlow(L3Address firstKey, TrafficFlowTemplate t
         return false;
     }
 
-    filterTable_[firstKey].push_back(tft);
+    // the first filter loaded for a key wins
+    classifier_.emplace(FlowKey(firstKey, tft), tft.tftId);
+    lastValid_ = false;
 
     EV << "TrafficFlowFilter::addTrafficFlow - inserted entry: destAddr[" << firstKey << "] - TFT[" << tft.tftId << "]" << endl;
     return true;
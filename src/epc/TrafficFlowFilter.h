@@ -11,6 +11,7 @@
 #define _LTE_TRAFFICFLOWFILTER_H_
 
 #include <omnetpp.h>
+#include <unordered_map>
 //#include "trafficFlowTemplateMsg_m.h"
 #include "epc/gtp/TftControlInfo.h"
 #include "epc/gtp_common.h"
@@ -21,17 +22,16 @@ using namespace inet;
  * Objective of the Traffic Flow Filter is mapping IP 4-Tuples to TFT identifiers. This commonly means identifying a bearer and
  * associating it to an ID that will be recognized by the first GTP-U entity
  *
- * The traffic filter uses a TrafficFilterTemplateTable that maps IP 4-Tuples to TFT identifiers.
- * The TrafficFilterTemplateTable has two levels:
- *  - at the first level there is up to one entry for each IPvXAddress. This may be a destination (on the P-GW side) or source (on the eNB side) address
- *  - at the second level each entry is a list of TrafficFlowTemplates structures, with a src/dest address (depending on the first level key,
- *    a dest and src port, and a tftId;
+ * The filters are kept in a hash classifier indexed by their whole key: the first key, which is the destination (on the P-GW
+ * side) or source (on the eNB side) address, the other address, the src and dest port. The first filter loaded for a key wins.
  *
- * When a packet comes to the traffic flow filter, an entry for the whole 4-tuple will be searched. In case of failure, the src and dest port will
+ * When a packet comes to the traffic flow filter, the whole 4-tuple will be searched. In case of failure, the src and dest port will
  * be left unspecified and a new search will be performed. In case of another failure a last search with only the first key will be performed.
- * If no result is found even in this case, an error will be thrown.
+ * Each search is a single exact lookup; if no result is found even in the last one, an error will be thrown.
+ * The decision for the last flow classified is kept, the datagrams of a flow usually coming in bursts, and the hits of each
+ * search are recorded at the end of the simulation.
  *
- * This table is specified via (part of) a XML configuration file. Note that the fields of the TrafficFlowTemplates (except for the tftId) may
+ * The filters are specified via (part of) a XML configuration file. Note that the fields of the TrafficFlowTemplates (except for the tftId) may
  * be left unspecified
  *
  * Example format for traffic filter XML configuration
@@ -57,25 +57,69 @@ using namespace inet;
  * For each filter entry the "tftId" and one between "destName" and "destAddr" ( or "srcName" and "srcAddr" for the eNB )
  * must be specified.
  * In case of both "destName" and "destAddr" values, the "destAddr" will be used
- *
  */
 class TrafficFlowFilter : public cSimpleModule
 {
+  public:
+    TrafficFlowFilter();
+
+  private:
     // specifies the type of the node that contains this filter (it can be ENB or PGW
-    // the filterTable_ will be indexed differently depending on this parameter
+    // the classifier_ will be indexed differently depending on this parameter
     EpcNodeType ownerType_;
 
     // gate for connecting with the GTP-U module
     cGate * gtpUserGate_;
 
-    TrafficFilterTemplateTable filterTable_;
+    // whole key of a traffic flow template
+    struct FlowKey
+    {
+        FlowKey(const L3Address& first, const TrafficFlowTemplate& tft) :
+            firstKey(first), addr(tft.addr), srcPort(tft.srcPort), destPort(tft.destPort)
+        {
+        }
+        bool operator==(const FlowKey& b) const
+        {
+            return firstKey == b.firstKey && addr == b.addr && srcPort == b.srcPort && destPort == b.destPort;
+        }
+
+        L3Address firstKey;
+        L3Address addr;
+        unsigned int srcPort;
+        unsigned int destPort;
+    };
+    struct FlowKeyHash
+    {
+        size_t operator()(const FlowKey& key) const;
+    };
+
+    // search that found a tftId
+    enum ClassifierTier
+    {
+        TIER_FULL, TIER_ADDRESSES, TIER_FIRST_KEY, TIER_NONE
+    };
+
+    std::unordered_map<FlowKey, TrafficFlowTemplateId, FlowKeyHash> classifier_;
+
+    // last decision of findTrafficFlow()
+    bool lastValid_;
+    FlowKey lastKey_;
+    TrafficFlowTemplateId lastTftId_;
+
+    // classifier hits
+    unsigned long lastHits_;
+    unsigned long tierHits_[TIER_NONE + 1];
 
     void loadFilterTable(const char * filterTableFile);
 
+    // the three searches of findTrafficFlow(), without statistics
+    TrafficFlowTemplateId classify(FlowKey key, ClassifierTier& tier) const;
+
     EpcNodeType selectOwnerType(const char * type);
     protected:
     virtual int numInitStages() const { return inet::NUM_INIT_STAGES; }
     virtual void initialize(int stage);
+    virtual void finish();
 
     // TrafficFlowFilter module may receive messages only from the input interface of its compound module
     virtual void handleMessage(cMessage *msg);
@@ -197,6 +197,19 @@ RxBufferStatus LteHarqBufferRx::getBufferStatus()
     return bs;
 }
 
+bool LteHarqBufferRx::isEmpty()
+{
+    for (unsigned int i = 0; i < numHarqProcesses_; i++)
+    {
+        for (Codeword cw = 0; cw < processes_[i]->getNumHarqUnits(); cw++)
+        {
+            if (processes_[i]->getUnitStatus(cw) != RXHARQ_PDU_EMPTY)
+                return false;
+        }
+    }
+    return true;
+}
+
 LteHarqBufferRx::~LteHarqBufferRx()
 {
     std::vector<LteHarqProcessRx *>::iterator it = processes_.begin();
@@ -107,6 +107,15 @@ class LteHarqBufferRx
      */
     UnitList firstAvailable();
 
+    /**
+     * @return true if no process holds a PDU on any codeword
+     */
+    bool isEmpty();
+
+    // Bytes received so far from this sender, for the throughput samples
+    unsigned int getTotalRcvdBytes() const { return totalRcvdBytes_; }
+    void setTotalRcvdBytes(unsigned int bytes) { totalRcvdBytes_ = bytes; }
+
     /*
      * returns true if the corresponding flow is a multicast one
      */
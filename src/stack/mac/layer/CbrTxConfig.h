@@ -0,0 +1,69 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef _LTE_CBRTXCONFIG_H_
+#define _LTE_CBRTXCONFIG_H_
+
+/**
+ * Transmission parameters of one cbr-PSSCH-TxConfig entry of the sidelink configuration.
+ *
+ * The MCS and subchannel ranges are stored already merged with the UE's own
+ * userEquipment-txParameters, so the scheduler reads them by CBR index without
+ * any further lookup.
+ */
+struct CbrTxConfig
+{
+    int minMcs = 0;
+    int maxMcs = 0;
+    int minSubchannels = 0;
+    int maxSubchannels = 0;
+    int allowedRetx = 0;
+    double allowedRri = 0;
+    double crLimit = 1;     // no limit unless cr-Limit is configured
+};
+
+/**
+ * One cbr-ConfigIndex entry: the CBR interval it covers and the tx config it selects
+ */
+struct CbrLevel
+{
+    double lower = 0;
+    double upper = 1;
+    int txConfigIndex = 0;
+
+    constexpr bool contains(double cbr) const
+    {
+        return (lower == 0) ? (cbr < upper) : ((upper == 1) ? (cbr > lower) : (cbr > lower && cbr <= upper));
+    }
+};
+
+/**
+ * Lower bound of the intersection of the UE range [ueMin, ueMax] with the CBR range [cbrMin, cbrMax].
+ * With no overlap the CBR values are used (this is left to the UE, the opposite approach is also entirely valid).
+ */
+constexpr int cbrRangeLower(int ueMin, int ueMax, int cbrMin, int cbrMax)
+{
+    return (ueMax < cbrMin || cbrMax < ueMin) ? cbrMin : (ueMin > cbrMin ? ueMin : cbrMin);
+}
+
+/**
+ * Upper bound of the intersection of the UE range [ueMin, ueMax] with the CBR range [cbrMin, cbrMax]
+ */
+constexpr int cbrRangeUpper(int ueMin, int ueMax, int cbrMin, int cbrMax)
+{
+    return (ueMax < cbrMin || cbrMax < ueMin) ? cbrMax : (ueMax < cbrMax ? ueMax : cbrMax);
+}
+
+#endif /* _LTE_CBRTXCONFIG_H_ */
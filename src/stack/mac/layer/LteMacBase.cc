@@ -126,12 +126,12 @@ void LteMacBase::fromPhy(cPacket *pkt)
         if (hrit != harqRxBuffers_.end())
         {
             hrit->second->insertPdu(cw,pdu);
+            harqRxPduInserted(src, hrit->second, false);
         }
         else
         {
             // Check if sender still exists before creating RX buffer
-            cModule* senderMac = getMacByMacNodeId(src);
-            if (senderMac == nullptr) {
+            if (binder_->getNodeHandles(src) == nullptr) {
                 // Sender has left simulation, drop packet
                 EV << "LteMacBase::macPduUnmake - sender node " << src
                    << " has left simulation at t=" << NOW
@@ -141,7 +141,7 @@ void LteMacBase::fromPhy(cPacket *pkt)
             }
 
             // Sender exists, safe to create RX buffer
-            // FIXME: possible memory leak
+            // (deleted with the MAC, or earlier by MACs that reclaim the buffers of idle senders)
             LteHarqBufferRx *hrb;
             if (userInfo->getDirection() == DL || userInfo->getDirection() == UL)
                 hrb = new LteHarqBufferRx(ENB_RX_HARQ_PROCESSES, this,src);
@@ -150,6 +150,7 @@ void LteMacBase::fromPhy(cPacket *pkt)
 
             harqRxBuffers_[src] = hrb;
             hrb->insertPdu(cw,pdu);
+            harqRxPduInserted(src, hrb, true);
         }
     }
     else if (userInfo->getFrameType() == RACPKT)
@@ -323,6 +323,16 @@ class LteMacBase : public cSimpleModule
         bufferizePacket(pkt);
     }
 
+    /**
+     * harqRxPduInserted is called every time a data PDU from <src> has been
+     * inserted into its H-ARQ rx buffer
+     *
+     * @param newBuffer true if the buffer has just been created for this PDU
+     */
+    virtual void harqRxPduInserted(MacNodeId src, LteHarqBufferRx* hrb, bool newBuffer)
+    {
+    }
+
     /**
      * macHandleFeedbackPkt is called every time a feedback pkt arrives on MAC
      */
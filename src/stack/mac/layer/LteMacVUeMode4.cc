@@ -23,9 +23,10 @@
 #include "stack/mac/buffer/LteMacQueue.h"
 #include "stack/mac/buffer/harq_d2d/LteHarqBufferRxD2DMirror.h"
 #include "stack/mac/layer/LteMacVUeMode4.h"
+#include "stack/mac/layer/LteSpsTiming.h"
 #include "stack/mac/scheduler/LteSchedulerUeUl.h"
 #include "stack/phy/packet/SpsCandidateResources.h"
-#include "stack/phy/packet/cbr_m.h"
+#include "stack/phy/packet/Cbr.h"
 #include "stack/phy/layer/Subchannel.h"
 #include "stack/mac/amc/AmcPilotD2D.h"
 #include "common/LteCommon.h"
@@ -34,17 +35,26 @@
 #include "inet/common/ModuleAccess.h"
 #include "inet/networklayer/ipv4/IPv4InterfaceData.h"
 #include "stack/mac/amc/LteMcs.h"
+#include "common/LteProfiler.h"
+#include "common/LteLog.h"
 #include <map>
+#include <algorithm>
 
 Define_Module(LteMacVUeMode4);
 
 LteMacVUeMode4::LteMacVUeMode4() :
     LteMacUeRealisticD2D()
 {
+    parkedSpsGrant_ = NULL;
 }
 
 LteMacVUeMode4::~LteMacVUeMode4()
 {
+    if (parkedSpsGrant_ != NULL)
+    {
+        delete parkedSpsGrant_;
+        parkedSpsGrant_ = NULL;
+    }
 }
 
 void LteMacVUeMode4::initialize(int stage)
@@ -74,6 +84,32 @@ void LteMacVUeMode4::initialize(int stage)
 
         expiredGrant_ = false;
 
+        std::string spsSizePolicy = par("spsSizePolicy").stdstringValue();
+        if (spsSizePolicy == "legacy")
+            spsSizePolicy_ = SPS_SIZE_LEGACY;
+        else if (spsSizePolicy == "lookahead")
+            spsSizePolicy_ = SPS_SIZE_LOOKAHEAD;
+        else if (spsSizePolicy == "oneshot")
+            spsSizePolicy_ = SPS_SIZE_ONESHOT;
+        else
+            throw cRuntimeError("LteMacVUeMode4::initialize - unknown spsSizePolicy \"%s\"", spsSizePolicy.c_str());
+        spsSizeWindow_ = par("spsSizeWindow");
+        parkedPeriodCounter_ = 0;
+        parkedExpirationCounter_ = 0;
+        oneShotGrant_ = false;
+        oneShotSent_ = false;
+
+        harqRxActiveSet_ = par("harqRxActiveSet");
+        harqRxIdleTimeout_ = par("harqRxIdleTimeout");
+        harqRxCounterTimeout_ = par("harqRxCounterTimeout");
+        nextHarqRxSweep_ = harqRxIdleTimeout_;
+        harqRxBuffersHighWater_ = 0;
+        harqRxBuffersReclaimed_ = 0;
+        WATCH(harqRxBuffersHighWater_);
+        WATCH(harqRxBuffersReclaimed_);
+
+        lastTxCreationTime_ = -1;
+
         currentCbrIndex_ = defaultCbrIndex_;
 
         // Register the necessary signals for this simulation
@@ -95,6 +131,12 @@ void LteMacVUeMode4::initialize(int stage)
         macNodeID               = registerSignal("macNodeID");
         rrcSelected             = registerSignal("resourceReselectionCounter");
         retainGrant             = registerSignal("retainGrant");
+        spsWastedRbs            = registerSignal("spsWastedRbs");
+        spsSizeReselection      = registerSignal("spsSizeReselection");
+        spsOneShot              = registerSignal("spsOneShot");
+        spsTxTiming             = registerSignal("spsTxTiming");
+        genToAirLatency         = registerSignal("genToAirLatency");
+        infoAgeAtTx             = registerSignal("infoAgeAtTx");
     }
     else if (stage == inet::INITSTAGE_NETWORK_LAYER_3)
     {
@@ -216,25 +258,22 @@ void LteMacVUeMode4::parseCbrTxConfig(cXMLElement* xmlConfig)
     cXMLElementList::iterator xmlIt;
     for(xmlIt = cbrLevelConfigs.begin(); xmlIt != cbrLevelConfigs.end(); xmlIt++)
     {
-        std::unordered_map<std::string, double> cbrLevelsMap;
+        CbrLevel cbrLevel;
         ParameterMap cbrLevelsParams;
         getParametersFromXML((*xmlIt), cbrLevelsParams);
         it = cbrLevelsParams.find("cbr-lower");
-        if (it != cbrLevelsParams.end())
-        {
-            cbrLevelsMap.insert(pair<std::string, double>("cbr-lower",  it->second));
-        }
+        if (it == cbrLevelsParams.end())
+            throw cRuntimeError("cbr-ConfigIndex without cbr-lower in configuration file");
+        cbrLevel.lower = it->second;
         it = cbrLevelsParams.find("cbr-upper");
-        if (it != cbrLevelsParams.end())
-        {
-            cbrLevelsMap.insert(pair<std::string, double>("cbr-upper",  it->second));
-        }
+        if (it == cbrLevelsParams.end())
+            throw cRuntimeError("cbr-ConfigIndex without cbr-upper in configuration file");
+        cbrLevel.upper = it->second;
         it = cbrLevelsParams.find("cbr-PSSCH-TxConfig-Index");
-        if (it != cbrLevelsParams.end())
-        {
-            cbrLevelsMap.insert(pair<std::string, double>("cbr-PSSCH-TxConfig-Index",  it->second));
-        }
-        cbrLevels_.push_back(cbrLevelsMap);
+        if (it == cbrLevelsParams.end())
+            throw cRuntimeError("cbr-ConfigIndex without cbr-PSSCH-TxConfig-Index in configuration file");
+        cbrLevel.txConfigIndex = (int)it->second;
+        cbrLevels_.push_back(cbrLevel);
     }
 
     cXMLElementList cbrTxConfigs = xmlConfig->getElementsByTagName("cbr-PSSCH-TxConfig");
@@ -246,58 +285,57 @@ void LteMacVUeMode4::parseCbrTxConfig(cXMLElement* xmlConfig)
 
     for(xmlIt = cbrTxParams.begin(); xmlIt != cbrTxParams.end(); xmlIt++)
     {
-        std::unordered_map<std::string, double> cbrMap;
         ParameterMap cbrParams;
         getParametersFromXML((*xmlIt), cbrParams);
+
+        int cbrMinMCS = (int)par("minMCSPSSCH");
+        int cbrMaxMCS = (int)par("maxMCSPSSCH");
+        int cbrMinSubchannelNum = (int)par("minSubchannelNumberPSSCH");
+        int cbrMaxSubchannelNum = (int)par("maxSubchannelNumberPSSCH");
+
+        CbrTxConfig cbrConfig;
+        cbrConfig.allowedRetx = (int)par("allowedRetxNumberPSSCH");
+        cbrConfig.allowedRri = resourceReservationInterval_;
+
         it = cbrParams.find("minMCS-PSSCH");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"minMCS-PSSCH",  it->second});
-        }
-        else
-            cbrMap.insert({"minMCS-PSSCH",  par("minMCSPSSCH")});
+            cbrMinMCS = (int)it->second;
         it = cbrParams.find("maxMCS-PSSCH");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"maxMCS-PSSCH",  it->second});
-        }
-        else
-            cbrMap.insert({"maxMCS-PSSCH",  par("maxMCSPSSCH")});
+            cbrMaxMCS = (int)it->second;
         it = cbrParams.find("minSubchannel-NumberPSSCH");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"minSubchannel-NumberPSSCH",  it->second});
-        }
-        else
-            cbrMap.insert({"minSubchannel-NumberPSSCH",  par("minSubchannelNumberPSSCH")});
+            cbrMinSubchannelNum = (int)it->second;
         it = cbrParams.find("maxSubchannel-NumberPSSCH");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"maxSubchannel-NumberPSSCH",  it->second});
-        }
-        else
-            cbrMap.insert({"maxSubchannel-NumberPSSCH",  par("maxSubchannelNumberPSSCH")});
+            cbrMaxSubchannelNum = (int)it->second;
         it = cbrParams.find("allowedRetxNumberPSSCH");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"allowedRetxNumberPSSCH",  it->second});
-        }
-        else
-            cbrMap.insert({"allowedRetxNumberPSSCH",  par("allowedRetxNumberPSSCH")});
+            cbrConfig.allowedRetx = (int)it->second;
         it = cbrParams.find("allowedRRI");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"allowedRRI",  it->second});
-        }
-        else
-            cbrMap.insert({"allowedRRI",  resourceReservationInterval_});
+            cbrConfig.allowedRri = it->second;
         it = cbrParams.find("cr-Limit");
         if (it != cbrParams.end())
-        {
-            cbrMap.insert({"cr-Limit",  it->second});
-        }
-        cbrPSSCHTxConfigList_.push_back(cbrMap);
+            cbrConfig.crLimit = it->second;
+
+        // Merge with the UE tx parameters (parsed beforehand) so the scheduler can use the ranges directly
+        cbrConfig.minMcs = cbrRangeLower(minMCSPSSCH_, maxMCSPSSCH_, cbrMinMCS, cbrMaxMCS);
+        cbrConfig.maxMcs = cbrRangeUpper(minMCSPSSCH_, maxMCSPSSCH_, cbrMinMCS, cbrMaxMCS);
+        cbrConfig.minSubchannels = cbrRangeLower(minSubchannelNumberPSSCH_, maxSubchannelNumberPSSCH_, cbrMinSubchannelNum, cbrMaxSubchannelNum);
+        cbrConfig.maxSubchannels = cbrRangeUpper(minSubchannelNumberPSSCH_, maxSubchannelNumberPSSCH_, cbrMinSubchannelNum, cbrMaxSubchannelNum);
+
+        cbrPSSCHTxConfigList_.push_back(cbrConfig);
+    }
+
+    // Validate indices once here, the scheduler then indexes the tables directly
+    for (const CbrLevel& cbrLevel : cbrLevels_)
+    {
+        if (cbrLevel.txConfigIndex < 0 || cbrLevel.txConfigIndex >= (int)cbrPSSCHTxConfigList_.size())
+            throw cRuntimeError("cbr-PSSCH-TxConfig-Index %d out of range in configuration file", cbrLevel.txConfigIndex);
     }
+    if (defaultCbrIndex_ < 0 || defaultCbrIndex_ >= (int)cbrPSSCHTxConfigList_.size())
+        throw cRuntimeError("default-cbr-ConfigIndex %d out of range in configuration file", defaultCbrIndex_);
 }
 
 void LteMacVUeMode4::parseRriConfig(cXMLElement* xmlConfig)
@@ -386,7 +424,9 @@ void LteMacVUeMode4::macPduMake()
             {
                 //UserTxParams* userTxParams = preconfiguredTxParams_;
                 uinfo->setUserTxParams(preconfiguredTxParams_->dup());
-                mode4Grant->setUserTxParams(preconfiguredTxParams_->dup());
+                // the preconfigured parameters never change, the grant keeps the copy it already has
+                if (!mode4Grant->getUserTxParams())
+                    mode4Grant->setUserTxParams(preconfiguredTxParams_->dup());
             }
             else
                 uinfo->setUserTxParams(mode4Grant->getUserTxParams()->dup());
@@ -424,6 +464,17 @@ void LteMacVUeMode4::macPduMake()
 
             drop(pkt);
 
+            // the SDU goes on air in this TTI: time since the application generated it,
+            // and age reached by the information of the previous SDU before being replaced
+            FlowControlInfoNonIp* sduInfo = dynamic_cast<FlowControlInfoNonIp*>(pkt->getControlInfo());
+            if (sduInfo != NULL)
+            {
+                emit(genToAirLatency, NOW - sduInfo->getCreationTime());
+                if (lastTxCreationTime_ >= SIMTIME_ZERO)
+                    emit(infoAgeAtTx, NOW - lastTxCreationTime_);
+                lastTxCreationTime_ = sduInfo->getCreationTime();
+            }
+
             macPkt->pushSdu(pkt);
             sduPerCid--;
         }
@@ -597,30 +648,12 @@ void LteMacVUeMode4::handleMessage(cMessage *msg)
             cbr_ = cbrPkt->getCbr();
 
             if (useCBR_) {
-                std::vector<std::unordered_map<std::string, double>>::iterator it;
-                for (it = cbrLevels_.begin(); it!=cbrLevels_.end(); it++)
+                for (const CbrLevel& cbrLevel : cbrLevels_)
                 {
-                    double cbrUpper = (*it).at("cbr-upper");
-                    double cbrLower = (*it).at("cbr-lower");
-                    double index = (*it).at("cbr-PSSCH-TxConfig-Index");
-                    if (cbrLower == 0){
-                        if (cbr_< cbrUpper)
-                        {
-                            currentCbrIndex_ = (int)index;
-                            break;
-                        }
-                    } else if (cbrUpper == 1){
-                        if (cbr_ > cbrLower)
-                        {
-                            currentCbrIndex_ = (int)index;
-                            break;
-                        }
-                    } else {
-                        if (cbr_ > cbrLower && cbr_<= cbrUpper)
-                        {
-                            currentCbrIndex_ = (int)index;
-                            break;
-                        }
+                    if (cbrLevel.contains(cbr_))
+                    {
+                        currentCbrIndex_ = cbrLevel.txConfigIndex;
+                        break;
                     }
                 }
             }
@@ -648,16 +681,43 @@ void LteMacVUeMode4::handleMessage(cMessage *msg)
             simtime_t elapsedTime = receivedTime_ - lteInfo->getCreationTime();
             remainingTime_ = lteInfo->getDuration() - (elapsedTime.dbl() * 1000);
 
+            int pktSize = pkt->getBitLength();
+            int reservationSize = getReservationSize(pktSize);
+
             if (schedulingGrant_ == NULL)
             {
-                macGenerateSchedulingGrant(remainingTime_, lteInfo->getPriority(), pkt->getBitLength());
+                macGenerateSchedulingGrant(remainingTime_, lteInfo->getPriority(), reservationSize);
             }
             else if ((schedulingGrant_ != NULL && periodCounter_ > remainingTime_))
             {
                 emit(grantBreakTiming, 1);
                 delete schedulingGrant_;
                 schedulingGrant_ = NULL;
-                macGenerateSchedulingGrant(remainingTime_, lteInfo->getPriority(), pkt->getBitLength());
+                macGenerateSchedulingGrant(remainingTime_, lteInfo->getPriority(), reservationSize);
+            }
+            else if (spsSizePolicy_ != SPS_SIZE_LEGACY && parkedSpsGrant_ == NULL &&
+                     getGrantCapacity(check_and_cast<LteMode4SchedulingGrant*>(schedulingGrant_)) < pktSize)
+            {
+                // The packet does not fit in the current reservation even at the highest allowed MCS
+                if (spsSizePolicy_ == SPS_SIZE_LOOKAHEAD)
+                {
+                    // Reselect a reservation large enough for the size schedule seen so far
+                    emit(spsSizeReselection, 1);
+                    delete schedulingGrant_;
+                    schedulingGrant_ = NULL;
+                    macGenerateSchedulingGrant(remainingTime_, lteInfo->getPriority(), reservationSize);
+                }
+                else
+                {
+                    // Keep the reservation for the small packets and send this one on a one-shot grant
+                    emit(spsOneShot, 1);
+                    parkedSpsGrant_ = schedulingGrant_;
+                    parkedPeriodCounter_ = periodCounter_;
+                    parkedExpirationCounter_ = expirationCounter_;
+                    schedulingGrant_ = NULL;
+                    oneShotGrant_ = true;
+                    macGenerateSchedulingGrant(remainingTime_, lteInfo->getPriority(), pktSize);
+                }
             }
             else
             {
@@ -680,32 +740,59 @@ void LteMacVUeMode4::handleMessage(cMessage *msg)
 
 void LteMacVUeMode4::handleSelfMessage()
 {
+    LTE_PROFILE_SCOPE("LteMacVUeMode4", "handleSelfMessage");
     EV << "----- UE MAIN LOOP -----" << endl;
 
-    // extract pdus from all harqrxbuffers and pass them to unmaker
-    HarqRxBuffers::iterator hit = harqRxBuffers_.begin();
-    HarqRxBuffers::iterator het = harqRxBuffers_.end();
-    LteMacPdu *pdu = NULL;
-    std::list<LteMacPdu*> pduList;
-
-    for (; hit != het; ++hit)
+    if (parkedSpsGrant_ != NULL)
     {
-        pduList=hit->second->extractCorrectPdus();
-        while (! pduList.empty())
+        // Keep the parked reservation in step with its period while the one-shot grant is in use,
+        // with the same reselection as the active one. Its occasions during this time are left unused.
+        LteMode4SchedulingGrant* parkedGrant = check_and_cast<LteMode4SchedulingGrant*>(parkedSpsGrant_);
+        if (parkedGrant->getPeriodic() && parkedGrant->getStartTime() <= NOW && parkedExpirationCounter_ > 0)
         {
-            pdu=pduList.front();
-            pduList.pop_front();
-            macPduUnmake(pdu);
+            if (ageSpsGrant(parkedGrant, parkedPeriodCounter_, parkedExpirationCounter_) == SPS_OCCASION)
+                parkedGrant->setFirstTransmission(false);
         }
     }
 
     unsigned int purged =0;
-    // purge from corrupted PDUs all Rx H-HARQ buffers
-    for (hit= harqRxBuffers_.begin(); hit != het; ++hit)
+    if (harqRxActiveSet_)
     {
-        purged += hit->second->purgeCorruptedPdus();
+        purged = processActiveHarqRxBuffers();
+    }
+    else
+    {
+        // extract pdus from all harqrxbuffers and pass them to unmaker
+        HarqRxBuffers::iterator hit = harqRxBuffers_.begin();
+        HarqRxBuffers::iterator het = harqRxBuffers_.end();
+        LteMacPdu *pdu = NULL;
+        std::list<LteMacPdu*> pduList;
+
+        for (; hit != het; ++hit)
+        {
+            pduList=hit->second->extractCorrectPdus();
+            while (! pduList.empty())
+            {
+                pdu=pduList.front();
+                pduList.pop_front();
+                macPduUnmake(pdu);
+            }
+        }
+
+        // purge from corrupted PDUs all Rx H-HARQ buffers
+        for (hit= harqRxBuffers_.begin(); hit != het; ++hit)
+        {
+            purged += hit->second->purgeCorruptedPdus();
+        }
     }
     EV << NOW << " LteMacVUeMode4::handleSelfMessage Purged " << purged << " PDUS" << endl;
+    LTE_PROFILE_COUNT("LteMacVUeMode4", "purgedPdus", purged);
+
+    if (harqRxIdleTimeout_ > 0 && NOW >= nextHarqRxSweep_)
+    {
+        reclaimIdleHarqRxBuffers();
+        nextHarqRxSweep_ = NOW + harqRxIdleTimeout_;
+    }
 
     EV << NOW << "LteMacVUeMode4::handleSelfMessage " << nodeId_ << " - HARQ process " << (unsigned int)currentHarq_ << endl;
     // updating current HARQ process for next TTI
@@ -726,43 +813,18 @@ void LteMacVUeMode4::handleSelfMessage()
     else if (mode4Grant->getPeriodic() && mode4Grant->getStartTime() <= NOW)
     {
         // Periodic checks
-        if(--expirationCounter_ == mode4Grant->getPeriod())
-        {
-            // Gotten to the point of the final tranmission must determine if we reselect or not.
-            double randomReReserve = dblrand(1);
-            if (randomReReserve < probResourceKeep_)
-            {
-                int expiration = 0;
-                if (resourceReservationInterval_ == 0.5){
-                    expiration = intuniform(10, 30, 3);
-                } else if (resourceReservationInterval_ == 0.2){
-                    expiration = intuniform(25, 75, 3);
-                } else {
-                    expiration = intuniform(5, 15, 3);
-                }
-                mode4Grant -> setResourceReselectionCounter(expiration);
-                mode4Grant -> setFirstTransmission(true);
-                expirationCounter_ = expiration * mode4Grant->getPeriod();
-                emit(rrcSelected, expiration);
-                emit(retainGrant, 1);
-            }
-        }
-        if (--periodCounter_>0 && !mode4Grant->getFirstTransmission())
+        SpsAging aging = ageSpsGrant(mode4Grant, periodCounter_, expirationCounter_);
+        if (aging == SPS_WAIT)
         {
             return;
         }
-        else if (expirationCounter_ > 0)
-        {
-            // resetting grant period
-            periodCounter_=mode4Grant->getPeriod();
-            // this is periodic grant TTI - continue with frame sending
-        }
-        else if (expirationCounter_ <= 0)
+        else if (aging == SPS_EXPIRED)
         {
             emit(grantBreak, 1);
             mode4Grant->setExpiration(0);
             expiredGrant_ = true;
         }
+        // otherwise this is periodic grant TTI - continue with frame sending
     }
     bool requestSdu = false;
     if (mode4Grant!=NULL && mode4Grant->getStartTime() <= NOW) // if a grant is configured
@@ -939,7 +1001,7 @@ void LteMacVUeMode4::macHandleSps(cPacket* pkt)
     }
 
     mode4Grant->setStartTime(selectedStartTime);
-    mode4Grant->setPeriodic(true);
+    mode4Grant->setPeriodic(!oneShotGrant_);
     mode4Grant->setGrantedBlocks(grantedBlocks);
     mode4Grant->setTotalGrantedBlocks(totalGrantedBlocks); // account for the 2 RBs used for the sci message
     mode4Grant->setDirection(D2D_MULTI);
@@ -962,13 +1024,20 @@ void LteMacVUeMode4::macHandleSps(cPacket* pkt)
     const unsigned int* tbsVect = itbs2tbs(mod, SINGLE_ANTENNA_PORT0, 1, maxMCSPSSCH_ - i);
     maximumCapacity_ = tbsVect[totalGrantedBlocks-1];
     mode4Grant->setGrantedCwBytes(currentCw_, maximumCapacity_);
-    EV_FATAL << "CRITICAL TEST: maximumCapacity: "<< maximumCapacity_ << " and totalGrantedBlocks: " << totalGrantedBlocks << endl;
+    LTE_EV_DIAG << "CRITICAL TEST: maximumCapacity: "<< maximumCapacity_ << " and totalGrantedBlocks: " << totalGrantedBlocks << endl;
     // Simply flips the codeword.
     currentCw_ = MAX_CODEWORDS - currentCw_;
 
     periodCounter_= mode4Grant->getPeriod();
     expirationCounter_= (mode4Grant->getResourceReselectionCounter() * periodCounter_) + 1;
 
+    // tell the application when the occasions of the new reservation are
+    if (mayHaveListeners(spsTxTiming))
+    {
+        LteSpsTiming timing(selectedStartTime, mode4Grant->getPeriod() * TTI, !oneShotGrant_);
+        emit(spsTxTiming, &timing);
+    }
+
     // TODO: Setup for HARQ retransmission, if it can't be satisfied then selection must occur again.
 
     CSRs.clear();
@@ -1005,66 +1074,17 @@ void LteMacVUeMode4::macGenerateSchedulingGrant(double maximumLatency, int prior
 
     if (useCBR_)
     {
-        int cbrMinSubchannelNum;
-        int cbrMaxSubchannelNum;
-        int cbrMinMCS;
-        int cbrMaxMCS;
+        const CbrTxConfig& cbrConfig = cbrPSSCHTxConfigList_[currentCbrIndex_];
 
-        std::unordered_map<std::string,double> cbrMap = cbrPSSCHTxConfigList_.at(currentCbrIndex_);
-
-        std::unordered_map<std::string,double>::const_iterator got = cbrMap.find("allowedRetxNumberPSSCH");
-        if ( got == cbrMap.end() )
-            allowedRetxNumberPSSCH_ = allowedRetxNumberPSSCH_;
-        else
-            allowedRetxNumberPSSCH_ = min((int)got->second, allowedRetxNumberPSSCH_);
-
-        got = cbrMap.find("minSubchannel-NumberPSSCH");
-        if ( got == cbrMap.end() )
-            cbrMinSubchannelNum = minSubchannelNumberPSSCH_;
-        else
-            cbrMinSubchannelNum = (int)got->second;
-
-        got = cbrMap.find("maxSubchannel-NumberPSSCH");
-        if ( got == cbrMap.end() )
-            cbrMaxSubchannelNum = maxSubchannelNumberPSSCH_;
-        else
-            cbrMaxSubchannelNum = (int)got->second;
+        allowedRetxNumberPSSCH_ = min(cbrConfig.allowedRetx, allowedRetxNumberPSSCH_);
 
         /**
          * Need to pick the number of subchannels for this reservation
          */
-        if (maxSubchannelNumberPSSCH_ < cbrMinSubchannelNum || cbrMaxSubchannelNum < minSubchannelNumberPSSCH_)
-        {
-            // No overlap therefore I will use the cbr values (this is left to the UE, the opposite approach is also entirely valid).
-            minSubchannelNumberPSSCH = cbrMinSubchannelNum;
-            maxSubchannelNumberPSSCH = cbrMaxSubchannelNum;
-        }
-        else
-        {
-            minSubchannelNumberPSSCH = max(minSubchannelNumberPSSCH_, cbrMinSubchannelNum);
-            maxSubchannelNumberPSSCH = min(maxSubchannelNumberPSSCH_, cbrMaxSubchannelNum);
-        }
-
-        got = cbrMap.find("minMCS-PSSCH");
-        if (got == cbrMap.end())
-            cbrMinMCS = minMCSPSSCH_;
-        else
-            cbrMinMCS = (int) got->second;
-
-        got = cbrMap.find("maxMCS-PSSCH");
-        if (got == cbrMap.end())
-            cbrMaxMCS = maxMCSPSSCH_;
-        else
-            cbrMaxMCS = (int) got->second;
-
-        if (maxMCSPSSCH_ < cbrMinMCS || cbrMaxMCS < minMCSPSSCH_) {
-            // No overlap therefore I will use the cbr values (this is left to the UE).
-            minMCS = cbrMinMCS;
-            maxMCS = cbrMaxMCS;
-        } else {
-            minMCS = max(minMCSPSSCH_, cbrMinMCS);
-            maxMCS = min(maxMCSPSSCH_, cbrMaxMCS);
-        }
+        minSubchannelNumberPSSCH = cbrConfig.minSubchannels;
+        maxSubchannelNumberPSSCH = cbrConfig.maxSubchannels;
+        minMCS = cbrConfig.minMcs;
+        maxMCS = cbrConfig.maxMcs;
     }
 
     // Select the number of subchannels based on the size of the packet to be transmitted
@@ -1092,7 +1112,7 @@ void LteMacVUeMode4::macGenerateSchedulingGrant(double maximumLatency, int prior
 
             const unsigned int *tbsVect = itbs2tbs(mod, SINGLE_ANTENNA_PORT0, 1, mcs - j);
             mcsCapacity = tbsVect[totalGrantedBlocks - 1];
-            EV_FATAL << "CRITICAL TEST LOOP: mcs - j:" << mcs - j << " packetSize: "<< pktSize <<" and mcsCapacity: "<< mcsCapacity << " and subchannelSize "<< subchannelSize_ <<endl;
+            LTE_EV_DIAG << "CRITICAL TEST LOOP: mcs - j:" << mcs - j << " packetSize: "<< pktSize <<" and mcsCapacity: "<< mcsCapacity << " and subchannelSize "<< subchannelSize_ <<endl;
 
             if (mcsCapacity > pktSize) {
                 capacity = mcsCapacity;
@@ -1105,13 +1125,13 @@ void LteMacVUeMode4::macGenerateSchedulingGrant(double maximumLatency, int prior
     }
 
     if (!foundValidMCS){
-        EV_FATAL <<"No valid subchannel configuration for the packet size"<<endl;
+        LTE_EV_DIAG <<"No valid subchannel configuration for the packet size"<<endl;
         throw cRuntimeError("On generating the grant there was no subchannel configuration which could hold the capacity of the packet: exiting.");
     }
 
-    EV_FATAL << "CRITICAL TEST: mcsCapacity:" << capacity << " for the packet size: "<< pktSize <<" and num of subchannel: "<< numSubchannels <<endl;
+    LTE_EV_DIAG << "CRITICAL TEST: mcsCapacity:" << capacity << " for the packet size: "<< pktSize <<" and num of subchannel: "<< numSubchannels <<endl;
     mode4Grant -> setNumberSubchannels(numSubchannels);
-    if (randomScheduling_){
+    if (randomScheduling_ || oneShotGrant_){
         mode4Grant -> setResourceReselectionCounter(0);
         mode4Grant -> setExpiration(0);
         mode4Grant -> setPeriodic(false);
@@ -1155,6 +1175,7 @@ void LteMacVUeMode4::macGenerateSchedulingGrant(double maximumLatency, int prior
 
 void LteMacVUeMode4::flushHarqBuffers()
 {
+    LTE_PROFILE_SCOPE("LteMacVUeMode4", "flushHarqBuffers");
     // send the selected units to lower layers
     // First make sure packets are sent down
     // HARQ retrans needs to be taken into account
@@ -1171,21 +1192,13 @@ void LteMacVUeMode4::flushHarqBuffers()
     // Ensure CR updated.
     channelOccupancyRatio_ = calculateChannelOccupancyRatio(period);
 
+    const CbrTxConfig& cbrConfig = cbrPSSCHTxConfigList_[currentCbrIndex_];
+
     HarqTxBuffers::iterator it2;
     for(it2 = harqTxBuffers_.begin(); it2 != harqTxBuffers_.end(); it2++)
     {
-        std::unordered_map<std::string,double> cbrMap = cbrPSSCHTxConfigList_.at(currentCbrIndex_);
-        std::unordered_map<std::string,double>::const_iterator got;
-
         if (packetDropping_) {
-            double crLimit;
-            got = cbrMap.find("cr-Limit");
-            if (got == cbrMap.end())
-                crLimit = 1;
-            else
-                crLimit = got->second;
-
-            if (channelOccupancyRatio_ > crLimit) {
+            if (channelOccupancyRatio_ > cbrConfig.crLimit) {
                 // Need to drop the unit currently selected
                 UnitList ul = it2->second->firstAvailable();
                 it2->second->forceDropProcess(ul.first);
@@ -1204,32 +1217,8 @@ void LteMacVUeMode4::flushHarqBuffers()
                 if (pduLength > 0)
                 {
                     if (useCBR_){
-                        int cbrMinMCS;
-                        int cbrMaxMCS;
-
-                        got = cbrMap.find("minMCS-PSSCH");
-                        if ( got == cbrMap.end() )
-                            cbrMinMCS = minMCSPSSCH_;
-                        else
-                            cbrMinMCS = (int)got->second;
-
-                        got = cbrMap.find("maxMCS-PSSCH");
-                        if ( got == cbrMap.end() )
-                            cbrMaxMCS = maxMCSPSSCH_;
-                        else
-                            cbrMaxMCS = (int)got->second;
-
-                        if (maxMCSPSSCH_ < cbrMinMCS || cbrMaxMCS < minMCSPSSCH_)
-                        {
-                            // No overlap therefore I will use the cbr values (this is left to the UE).
-                            minMCS = cbrMinMCS;
-                            maxMCS = cbrMaxMCS;
-                        }
-                        else
-                        {
-                            minMCS = max(minMCSPSSCH_, cbrMinMCS);
-                            maxMCS = min(maxMCSPSSCH_, cbrMaxMCS);
-                        }
+                        minMCS = cbrConfig.minMcs;
+                        maxMCS = cbrConfig.maxMcs;
                     }
 
                     bool foundValidMCS = false;
@@ -1294,6 +1283,15 @@ void LteMacVUeMode4::flushHarqBuffers()
 
                             emit(selectedMCS, mcs);
 
+                            // RBs of the reservation that this PDU did not need at the selected MCS
+                            int neededBlocks = totalGrantedBlocks;
+                            while (neededBlocks > 1 && (int)tbsVect[neededBlocks - 2] > pduLength)
+                                --neededBlocks;
+                            emit(spsWastedRbs, totalGrantedBlocks - neededBlocks);
+
+                            if (oneShotGrant_)
+                                oneShotSent_ = true;
+
                             break;
                         }
                     }
@@ -1349,6 +1347,234 @@ void LteMacVUeMode4::flushHarqBuffers()
         schedulingGrant_ = NULL;
         expiredGrant_ = false;
     }
+    if (parkedSpsGrant_ != NULL && (oneShotSent_ || schedulingGrant_ == NULL))
+    {
+        // The one-shot grant has been used (or dropped), go back to the periodic reservation
+        restoreParkedGrant();
+    }
+}
+
+LteMacVUeMode4::SpsAging LteMacVUeMode4::ageSpsGrant(LteMode4SchedulingGrant* grant, unsigned int& periodCounter,
+    unsigned int& expirationCounter)
+{
+    if(--expirationCounter == grant->getPeriod())
+    {
+        // Gotten to the point of the final tranmission must determine if we reselect or not.
+        double randomReReserve = dblrand(1);
+        if (randomReReserve < probResourceKeep_)
+        {
+            int expiration = 0;
+            if (resourceReservationInterval_ == 0.5){
+                expiration = intuniform(10, 30, 3);
+            } else if (resourceReservationInterval_ == 0.2){
+                expiration = intuniform(25, 75, 3);
+            } else {
+                expiration = intuniform(5, 15, 3);
+            }
+            grant -> setResourceReselectionCounter(expiration);
+            grant -> setFirstTransmission(true);
+            expirationCounter = expiration * grant->getPeriod();
+            emit(rrcSelected, expiration);
+            emit(retainGrant, 1);
+        }
+    }
+    if (--periodCounter>0 && !grant->getFirstTransmission())
+        return SPS_WAIT;
+    if (expirationCounter > 0)
+    {
+        // resetting grant period
+        periodCounter=grant->getPeriod();
+        return SPS_OCCASION;
+    }
+    return SPS_EXPIRED;
+}
+
+void LteMacVUeMode4::restoreParkedGrant()
+{
+    if (schedulingGrant_ != NULL)
+        delete schedulingGrant_;
+
+    schedulingGrant_ = parkedSpsGrant_;
+    periodCounter_ = parkedPeriodCounter_;
+    expirationCounter_ = parkedExpirationCounter_;
+    parkedSpsGrant_ = NULL;
+    oneShotGrant_ = false;
+    oneShotSent_ = false;
+
+    if (expirationCounter_ == 0)
+    {
+        // The reservation ran out while parked, reselect on the next packet
+        emit(grantBreak, 1);
+        delete schedulingGrant_;
+        schedulingGrant_ = NULL;
+    }
+}
+
+void LteMacVUeMode4::getAllowedMcsRange(int& minMCS, int& maxMCS)
+{
+    if (useCBR_)
+    {
+        const CbrTxConfig& cbrConfig = cbrPSSCHTxConfigList_[currentCbrIndex_];
+        minMCS = cbrConfig.minMcs;
+        maxMCS = cbrConfig.maxMcs;
+    }
+    else
+    {
+        minMCS = minMCSPSSCH_;
+        maxMCS = maxMCSPSSCH_;
+    }
+}
+
+int LteMacVUeMode4::getGrantCapacity(LteMode4SchedulingGrant* grant)
+{
+    // Use the subchannel count as the RBs may not be assigned yet (waiting for the CSRs)
+    int totalGrantedBlocks = grant->getNumSubchannels() * subchannelSize_;
+    if (adjacencyPSCCHPSSCH_)
+        totalGrantedBlocks -= 2; // 2 RBs for the sci in adjacent mode
+    if (totalGrantedBlocks <= 0)
+        return 0;
+
+    int minMCS, maxMCS;
+    getAllowedMcsRange(minMCS, maxMCS);
+
+    int capacity = 0;
+    for (int mcs = maxMCS; mcs >= minMCS; mcs--)
+    {
+        // SAE J3161 Section 8.6: MCS 8, 9, 10 SHALL NOT be used
+        if (mcs >= 8 && mcs <= 10) continue;
+
+        LteMod mod = _QPSK;
+        if (mcs > 9 && mcs < 17)
+            mod = _16QAM;
+        else if (mcs > 16 && mcs < 29)
+            mod = _64QAM;
+
+        unsigned int i = (mod == _QPSK ? 0 : (mod == _16QAM ? 9 : (mod == _64QAM ? 15 : 0)));
+
+        const unsigned int* tbsVect = itbs2tbs(mod, SINGLE_ANTENNA_PORT0, 1, mcs - i);
+        capacity = tbsVect[totalGrantedBlocks - 1];
+        break;
+    }
+    return capacity;
+}
+
+int LteMacVUeMode4::getReservationSize(int pktSize)
+{
+    if (spsSizeWindow_ == 0)
+        return pktSize;
+
+    recentPktSizes_.push_back(pktSize);
+    while (recentPktSizes_.size() > spsSizeWindow_)
+        recentPktSizes_.pop_front();
+
+    if (spsSizePolicy_ != SPS_SIZE_LOOKAHEAD)
+        return pktSize;
+
+    // Dimension the reservation on the largest SDU in the recent size schedule, so that the
+    // periodic full-certificate SPDUs fit in the same reservation as the digest ones.
+    return *std::max_element(recentPktSizes_.begin(), recentPktSizes_.end());
+}
+
+void LteMacVUeMode4::harqRxPduInserted(MacNodeId src, LteHarqBufferRx* hrb, bool newBuffer)
+{
+    if (newBuffer)
+    {
+        // a sender heard again after its buffer was reclaimed goes on with its throughput count
+        std::map<MacNodeId, std::pair<simtime_t, unsigned int> >::iterator bit = harqRxRcvdBytes_.find(src);
+        if (bit != harqRxRcvdBytes_.end())
+        {
+            hrb->setTotalRcvdBytes(bit->second.second);
+            harqRxRcvdBytes_.erase(bit);
+        }
+        if (harqRxBuffers_.size() > harqRxBuffersHighWater_)
+            harqRxBuffersHighWater_ = harqRxBuffers_.size();
+    }
+
+    activeHarqRxBuffers_.insert(src);
+    harqRxLastActivity_[src] = NOW;
+}
+
+unsigned int LteMacVUeMode4::processActiveHarqRxBuffers()
+{
+    // The set is ordered by MacNodeId like harqRxBuffers_, so PDUs reach the
+    // upper layers in the same order as with the full walk
+    std::set<MacNodeId>::iterator ait;
+    HarqRxBuffers::iterator hit;
+    std::list<LteMacPdu*> pduList;
+
+    for (ait = activeHarqRxBuffers_.begin(); ait != activeHarqRxBuffers_.end(); ++ait)
+    {
+        hit = harqRxBuffers_.find(*ait);
+        if (hit == harqRxBuffers_.end())
+            continue;
+
+        pduList = hit->second->extractCorrectPdus();
+        while (!pduList.empty())
+        {
+            LteMacPdu* pdu = pduList.front();
+            pduList.pop_front();
+            macPduUnmake(pdu);
+        }
+    }
+
+    unsigned int purged = 0;
+    for (ait = activeHarqRxBuffers_.begin(); ait != activeHarqRxBuffers_.end(); ++ait)
+    {
+        hit = harqRxBuffers_.find(*ait);
+        if (hit != harqRxBuffers_.end())
+            purged += hit->second->purgeCorruptedPdus();
+    }
+
+    // Mode 4 processes decide on a PDU as soon as it is inserted, so the buffers are
+    // normally empty by now; any that is not stays active for the next TTI
+    for (ait = activeHarqRxBuffers_.begin(); ait != activeHarqRxBuffers_.end();)
+    {
+        hit = harqRxBuffers_.find(*ait);
+        if (hit == harqRxBuffers_.end() || hit->second->isEmpty())
+            ait = activeHarqRxBuffers_.erase(ait);
+        else
+            ++ait;
+    }
+    return purged;
+}
+
+void LteMacVUeMode4::reclaimIdleHarqRxBuffers()
+{
+    HarqRxBuffers::iterator hit = harqRxBuffers_.begin();
+    while (hit != harqRxBuffers_.end())
+    {
+        MacNodeId src = hit->first;
+        std::map<MacNodeId, simtime_t>::iterator lit = harqRxLastActivity_.find(src);
+        bool idle = (lit == harqRxLastActivity_.end() || NOW - lit->second >= harqRxIdleTimeout_);
+
+        if (!idle || activeHarqRxBuffers_.count(src) > 0 || !hit->second->isEmpty())
+        {
+            ++hit;
+            continue;
+        }
+
+        EV << NOW << " LteMacVUeMode4::reclaimIdleHarqRxBuffers - deleting rx buffer of idle sender " << src << endl;
+        simtime_t lastHeard = (lit != harqRxLastActivity_.end()) ? lit->second : NOW;
+        harqRxRcvdBytes_[src] = std::make_pair(lastHeard, hit->second->getTotalRcvdBytes());
+        if (lit != harqRxLastActivity_.end())
+            harqRxLastActivity_.erase(lit);
+        delete hit->second;
+        harqRxBuffers_.erase(hit++);
+        harqRxBuffersReclaimed_++;
+    }
+
+    // forget the counters of the senders gone for good
+    if (harqRxCounterTimeout_ > 0)
+    {
+        std::map<MacNodeId, std::pair<simtime_t, unsigned int> >::iterator bit = harqRxRcvdBytes_.begin();
+        while (bit != harqRxRcvdBytes_.end())
+        {
+            if (NOW - bit->second.first >= harqRxCounterTimeout_)
+                harqRxRcvdBytes_.erase(bit++);
+            else
+                ++bit;
+        }
+    }
 }
 
 void LteMacVUeMode4::finish()
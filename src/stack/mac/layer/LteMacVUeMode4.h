@@ -21,12 +21,24 @@
 
 #include "stack/mac/layer/LteMacUeRealisticD2D.h"
 #include "corenetwork/deployer/LteDeployer.h"
+#include "stack/mac/layer/CbrTxConfig.h"
 #include <unordered_map>
+#include <set>
+#include <deque>
 
-//class LteMode4SchedulingGrant;
+class LteMode4SchedulingGrant;
 
 class LteMacVUeMode4: public LteMacUeRealisticD2D {
 
+public:
+    // How an SPS reservation copes with SDUs of changing size (e.g. digest vs full-certificate SPDUs)
+    enum SpsSizePolicy
+    {
+        SPS_SIZE_LEGACY,      // size on the triggering packet, oversize SDUs are fragmented by RLC
+        SPS_SIZE_LOOKAHEAD,   // size on the largest recent SDU, reselect if a packet still does not fit
+        SPS_SIZE_ONESHOT      // size on the triggering packet, oversize SDUs go out on a one-shot grant
+    };
+
 protected:
 
    /// Lte AMC module
@@ -65,6 +77,17 @@ protected:
    bool randomScheduling_;
    int missedTransmissions_;
 
+   // Size-class aware SPS handling
+   SpsSizePolicy spsSizePolicy_;
+   unsigned int spsSizeWindow_;
+   std::deque<int> recentPktSizes_;
+   // the periodic reservation is parked here while a one-shot grant carries an oversize packet
+   LteSchedulingGrant* parkedSpsGrant_;
+   unsigned int parkedPeriodCounter_;
+   unsigned int parkedExpirationCounter_;
+   bool oneShotGrant_;
+   bool oneShotSent_;
+
    double remainingTime_;
    simtime_t receivedTime_;
 
@@ -72,8 +95,9 @@ protected:
 
    std::map<UnitList, int> pduRecord_;
 
-   std::vector<std::unordered_map<std::string, double>> cbrPSSCHTxConfigList_;
-   std::vector<std::unordered_map<std::string, double>> cbrLevels_;
+   // CBR congestion control tables, parsed once from txConfig and indexed by CBR level
+   std::vector<CbrTxConfig> cbrPSSCHTxConfigList_;
+   std::vector<CbrLevel> cbrLevels_;
 
    std::unordered_map<double, int> previousTransmissions_;
    std::vector<double> validResourceReservationIntervals_;
@@ -94,6 +118,24 @@ protected:
 
    UeInfo* ueInfo_;
 
+   // H-ARQ rx buffers that received a PDU since the last TTI, walked instead of the whole map
+   bool harqRxActiveSet_;
+   std::set<MacNodeId> activeHarqRxBuffers_;
+
+   // rx buffers of senders not heard for harqRxIdleTimeout_ are deleted (0 disables)
+   simtime_t harqRxIdleTimeout_;
+   simtime_t nextHarqRxSweep_;
+   std::map<MacNodeId, simtime_t> harqRxLastActivity_;
+   // throughput counters of reclaimed buffers with the last time their sender was heard,
+   // restored when the sender is heard again and dropped after harqRxCounterTimeout_ (0 keeps them)
+   simtime_t harqRxCounterTimeout_;
+   std::map<MacNodeId, std::pair<simtime_t, unsigned int> > harqRxRcvdBytes_;
+   unsigned int harqRxBuffersHighWater_;
+   unsigned int harqRxBuffersReclaimed_;
+
+   // creation time of the last SDU put on air, -1 before the first one
+   simtime_t lastTxCreationTime_;
+
    simsignal_t grantStartTime;
    simsignal_t takingReservedGrant;
    simsignal_t grantBreak;
@@ -111,6 +153,12 @@ protected:
    simsignal_t macNodeID;
    simsignal_t rrcSelected;
    simsignal_t retainGrant;
+   simsignal_t spsWastedRbs;
+   simsignal_t spsSizeReselection;
+   simsignal_t spsOneShot;
+   simsignal_t spsTxTiming;
+   simsignal_t genToAirLatency;
+   simsignal_t infoAgeAtTx;
 
 //   // Lte AMC module
 //   LteAmc *amc_;
@@ -131,6 +179,38 @@ protected:
     virtual void macGenerateSchedulingGrant(double maximumLatency, int priority, int pktSize);
 
 
+    /**
+     * Returns the allowed MCS range, taking the current CBR level into account
+     */
+    virtual void getAllowedMcsRange(int& minMCS, int& maxMCS);
+
+    /**
+     * Returns the largest number of bits the given grant can carry in one TB
+     */
+    virtual int getGrantCapacity(LteMode4SchedulingGrant* grant);
+
+    /**
+     * Records the size of a new SDU and returns the size a new reservation should be dimensioned for
+     */
+    virtual int getReservationSize(int pktSize);
+
+    /**
+     * Puts back the periodic reservation parked by a one-shot grant
+     */
+    virtual void restoreParkedGrant();
+
+    enum SpsAging
+    {
+        SPS_WAIT, SPS_OCCASION, SPS_EXPIRED
+    };
+    /**
+     * Ages the counters of a started periodic grant by one TTI, with the
+     * probResourceKeep re-reservation at its last transmission; used for the
+     * active grant and for the parked one
+     */
+    virtual SpsAging ageSpsGrant(LteMode4SchedulingGrant* grant, unsigned int& periodCounter,
+        unsigned int& expirationCounter);
+
     /**
      * Handles the SPS candidate resources message from the PHY layer.
      */
@@ -154,6 +234,24 @@ protected:
      */
     virtual void handleSelfMessage();
 
+    /**
+     * Keeps track of the rx buffers to be processed in the next TTI
+     */
+    virtual void harqRxPduInserted(MacNodeId src, LteHarqBufferRx* hrb, bool newBuffer);
+
+    /**
+     * Extracts the correct PDUs and purges the corrupted ones of the active
+     * rx buffers only
+     *
+     * @return number of purged PDUs
+     */
+    unsigned int processActiveHarqRxBuffers();
+
+    /**
+     * Deletes the empty rx buffers of senders idle for more than harqRxIdleTimeout
+     */
+    void reclaimIdleHarqRxBuffers();
+
     /**
      * macPduMake() creates MAC PDUs (one for each CID)
      * by extracting SDUs from Real Mac Buffers according
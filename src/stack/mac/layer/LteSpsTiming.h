@@ -0,0 +1,44 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTESPSTIMING_H_
+#define _LTE_LTESPSTIMING_H_
+
+#include <omnetpp.h>
+
+/**
+ * Details of the "spsTxTiming" signal, emitted by LteMacVUeMode4 when a new
+ * reservation is selected: the first transmission occasion of the grant and
+ * its period. The signal propagates up to the vehicle module, where the
+ * application can subscribe to generate its packets just before the
+ * occasions (see Mode4App, generationMode = "sps").
+ */
+class LteSpsTiming : public omnetpp::cObject
+{
+  public:
+    LteSpsTiming(omnetpp::simtime_t nextTx, omnetpp::simtime_t period, bool periodic) :
+        nextTx_(nextTx),
+        period_(period),
+        periodic_(periodic)
+    {
+    }
+
+    // first occasion of the grant: the packet that triggered the reservation goes out then
+    omnetpp::simtime_t getNextTx() const { return nextTx_; }
+    omnetpp::simtime_t getPeriod() const { return period_; }
+    // false for the one-shot grants, which do not change the periodic occasions
+    bool isPeriodic() const { return periodic_; }
+
+  private:
+    omnetpp::simtime_t nextTx_;
+    omnetpp::simtime_t period_;
+    bool periodic_;
+};
+
+#endif
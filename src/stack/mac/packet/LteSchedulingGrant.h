@@ -13,6 +13,7 @@
 #include "stack/mac/packet/LteSchedulingGrant_m.h"
 #include "common/LteCommon.h"
 #include "stack/mac/amc/UserTxParams.h"
+#include "common/LteObjectPool.h"
 
 class UserTxParams;
 
@@ -303,6 +304,8 @@ public:
     {
         this->firstTransmission = firstTransmission;
     }
+
+    LTE_POOLED_OBJECT(LteMode4SchedulingGrant)
 };
 
 #endif
@@ -10,6 +10,7 @@
 #include "stack/pdcp_rrc/layer/LtePdcpRrcUeD2D.h"
 #include "inet/networklayer/common/L3AddressResolver.h"
 #include "stack/d2dModeSelection/D2DModeSwitchNotification_m.h"
+#include "common/LteLog.h"
 
 Define_Module(LtePdcpRrcUeD2D);
 
@@ -180,7 +181,7 @@ void LtePdcpRrcUeD2D::fromDataIn(cPacket *pkt)
 
     // PDCP Packet creation
     LtePdcpPdu* pdcpPkt = new LtePdcpPdu("LtePdcpPdu");
-    EV_FATAL << "DEBUG TEST: Now setting packet size. Incoming pkt size is " << pkt->getByteLength() << " bytes." << endl;
+    LTE_EV_DIAG << "DEBUG TEST: Now setting packet size. Incoming pkt size is " << pkt->getByteLength() << " bytes." << endl;
     pdcpPkt->setByteLength(lteInfo->getRlcType() == UM ? PDCP_HEADER_UM : PDCP_HEADER_AM);
     //pdcpPkt->setByteLength(pkt->getByteLength() + (lteInfo->getRlcType() == UM ? PDCP_HEADER_UM : PDCP_HEADER_AM));
 
@@ -12,6 +12,7 @@
 LteChannelModel::LteChannelModel(unsigned int band)
 {
     band_ = band;
+    rng_ = getEnvir()->getRNG(0);
 }
 
 LteChannelModel::~LteChannelModel()
@@ -18,9 +18,18 @@ class LteChannelModel
 {
   protected:
     unsigned int band_;
+    // random draws of the channel (shadowing, fading, errors): the simulation's
+    // RNG 0 unless the owner sets a stream of its own (see setRNG())
+    cRNG* rng_;
     public:
     LteChannelModel(unsigned int band);
     virtual ~LteChannelModel();
+    /*
+     * Sets the RNG used by this channel. The channel does not take ownership
+     * of it.
+     */
+    void setRNG(cRNG* rng) { rng_ = rng; }
+    cRNG* getRNG() const { return rng_; }
     /*
      * Compute the error probability of the transmitted packet according to cqi used, txmode, and the received power
      * after that it throws a random number in order to check if this packet will be corrupted or not
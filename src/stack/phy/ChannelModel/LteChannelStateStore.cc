@@ -0,0 +1,333 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "stack/phy/ChannelModel/LteChannelStateStore.h"
+
+#include <algorithm>
+
+using namespace omnetpp;
+
+const uint32_t LteChannelStateStore::NO_INDEX;
+
+LteChannelStateStore::LteChannelStateStore() :
+    evictionAge_(SIMTIME_ZERO),
+    nextIndex_(0),
+    closedEvictions_(0)
+{
+}
+
+LteChannelStateStore* LteChannelStateStore::getInstance()
+{
+    // never destroyed: the tables of the channel models deleted at the
+    // network teardown still find it
+    static LteChannelStateStore* instance = new LteChannelStateStore();
+    return instance;
+}
+
+void LteChannelStateStore::configure(simtime_t evictionAge)
+{
+    if (evictionAge < SIMTIME_ZERO)
+        throw cRuntimeError("LteChannelStateStore::configure - the eviction age cannot be negative");
+
+    evictionAge_ = evictionAge;
+    closedEvictions_ = 0;
+}
+
+void LteChannelStateStore::registerNode(MacNodeId nodeId)
+{
+    if (nodeId >= indexOf_.size())
+        indexOf_.resize(nodeId + 1, NO_INDEX);
+
+    // ids of a previous run in the same process keep their index
+    if (indexOf_[nodeId] != NO_INDEX)
+        return;
+
+    if (!freeIndices_.empty())
+    {
+        indexOf_[nodeId] = freeIndices_.back();
+        freeIndices_.pop_back();
+    }
+    else
+        indexOf_[nodeId] = nextIndex_++;
+}
+
+void LteChannelStateStore::releaseNode(MacNodeId nodeId)
+{
+    // the states still held for this node by the tables are recognized as
+    // stale by their peer id when the index is reused
+    if (nodeId >= indexOf_.size() || indexOf_[nodeId] == NO_INDEX)
+        return;
+
+    freeIndices_.push_back(indexOf_[nodeId]);
+    indexOf_[nodeId] = NO_INDEX;
+}
+
+void LteChannelStateStore::addTable(LteChannelStateTable* table)
+{
+    tables_.push_back(table);
+}
+
+void LteChannelStateStore::removeTable(LteChannelStateTable* table)
+{
+    std::vector<LteChannelStateTable*>::iterator it = std::find(tables_.begin(), tables_.end(), table);
+    if (it == tables_.end())
+        return;
+
+    closedEvictions_ += table->getEvictions();
+    tables_.erase(it);
+}
+
+size_t LteChannelStateStore::getMemoryUsage() const
+{
+    size_t bytes = indexOf_.capacity() * sizeof(uint32_t) + freeIndices_.capacity() * sizeof(uint32_t);
+    for (unsigned int i = 0; i < tables_.size(); i++)
+        bytes += tables_[i]->getMemoryUsage();
+    return bytes;
+}
+
+void LteChannelStateStore::recordStatistics(cComponent* owner) const
+{
+    uint64_t peers = 0;
+    uint64_t evictions = closedEvictions_;
+    for (unsigned int i = 0; i < tables_.size(); i++)
+    {
+        peers += tables_[i]->getPeers();
+        evictions += tables_[i]->getEvictions();
+    }
+
+    owner->recordScalar("channelState:tables", tables_.size());
+    owner->recordScalar("channelState:nodes", nextIndex_ - freeIndices_.size());
+    owner->recordScalar("channelState:peers", peers);
+    owner->recordScalar("channelState:evictions", evictions);
+    owner->recordScalar("channelState:bytes", getMemoryUsage());
+}
+
+LteChannelStateTable::LteChannelStateTable() :
+    fadingSize_(0),
+    transientFading_(-1),
+    nextExpiry_(SIMTIME_ZERO),
+    evictions_(0)
+{
+    transient_.peer = 0;
+    transient_.lastUse = -1;
+    LteChannelStateStore::getInstance()->addTable(this);
+}
+
+LteChannelStateTable::~LteChannelStateTable()
+{
+    LteChannelStateStore::getInstance()->removeTable(this);
+}
+
+LteChannelStateTable::PeerState* LteChannelStateTable::find(MacNodeId peer)
+{
+    uint32_t index = LteChannelStateStore::getInstance()->indexOf(peer);
+    if (index >= slotOf_.size() || slotOf_[index] < 0)
+        return NULL;
+
+    PeerState* state = &states_[slotOf_[index]];
+    if (state->peer != peer)
+    {
+        // the index belonged to a node now gone
+        release(slotOf_[index]);
+        evictions_++;
+        return NULL;
+    }
+
+    state->lastUse = simTime();
+    return state;
+}
+
+LteChannelStateTable::PeerState& LteChannelStateTable::state(MacNodeId peer)
+{
+    PeerState* existing = find(peer);
+    if (existing != NULL)
+        return *existing;
+
+    uint32_t index = LteChannelStateStore::getInstance()->indexOf(peer);
+    int32_t slot = -1;
+    if (index != LteChannelStateStore::NO_INDEX)
+    {
+        if (index >= slotOf_.size())
+            slotOf_.resize(index + 1, -1);
+
+        if (!freeStates_.empty())
+        {
+            slot = freeStates_.back();
+            freeStates_.pop_back();
+        }
+        else
+        {
+            slot = states_.size();
+            states_.push_back(PeerState());
+        }
+    }
+    else if (transient_.peer == peer && transient_.lastUse == simTime())
+    {
+        // same unregistered peer within the same event: keep what was drawn for it
+        return transient_;
+    }
+
+    PeerState& state = (slot >= 0) ? states_[slot] : transient_;
+    state.peer = peer;
+    state.lastUse = simTime();
+    state.losValid = false;
+    state.los = false;
+    state.shadowingValid = false;
+    state.shadowingTime = SIMTIME_ZERO;
+    state.shadowing = 0;
+    state.positions = 0;
+    state.fading = -1;
+
+    if (slot >= 0)
+        slotOf_[index] = slot;
+    return state;
+}
+
+int LteChannelStateTable::fading(MacNodeId peer, unsigned int size, bool& created)
+{
+    PeerState& peerState = state(peer);
+    created = false;
+    if (peerState.fading >= 0)
+        return peerState.fading;
+
+    // the number of bands and paths is a property of the channel model
+    if (fadingSize_ == 0)
+        fadingSize_ = size;
+    else if (size != fadingSize_)
+        throw cRuntimeError("LteChannelStateTable::fading - size %u differs from the one of the table (%u)", size, fadingSize_);
+
+    if (&peerState == &transient_)
+    {
+        // drawn again for every event, in a block kept for the purpose
+        if (transientFading_ < 0)
+        {
+            transientFading_ = fadingAngles_.size();
+            fadingAngles_.resize(fadingAngles_.size() + size);
+            fadingDelays_.resize(fadingDelays_.size() + size);
+        }
+        peerState.fading = transientFading_;
+    }
+    else if (!freeFading_.empty())
+    {
+        peerState.fading = freeFading_.back();
+        freeFading_.pop_back();
+    }
+    else
+    {
+        peerState.fading = fadingAngles_.size();
+        fadingAngles_.resize(fadingAngles_.size() + size);
+        fadingDelays_.resize(fadingDelays_.size() + size);
+    }
+
+    created = true;
+    return peerState.fading;
+}
+
+void LteChannelStateTable::release(int32_t slot)
+{
+    PeerState& state = states_[slot];
+
+    uint32_t index = LteChannelStateStore::getInstance()->indexOf(state.peer);
+    if (index < slotOf_.size() && slotOf_[index] == slot)
+        slotOf_[index] = -1;
+    else
+    {
+        // the peer is gone: find the index pointing to this state
+        std::vector<int32_t>::iterator it = std::find(slotOf_.begin(), slotOf_.end(), slot);
+        if (it != slotOf_.end())
+            *it = -1;
+    }
+
+    if (state.fading >= 0)
+        freeFading_.push_back(state.fading);
+
+    state.peer = 0;
+    state.fading = -1;
+    freeStates_.push_back(slot);
+}
+
+void LteChannelStateTable::expire(simtime_t now)
+{
+    simtime_t age = LteChannelStateStore::getInstance()->getEvictionAge();
+    if (age == SIMTIME_ZERO || now < nextExpiry_)
+        return;
+
+    // a sweep every half the eviction age: a peer is kept at most 1.5 times the age
+    nextExpiry_ = now + age / 2;
+
+    for (unsigned int slot = 0; slot < states_.size(); slot++)
+    {
+        if (states_[slot].peer != 0 && states_[slot].lastUse + age < now)
+        {
+            release(slot);
+            evictions_++;
+        }
+    }
+
+    if (freeStates_.size() > states_.size() / 2)
+        compact();
+}
+
+void LteChannelStateTable::compact()
+{
+    std::vector<PeerState> states;
+    states.reserve(states_.size() - freeStates_.size());
+
+    std::vector<double> angles;
+    std::vector<simtime_t> delays;
+
+    std::fill(slotOf_.begin(), slotOf_.end(), -1);
+    LteChannelStateStore* store = LteChannelStateStore::getInstance();
+
+    for (unsigned int slot = 0; slot < states_.size(); slot++)
+    {
+        PeerState state = states_[slot];
+        if (state.peer == 0)
+            continue;
+
+        uint32_t index = store->indexOf(state.peer);
+        if (index == LteChannelStateStore::NO_INDEX)
+        {
+            // gone, and not looked up since
+            evictions_++;
+            continue;
+        }
+
+        if (state.fading >= 0)
+        {
+            int fading = angles.size();
+            angles.insert(angles.end(), fadingAngles_.begin() + state.fading, fadingAngles_.begin() + state.fading + fadingSize_);
+            delays.insert(delays.end(), fadingDelays_.begin() + state.fading, fadingDelays_.begin() + state.fading + fadingSize_);
+            state.fading = fading;
+        }
+
+        slotOf_[index] = states.size();
+        states.push_back(state);
+    }
+
+    // swap with exact-size copies, so that the memory is given back
+    std::vector<PeerState>(states.begin(), states.end()).swap(states_);
+    std::vector<double>(angles.begin(), angles.end()).swap(fadingAngles_);
+    std::vector<simtime_t>(delays.begin(), delays.end()).swap(fadingDelays_);
+    std::vector<int32_t>().swap(freeStates_);
+    std::vector<int>().swap(freeFading_);
+    transientFading_ = -1;
+    transient_.fading = -1;
+}
+
+size_t LteChannelStateTable::getMemoryUsage() const
+{
+    return sizeof(*this)
+        + slotOf_.capacity() * sizeof(int32_t)
+        + states_.capacity() * sizeof(PeerState)
+        + freeStates_.capacity() * sizeof(int32_t)
+        + fadingAngles_.capacity() * sizeof(double)
+        + fadingDelays_.capacity() * sizeof(simtime_t)
+        + freeFading_.capacity() * sizeof(int);
+}
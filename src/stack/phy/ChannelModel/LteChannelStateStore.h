@@ -0,0 +1,171 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTECHANNELSTATESTORE_H_
+#define _LTE_LTECHANNELSTATESTORE_H_
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <vector>
+
+#include "common/LteCommon.h"
+#include "inet/common/geometry/common/Coord.h"
+
+class LteChannelStateTable;
+
+/**
+ * Process-wide store of the per-peer channel state (LOS, shadowing, position
+ * history, Jakes fading) kept by the channel models.
+ *
+ * The binder gives every registered node a dense index, reused once the node
+ * is unregistered, so the state of a peer is found with an array access
+ * instead of a lookup in a tree keyed by MacNodeId. Each channel model owns
+ * an LteChannelStateTable, whose flat arrays are addressed by these indices.
+ *
+ * Peers not heard for "channelStateEviction" (binder parameter, 0 keeps
+ * them forever) are evicted; the binder records the memory used by the
+ * tables at finish().
+ */
+class LteChannelStateStore
+{
+  public:
+    static const uint32_t NO_INDEX = 0xffffffff;
+
+    static LteChannelStateStore* getInstance();
+
+    // Sets the age after which the state of a peer is dropped (0: never)
+    void configure(omnetpp::simtime_t evictionAge);
+
+    omnetpp::simtime_t getEvictionAge() const { return evictionAge_; }
+
+    // Dense index of the node, assigned by the binder (NO_INDEX if unregistered)
+    uint32_t indexOf(MacNodeId nodeId) const
+    {
+        return nodeId < indexOf_.size() ? indexOf_[nodeId] : NO_INDEX;
+    }
+
+    void registerNode(MacNodeId nodeId);
+    void releaseNode(MacNodeId nodeId);
+
+    // Bytes used by all the tables
+    size_t getMemoryUsage() const;
+
+    // Records the table counters and the memory used as scalars of the given component
+    void recordStatistics(omnetpp::cComponent* owner) const;
+
+  private:
+    friend class LteChannelStateTable;
+
+    omnetpp::simtime_t evictionAge_;
+
+    std::vector<uint32_t> indexOf_;     // indexed by MacNodeId
+    std::vector<uint32_t> freeIndices_;
+    uint32_t nextIndex_;
+
+    std::vector<LteChannelStateTable*> tables_;
+
+    // evictions of the tables already deleted
+    uint64_t closedEvictions_;
+
+    LteChannelStateStore();
+
+    void addTable(LteChannelStateTable* table);
+    void removeTable(LteChannelStateTable* table);
+};
+
+/**
+ * Channel state kept by one channel model for its peers.
+ *
+ * The states are stored contiguously and addressed through the dense index
+ * of the peer; the Jakes fading data of all the peers share one pool.
+ * References returned by state() are valid until the next call creating a
+ * state or to expire(), so callers look the state up again when needed.
+ *
+ * A peer no longer registered with the binder (a vehicle removed by TraCI
+ * with a frame still in the air) gets a transient state, kept only while
+ * the same peer is looked up at the same simulation time: its channel is
+ * computed afresh for every reception and nothing is kept for it.
+ *
+ * A table is only accessed by the thread computing the receptions of its
+ * owner (see LteReceptionEngine).
+ */
+class LteChannelStateTable
+{
+  public:
+    struct PeerState
+    {
+        MacNodeId peer;
+        omnetpp::simtime_t lastUse;
+
+        bool losValid;
+        bool los;
+
+        // last computed shadowing
+        bool shadowingValid;
+        omnetpp::simtime_t shadowingTime;
+        double shadowing;
+
+        // up to the last two positions, oldest first
+        unsigned char positions;
+        omnetpp::simtime_t positionTime[2];
+        inet::Coord position[2];
+
+        // first element of the Jakes data of the peer in the fading pool, or -1
+        int fading;
+    };
+
+    LteChannelStateTable();
+    ~LteChannelStateTable();
+
+    // State of the link with a peer, created on first use (transient if the peer is unregistered)
+    PeerState& state(MacNodeId peer);
+
+    // State of the link with a peer, NULL if never created
+    PeerState* find(MacNodeId peer);
+
+    /*
+     * Jakes fading data of a peer: "size" angles and delays (bands * paths),
+     * created on first use. Returns the first element in the pools; "created"
+     * tells the caller to draw the values.
+     */
+    int fading(MacNodeId peer, unsigned int size, bool& created);
+    double* fadingAngles(int fading) { return &fadingAngles_[fading]; }
+    omnetpp::simtime_t* fadingDelays(int fading) { return &fadingDelays_[fading]; }
+
+    // Drops the peers not used since the eviction age of the store
+    void expire(omnetpp::simtime_t now);
+
+    size_t getPeers() const { return states_.size() - freeStates_.size(); }
+    uint64_t getEvictions() const { return evictions_; }
+    size_t getMemoryUsage() const;
+
+  private:
+    std::vector<int32_t> slotOf_;       // dense peer index -> element of states_, -1 if none
+    std::vector<PeerState> states_;
+    std::vector<int32_t> freeStates_;
+
+    unsigned int fadingSize_;
+    std::vector<double> fadingAngles_;
+    std::vector<omnetpp::simtime_t> fadingDelays_;
+    std::vector<int> freeFading_;
+
+    // state of an unregistered peer, and its block in the fading pools (-1 if none yet)
+    PeerState transient_;
+    int transientFading_;
+
+    omnetpp::simtime_t nextExpiry_;
+    uint64_t evictions_;
+
+    void release(int32_t slot);
+
+    // rebuilds the arrays without the free elements
+    void compact();
+};
+
+#endif
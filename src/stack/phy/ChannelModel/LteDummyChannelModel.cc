@@ -105,7 +105,7 @@ bool LteDummyChannelModel::error(LteAirFrame *frame, UserControlInfo* lteInfo)
     // and the harq reduction parameter
     double totalPer = per_ * pow(harqReduction_, nTx - 1);
     //Throw random variable
-    double er = uniform(getEnvir()->getRNG(0),0.0, 1.0);
+    double er = uniform(rng_,0.0, 1.0);
 
     if (er <= totalPer)
     {
@@ -132,7 +132,7 @@ bool LteDummyChannelModel::error_D2D(LteAirFrame *frame, UserControlInfo* lteInf
     // and the harq reduction parameter
     double totalPer = per_ * pow(harqReduction_, nTx - 1);
     //Throw random variable
-    double er = uniform(getEnvir()->getRNG(0),0.0, 1.0);
+    double er = uniform(rng_,0.0, 1.0);
 
     if (er <= totalPer)
     {
@@ -159,7 +159,7 @@ std::tuple<bool, bool> LteDummyChannelModel::error_Mode4(LteAirFrame *frame, Use
     // and the harq reduction parameter
     double totalPer = per_ * pow(harqReduction_, nTx - 1);
     //Throw random variable
-    double er = uniform(getEnvir()->getRNG(0),0.0, 1.0);
+    double er = uniform(rng_,0.0, 1.0);
 
     if (er <= totalPer)
     {
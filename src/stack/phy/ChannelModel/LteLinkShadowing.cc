@@ -0,0 +1,350 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "stack/phy/ChannelModel/LteLinkShadowing.h"
+
+#include <cmath>
+
+#include "common/LteStreamRng.h"
+#include "stack/phy/ChannelModel/LteChannelStateStore.h"
+
+using namespace omnetpp;
+
+const unsigned int LteLinkShadowing::SHARDS;
+const unsigned int LteLinkShadowing::STEPS_PER_DISTANCE;
+const unsigned int LteLinkShadowing::MAX_DISTANCE;
+
+namespace {
+
+// finalizer of splitmix64
+inline uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// order of the updates of one time, whatever the order of the calls
+bool lower(const inet::Coord* a, const inet::Coord* b)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (a[i].x != b[i].x)
+            return a[i].x < b[i].x;
+        if (a[i].y != b[i].y)
+            return a[i].y < b[i].y;
+        if (a[i].z != b[i].z)
+            return a[i].z < b[i].z;
+    }
+    return false;
+}
+
+}
+
+LteLinkShadowing::LteLinkShadowing() :
+    seed_(0)
+{
+    for (unsigned int i = 0; i < SHARDS; i++)
+    {
+        shards_[i].used = 0;
+        shards_[i].nextExpiry = SIMTIME_ZERO;
+        shards_[i].lookups = 0;
+        shards_[i].draws = 0;
+        shards_[i].evictions = 0;
+    }
+
+    // a = exp(-0.5 * d), as in the per-receiver shadowing of LteRealisticChannelModel
+    unsigned int size = MAX_DISTANCE * STEPS_PER_DISTANCE + 1;
+    correlation_.resize(size);
+    innovation_.resize(size);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        double a = exp(-0.5 * i / STEPS_PER_DISTANCE);
+        correlation_[i] = a;
+        innovation_[i] = sqrt(1 - a * a);
+    }
+}
+
+LteLinkShadowing* LteLinkShadowing::getInstance()
+{
+    // never destroyed, as the other process-wide channel state
+    static LteLinkShadowing* instance = new LteLinkShadowing();
+    return instance;
+}
+
+void LteLinkShadowing::configure()
+{
+    seed_ = mix(0x4c696e6b53686164ULL ^ (uint64_t)LteStreamRng::getRunSeedSet());
+
+    for (unsigned int i = 0; i < SHARDS; i++)
+    {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::vector<Link>().swap(shard.links);
+        shard.used = 0;
+        shard.nextExpiry = SIMTIME_ZERO;
+        shard.lookups = 0;
+        shard.draws = 0;
+        shard.evictions = 0;
+    }
+}
+
+bool LteLinkShadowing::los(MacNodeId a, const inet::Coord& coordA, MacNodeId b, const inet::Coord& coordB,
+    double probability, double correlationDistance)
+{
+    if (a == b)
+        throw cRuntimeError("LteLinkShadowing::los - link of node %d with itself", a);
+
+    // the lower id is the first end of the link
+    uint32_t key = a < b ? ((uint32_t)a << 16) | b : ((uint32_t)b << 16) | a;
+    const inet::Coord& first = a < b ? coordA : coordB;
+    const inet::Coord& second = a < b ? coordB : coordA;
+
+    Shard& shard = shards_[mix(key) >> 58];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    simtime_t now = simTime();
+    expire(shard, now);
+
+    Link& link = find(shard, key);
+    settle(link, now);
+
+    bool los = link.los;
+    if (!link.losValid
+        || link.losCoord[0].distance(first) + link.losCoord[1].distance(second) > correlationDistance)
+    {
+        los = uniform(key, 0) <= probability;
+        propose(link.losUpdate, los ? 1 : 0, first, second, now);
+        shard.draws++;
+    }
+    return los;
+}
+
+double LteLinkShadowing::shadowing(MacNodeId a, const inet::Coord& coordA, MacNodeId b, const inet::Coord& coordB,
+    double stdDev, double correlationDistance)
+{
+    if (a == b)
+        throw cRuntimeError("LteLinkShadowing::shadowing - link of node %d with itself", a);
+
+    uint32_t key = a < b ? ((uint32_t)a << 16) | b : ((uint32_t)b << 16) | a;
+    const inet::Coord& first = a < b ? coordA : coordB;
+    const inet::Coord& second = a < b ? coordB : coordA;
+
+    Shard& shard = shards_[mix(key) >> 58];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    simtime_t now = simTime();
+    expire(shard, now);
+
+    Link& link = find(shard, key);
+    settle(link, now);
+
+    double shadowing = link.shadowing;
+    if (!link.shadowingValid)
+    {
+        shadowing = stdDev * normal(key, 1);
+        propose(link.shadowingUpdate, shadowing, first, second, now);
+        shard.draws++;
+    }
+    else
+    {
+        // the link changes with the movement of both its ends
+        double space = link.shadowingCoord[0].distance(first) + link.shadowingCoord[1].distance(second);
+        if (space > correlationDistance)
+        {
+            double correlation, innovation;
+            decorrelation(space / correlationDistance, correlation, innovation);
+            shadowing = correlation * link.shadowing + innovation * stdDev * normal(key, 1);
+            propose(link.shadowingUpdate, shadowing, first, second, now);
+            shard.draws++;
+        }
+    }
+    return shadowing;
+}
+
+void LteLinkShadowing::settle(Link& link, simtime_t now)
+{
+    if (link.losUpdate.pending && link.losUpdate.time < now)
+    {
+        link.losValid = true;
+        link.los = link.losUpdate.value != 0;
+        link.losCoord[0] = link.losUpdate.coord[0];
+        link.losCoord[1] = link.losUpdate.coord[1];
+        link.losUpdate.pending = false;
+    }
+    if (link.shadowingUpdate.pending && link.shadowingUpdate.time < now)
+    {
+        link.shadowingValid = true;
+        link.shadowing = link.shadowingUpdate.value;
+        link.shadowingCoord[0] = link.shadowingUpdate.coord[0];
+        link.shadowingCoord[1] = link.shadowingUpdate.coord[1];
+        link.shadowingUpdate.pending = false;
+    }
+}
+
+void LteLinkShadowing::propose(Update& update, double value, const inet::Coord& first, const inet::Coord& second,
+    simtime_t now)
+{
+    inet::Coord coord[2] = { first, second };
+    if (update.pending && !lower(coord, update.coord))
+        return;
+
+    update.pending = true;
+    update.time = now;
+    update.value = value;
+    update.coord[0] = first;
+    update.coord[1] = second;
+}
+
+LteLinkShadowing::Link& LteLinkShadowing::find(Shard& shard, uint32_t key)
+{
+    shard.lookups++;
+
+    if (shard.links.empty() || 2 * (shard.used + 1) > shard.links.size())
+        grow(shard);
+
+    // linear probing from the hashed slot
+    size_t mask = shard.links.size() - 1;
+    size_t slot = (mix(key) >> 20) & mask;
+    while (shard.links[slot].key != 0 && shard.links[slot].key != key)
+        slot = (slot + 1) & mask;
+
+    Link& link = shard.links[slot];
+    if (link.key == 0)
+    {
+        link.key = key;
+        link.losValid = false;
+        link.los = false;
+        link.shadowingValid = false;
+        link.shadowing = 0;
+        link.losUpdate.pending = false;
+        link.shadowingUpdate.pending = false;
+        shard.used++;
+    }
+    link.lastUse = simTime();
+    return link;
+}
+
+void LteLinkShadowing::grow(Shard& shard)
+{
+    size_t size = shard.links.empty() ? 64 : shard.links.size();
+    while (2 * (shard.used + 1) > size)
+        size *= 2;
+    rehash(shard, size);
+}
+
+void LteLinkShadowing::rehash(Shard& shard, size_t size)
+{
+    std::vector<Link> links;
+    links.swap(shard.links);
+
+    Link empty;
+    empty.key = 0;
+    shard.links.assign(size, empty);
+
+    size_t mask = size - 1;
+    for (unsigned int i = 0; i < links.size(); i++)
+    {
+        if (links[i].key == 0)
+            continue;
+
+        size_t slot = (mix(links[i].key) >> 20) & mask;
+        while (shard.links[slot].key != 0)
+            slot = (slot + 1) & mask;
+        shard.links[slot] = links[i];
+    }
+}
+
+void LteLinkShadowing::expire(Shard& shard, simtime_t now)
+{
+    simtime_t age = LteChannelStateStore::getInstance()->getEvictionAge();
+    if (age == SIMTIME_ZERO || now < shard.nextExpiry)
+        return;
+
+    // a sweep every half the eviction age, as the per-model tables
+    shard.nextExpiry = now + age / 2;
+
+    size_t evicted = 0;
+    for (unsigned int i = 0; i < shard.links.size(); i++)
+    {
+        if (shard.links[i].key != 0 && shard.links[i].lastUse + age < now)
+        {
+            shard.links[i].key = 0;
+            evicted++;
+        }
+    }
+    if (evicted == 0)
+        return;
+
+    // probing sequences are broken by the holes: rebuild the table
+    shard.used -= evicted;
+    shard.evictions += evicted;
+
+    size_t size = 64;
+    while (4 * shard.used > size)
+        size *= 2;
+    rehash(shard, size);
+}
+
+void LteLinkShadowing::decorrelation(double d, double& a, double& b) const
+{
+    double x = d * STEPS_PER_DISTANCE;
+    if (x >= MAX_DISTANCE * STEPS_PER_DISTANCE)
+    {
+        // exp(-8): no correlation left
+        a = 0;
+        b = 1;
+        return;
+    }
+
+    unsigned int i = (unsigned int)x;
+    double f = x - i;
+    a = correlation_[i] + f * (correlation_[i + 1] - correlation_[i]);
+    b = innovation_[i] + f * (innovation_[i + 1] - innovation_[i]);
+}
+
+double LteLinkShadowing::uniform(uint32_t key, uint32_t draw) const
+{
+    uint64_t x = mix(seed_ ^ mix(((uint64_t)draw << 32) | key) ^ mix((uint64_t)simTime().raw()));
+    // 53 random bits, centered in their interval: never 0 nor 1
+    return ((x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double LteLinkShadowing::normal(uint32_t key, uint32_t draw) const
+{
+    // Box-Muller, from two independent uniforms of the link
+    double u1 = uniform(key, draw);
+    double u2 = uniform(key, draw | 0x10000);
+    return sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+void LteLinkShadowing::recordStatistics(cComponent* owner)
+{
+    uint64_t links = 0, lookups = 0, draws = 0, evictions = 0;
+    size_t bytes = 0;
+    for (unsigned int i = 0; i < SHARDS; i++)
+    {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        links += shard.used;
+        lookups += shard.lookups;
+        draws += shard.draws;
+        evictions += shard.evictions;
+        bytes += shard.links.capacity() * sizeof(Link);
+    }
+
+    // nothing to report when no channel model uses the pairwise shadowing
+    if (lookups == 0)
+        return;
+
+    owner->recordScalar("linkShadowing:links", links);
+    owner->recordScalar("linkShadowing:lookups", lookups);
+    owner->recordScalar("linkShadowing:draws", draws);
+    owner->recordScalar("linkShadowing:evictions", evictions);
+    owner->recordScalar("linkShadowing:bytes", bytes);
+}
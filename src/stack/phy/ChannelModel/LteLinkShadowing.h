@@ -0,0 +1,143 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTELINKSHADOWING_H_
+#define _LTE_LTELINKSHADOWING_H_
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "common/LteCommon.h"
+#include "inet/common/geometry/common/Coord.h"
+
+/**
+ * Shadowing and LOS state of the D2D links, shared by all the channel models
+ * ("pairwise-shadowing" channel parameter).
+ *
+ * By default every receiver keeps its own shadowing and LOS per sender, so
+ * the two directions of a link get independent values and each is drawn
+ * twice. Here the state is keyed by the unordered pair of nodes: both
+ * directions see the same (reciprocal) values, computed once.
+ *
+ * The shadowing decorrelates with the distance travelled by the two ends of
+ * the link since the last update, through a precomputed table of the
+ * exponential correlation coefficients; the LOS state is drawn again once
+ * the ends moved more than the correlation distance.
+ *
+ * The random values of a link are a function of the seed set of the run, of
+ * the pair and of the simulation time, not of a shared RNG. The calls made at
+ * one simulation time all start from the state left by the previous times;
+ * the update they compute is applied at the next time, the one with the
+ * lowest positions winning when the callers saw the ends at different
+ * positions. The results therefore do not depend on which receiver, or
+ * thread (see LteReceptionEngine), evaluates the link first. The links are
+ * spread over shards, each with its own lock and open-addressing table.
+ *
+ * Links not used for the binder's "channelStateEviction" are dropped.
+ */
+class LteLinkShadowing
+{
+  public:
+    static LteLinkShadowing* getInstance();
+
+    // Clears the links at the beginning of a run
+    void configure();
+
+    /**
+     * LOS state of the link between a and b.
+     *
+     * @param probability LOS probability at the current distance, used when drawing again
+     */
+    bool los(MacNodeId a, const inet::Coord& coordA, MacNodeId b, const inet::Coord& coordB,
+        double probability, double correlationDistance);
+
+    // Log-normal shadowing (dB) of the link between a and b, with zero mean
+    double shadowing(MacNodeId a, const inet::Coord& coordA, MacNodeId b, const inet::Coord& coordB,
+        double stdDev, double correlationDistance);
+
+    // Records the link counters and the memory used as scalars of the given component
+    void recordStatistics(omnetpp::cComponent* owner);
+
+  private:
+    // update computed at "time", applied by the first call of a later time
+    struct Update
+    {
+        bool pending;
+        omnetpp::simtime_t time;
+        double value;                   // shadowing, or 1/0 for the LOS
+        inet::Coord coord[2];
+    };
+
+    struct Link
+    {
+        uint32_t key;                   // (lower id << 16) | higher id, 0 if free
+        omnetpp::simtime_t lastUse;
+
+        bool losValid;
+        bool los;
+        inet::Coord losCoord[2];        // positions of the ends at the LOS draw
+        Update losUpdate;
+
+        bool shadowingValid;
+        double shadowing;
+        inet::Coord shadowingCoord[2];  // positions of the ends at the last update
+        Update shadowingUpdate;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::vector<Link> links;        // power of two size
+        size_t used;
+        omnetpp::simtime_t nextExpiry;
+
+        uint64_t lookups;
+        uint64_t draws;
+        uint64_t evictions;
+    };
+
+    static const unsigned int SHARDS = 64;
+
+    // decorrelation table, indexed by the travelled distance in correlation distances
+    static const unsigned int STEPS_PER_DISTANCE = 64;
+    static const unsigned int MAX_DISTANCE = 16;
+
+    Shard shards_[SHARDS];
+    uint64_t seed_;
+
+    // correlation coefficient a = exp(-d/2) and innovation weight sqrt(1 - a^2)
+    std::vector<double> correlation_;
+    std::vector<double> innovation_;
+
+    LteLinkShadowing();
+
+    // entry of the link in its shard, created if needed; the shard must be locked
+    Link& find(Shard& shard, uint32_t key);
+    void grow(Shard& shard);
+    // moves the links of the shard to a table of the given (power of two) size
+    void rehash(Shard& shard, size_t size);
+    void expire(Shard& shard, omnetpp::simtime_t now);
+
+    // applies the updates computed before "now"
+    void settle(Link& link, omnetpp::simtime_t now);
+    // keeps the update computed by a call at "now", unless another call of the same time wins
+    void propose(Update& update, double value, const inet::Coord& first, const inet::Coord& second,
+        omnetpp::simtime_t now);
+
+    // coefficients for a travelled distance of "d" correlation distances
+    void decorrelation(double d, double& a, double& b) const;
+
+    // uniform in (0,1) and standard normal draws of a link at the current time
+    double uniform(uint32_t key, uint32_t draw) const;
+    double normal(uint32_t key, uint32_t draw) const;
+};
+
+#endif
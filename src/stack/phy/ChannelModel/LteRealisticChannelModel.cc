@@ -8,6 +8,7 @@
 //
 
 #include "stack/phy/ChannelModel/LteRealisticChannelModel.h"
+#include "stack/phy/ChannelModel/LteLinkShadowing.h"
 #include "stack/phy/packet/LteAirFrame.h"
 #include "corenetwork/binder/LteBinder.h"
 #include "corenetwork/deployer/LteDeployer.h"
@@ -15,6 +16,9 @@
 #include "common/LteCommon.h"
 #include "corenetwork/nodes/ExtCell.h"
 #include "stack/phy/layer/LtePhyUe.h"
+#include "stack/phy/layer/LteReceptionEngine.h"
+#include "common/LteProfiler.h"
+#include "common/LteLog.h"
 
 // attenuation value to be returned if max. distance of a scenario has been violated
 // and tolerating the maximum distance violation is enabled
@@ -85,6 +89,13 @@ LteRealisticChannelModel::LteRealisticChannelModel(ParameterMap& params,
     else
         shadowing_ = true;
 
+    // flag for the D2D shadowing and LOS shared by the two directions of a link
+    it = params.find("pairwise-shadowing");
+    if (it != params.end())
+        pairwiseShadowing_ = it->second.boolValue();
+    else
+        pairwiseShadowing_ = false;
+
     // flag for enable/disable tolerating a violation of the scenario limits
     it = params.find("tolerateMaxDistViolation");
     if (it != params.end())
@@ -349,8 +360,6 @@ LteRealisticChannelModel::LteRealisticChannelModel(ParameterMap& params,
         delayRMS_ = 363e-9;
     //get binder
     binder_ = getBinder();
-    //clear jakes fading map structure
-    jakesFadingMap_.clear();
 }
 
 LteRealisticChannelModel::~LteRealisticChannelModel()
@@ -372,6 +381,9 @@ double LteRealisticChannelModel::getAttenuation(MacNodeId nodeId, Direction dir,
     double movement = .0;
     double speed = .0;
 
+    // drop the state of the peers not heard for a while
+    stateTable_.expire(NOW);
+
     //COMPUTE DISTANCE between ue and eNOdeB
     double sqrDistance = myCoord_.distance(coord);
 
@@ -383,7 +395,7 @@ double LteRealisticChannelModel::getAttenuation(MacNodeId nodeId, Direction dir,
     //If traveled distance is greater than correlation distance UE could have changed its state and
     // its visibility from eNodeb, hence it is correct to recompute the los probability
     if (movement > correlationDistance_
-            || losMap_.find(nodeId) == losMap_.end())
+            || !hasLos(nodeId))
     {
         computeLosProbability(sqrDistance, nodeId);
     }
@@ -429,25 +441,28 @@ double LteRealisticChannelModel::getAttenuation(MacNodeId nodeId, Direction dir,
         // if direction is UPLINK it means that this module is located in UE stack than
         // the Move object associated to the UE is move varible
 
+        LteChannelStateTable::PeerState& link = stateTable_.state(nodeId);
+
         // if shadowing for current user has never been computed
-        if (lastComputedSF_.find(nodeId) == lastComputedSF_.end())
+        if (!link.shadowingValid)
         {
             //Get the log normal shadowing with std deviation stdDev
-            att = normal(getEnvir()->getRNG(0), mean, stdDev);
+            att = normal(rng_, mean, stdDev);
 
             //store the shadowing attenuation for this user and the temporal mark
-            std::pair<simtime_t, double> tmp(NOW, att);
-            lastComputedSF_[nodeId] = tmp;
+            link.shadowingValid = true;
+            link.shadowingTime = NOW;
+            link.shadowing = att;
 
             //If the shadowing attenuation has been computed at least one time for this user
             // and the distance traveled by the UE is greated than correlation distance
         }
-        else if ((NOW - lastComputedSF_.at(nodeId).first).dbl() * speed
+        else if ((NOW - link.shadowingTime).dbl() * speed
                 > correlationDistance_)
         {
 
             //get the temporal mark of the last computed shadowing attenuation
-            time = (NOW - lastComputedSF_.at(nodeId).first).dbl();
+            time = (NOW - link.shadowingTime).dbl();
 
             //compute the traveled distance
             space = time * speed;
@@ -456,20 +471,20 @@ double LteRealisticChannelModel::getAttenuation(MacNodeId nodeId, Direction dir,
             double a = exp(-0.5 * (space / correlationDistance_));
 
             //Get last shadowing attenuation computed
-            double old = lastComputedSF_.at(nodeId).second;
+            double old = link.shadowing;
 
             //Compute shadowing with a EAW (Exponential Average Window) (step2)
-            att = a * old + sqrt(1 - pow(a, 2)) * normal(getEnvir()->getRNG(0), mean, stdDev);
+            att = a * old + sqrt(1 - pow(a, 2)) * normal(rng_, mean, stdDev);
 
             // Store the new computed shadowing
-            std::pair<simtime_t, double> tmp(NOW, att);
-            lastComputedSF_[nodeId] = tmp;
+            link.shadowingTime = NOW;
+            link.shadowing = att;
 
             // if the distance traveled by the UE is smaller than correlation distance shadowing attenuation remain the same
         }
         else
         {
-            att = lastComputedSF_.at(nodeId).second;
+            att = link.shadowing;
         }
         attenuation += att;
     }
@@ -494,6 +509,9 @@ std::tuple<double, double> LteRealisticChannelModel::getAttenuation_D2D(MacNodeI
     double movement = .0;
     double speed = .0;
 
+    // drop the state of the peers not heard for a while
+    stateTable_.expire(NOW);
+
     //COMPUTE DISTANCE between ue1 and ue2
     //double sqrDistance = myCoord_.distance(coord);
     double sqrDistance = coord.distance(coord_2);
@@ -503,10 +521,22 @@ std::tuple<double, double> LteRealisticChannelModel::getAttenuation_D2D(MacNodeI
     else //UL or D2D
         speed = computeSpeed(nodeId, coord);
 
+    if (pairwiseShadowing_)
+    {
+        // the link state is drawn again once its ends moved more than the correlation distance
+        LteChannelStateTable::PeerState& link = stateTable_.state(nodeId);
+        link.losValid = true;
+        if (dynamicLos_)
+            link.los = LteLinkShadowing::getInstance()->los(nodeId, coord, node2_Id, coord_2,
+                losProbability(sqrDistance), correlationDistance_);
+        else
+            link.los = fixedLos_;
+    }
     //If traveled distance is greater than correlation distance UE could have changed its state and
     // its visibility from eNodeb, hence it is correct to recompute the los probability
-    if (movement > correlationDistance_
-        || losMap_.find(nodeId) == losMap_.end())
+    // (movement is never updated here: the LOS of a sender is drawn once)
+    else if (movement > correlationDistance_
+        || !hasLos(nodeId))
     {
         computeLosProbability(sqrDistance, nodeId);
     }
@@ -566,24 +596,33 @@ std::tuple<double, double> LteRealisticChannelModel::getAttenuation_D2D(MacNodeI
         // if direction is UPLINK it means that this module is located in UE stack than
         // the Move object associated to the UE is move varible
 
+        LteChannelStateTable::PeerState& link = stateTable_.state(nodeId);
+
+        if (pairwiseShadowing_)
+        {
+            // same value for both directions, correlated with the movement of both ends
+            att = mean + LteLinkShadowing::getInstance()->shadowing(nodeId, coord, node2_Id, coord_2,
+                stdDev, correlationDistance_);
+        }
         // if shadowing for current user has never been computed
-        if (lastComputedSF_.find(nodeId) == lastComputedSF_.end())
+        else if (!link.shadowingValid)
         {
             //Get the log normal shadowing with std deviation stdDev
-            att = normal(getEnvir()->getRNG(0),mean, stdDev);
+            att = normal(rng_, mean, stdDev);
 
             //store the shadowing attenuation for this user and the temporal mark
-            std::pair<simtime_t, double> tmp(NOW, att);
-            lastComputedSF_[nodeId] = tmp;
+            link.shadowingValid = true;
+            link.shadowingTime = NOW;
+            link.shadowing = att;
 
             //If the shadowing attenuation has been computed at least one time for this user
             // and the distance traveled by the UE is greated than correlation distance
         }
-        else if ((NOW - lastComputedSF_.at(nodeId).first).dbl() * speed
+        else if ((NOW - link.shadowingTime).dbl() * speed
             > correlationDistance_)
         {
             //get the temporal mark of the last computed shadowing attenuation
-            time = (NOW - lastComputedSF_.at(nodeId).first).dbl();
+            time = (NOW - link.shadowingTime).dbl();
 
             //compute the traveled distance
             space = time * speed;
@@ -592,20 +631,20 @@ std::tuple<double, double> LteRealisticChannelModel::getAttenuation_D2D(MacNodeI
             double a = exp(-0.5 * (space / correlationDistance_));
 
             //Get last shadowing attenuation computed
-            double old = lastComputedSF_.at(nodeId).second;
+            double old = link.shadowing;
 
             //Compute shadowing with a EAW (Exponential Average Window) (step2)
-            att = a * old + sqrt(1 - pow(a, 2)) * normal(getEnvir()->getRNG(0),mean, stdDev);
+            att = a * old + sqrt(1 - pow(a, 2)) * normal(rng_,mean, stdDev);
 
             // Store the new computed shadowing
-            std::pair<simtime_t, double> tmp(NOW, att);
-            lastComputedSF_[nodeId] = tmp;
+            link.shadowingTime = NOW;
+            link.shadowing = att;
 
             // if the distance traveled by the UE is smaller than correlation distance shadowing attenuation remain the same
         }
         else
         {
-            att = lastComputedSF_.at(nodeId).second;
+            att = link.shadowing;
         }
 
         attenuation += att;
@@ -630,19 +669,23 @@ std::tuple<double, double> LteRealisticChannelModel::getAttenuation_D2D(MacNodeI
 void LteRealisticChannelModel::updatePositionHistory(const MacNodeId nodeId,
         const Coord coord)
 {
-    if (positionHistory_.find(nodeId) != positionHistory_.end())
-    {
-        // position already updated for this TTI.
-        if (positionHistory_[nodeId].back().first == NOW)
-            return;
-    }
+    LteChannelStateTable::PeerState& link = stateTable_.state(nodeId);
 
-    // FIXME: possible memory leak
-    positionHistory_[nodeId].push(Position(NOW, coord));
+    // position already updated for this TTI.
+    if (link.positions > 0 && link.positionTime[link.positions - 1] == NOW)
+        return;
 
-    if (positionHistory_[nodeId].size() > 2) // if we have more than a past and a current element
+    if (link.positions == 2) // if we have a past and a current element
+    {
         // drop the oldest one
-        positionHistory_[nodeId].pop();
+        link.positionTime[0] = link.positionTime[1];
+        link.position[0] = link.position[1];
+        link.positions = 1;
+    }
+
+    link.positionTime[link.positions] = NOW;
+    link.position[link.positions] = coord;
+    link.positions++;
 }
 
 double LteRealisticChannelModel::computeSpeed(const MacNodeId nodeId,
@@ -650,7 +693,8 @@ double LteRealisticChannelModel::computeSpeed(const MacNodeId nodeId,
 {
     double speed = 0.0;
 
-    if (positionHistory_.find(nodeId) == positionHistory_.end())
+    LteChannelStateTable::PeerState* link = &stateTable_.state(nodeId);
+    if (link->positions == 0)
     {
         // no entries
         return speed;
@@ -659,19 +703,19 @@ double LteRealisticChannelModel::computeSpeed(const MacNodeId nodeId,
     {
         //compute distance traveled from last update by UE (eNodeB position is fixed)
 
-        if (positionHistory_[nodeId].size() == 1)
+        if (link->positions == 1)
         {
             //  the only element refers to present , return 0
             return speed;
         }
 
-        double movement = positionHistory_[nodeId].front().second.distance(coord);
+        double movement = link->position[0].distance(coord);
 
         if (movement <= 0.0)
             return speed;
         else
         {
-            double time = (NOW.dbl()) - (positionHistory_[nodeId].front().first.dbl());
+            double time = (NOW.dbl()) - (link->positionTime[0].dbl());
             if (time <= 0.0) // time not updated since last speed call
                 throw cRuntimeError("Multiple entries detected in position history referring to same time");
             // compute speed
@@ -1012,6 +1056,7 @@ std::vector<double> LteRealisticChannelModel::getSINR(LteAirFrame *frame, UserCo
 
 std::tuple<std::vector<double>, double> LteRealisticChannelModel::getRSRP_D2D(LteAirFrame *frame, UserControlInfo* lteInfo_1, MacNodeId destId, Coord destCoord)
 {
+    LTE_PROFILE_SCOPE("LteRealisticChannelModel", "getRSRP_D2D");
     AttenuationVector::iterator it;
     // Get Tx power
     // This needs to be determined based on reduction due to the RBs used, so can't be this straight up.
@@ -1055,8 +1100,9 @@ std::tuple<std::vector<double>, double> LteRealisticChannelModel::getRSRP_D2D(Lt
         antennaGainTx = antennaGainRx = antennaGainUe_;
         //In D2D case the noise figure is the ueNoiseFigure_
         noiseFigure = ueNoiseFigure_;
-        // use the jakes map in the UE side
-        cqiDl = true;
+        // the receiver keeps the fading of its own links: using the table of
+        // the sender, all its receivers would share one fading realization
+        cqiDl = false;
     }
     // Compute speed
     speed = computeSpeed(sourceId, sourceCoord);
@@ -1099,7 +1145,7 @@ std::tuple<std::vector<double>, double> LteRealisticChannelModel::getRSRP_D2D(Lt
                 int distance = sourceCoord.distance(destCoord);
                 double pathLossFree = 20*std::log10(distance) + 46.4 + 20*std::log10(carrierFrequency_ * 1e-9 / 5);
 
-                fadingAttenuation = gamma_d(getEnvir()->getRNG(0), shapeFactor_, pathLossFree / 1000.0 / shapeFactor_) * 1000.0;
+                fadingAttenuation = gamma_d(rng_, shapeFactor_, pathLossFree / 1000.0 / shapeFactor_) * 1000.0;
             }
         }
 
@@ -1162,8 +1208,9 @@ std::vector<double> LteRealisticChannelModel::getSINR_D2D(LteAirFrame *frame, Us
         antennaGainTx = antennaGainRx = antennaGainUe_;
         //In D2D case the noise figure is the ueNoiseFigure_
         noiseFigure = ueNoiseFigure_;
-        // use the jakes map in the UE side
-        cqiDl = true;
+        // the receiver keeps the fading of its own links: using the table of
+        // the sender, all its receivers would share one fading realization
+        cqiDl = false;
     }
     // Compute speed
     speed = computeSpeed(sourceId, sourceCoord);
@@ -1417,7 +1464,7 @@ std::vector<double> LteRealisticChannelModel::getSINR_D2D(LteAirFrame *frame, Us
                 // compute final SINR
                 snrVector[i] = linearToDb(denSinr);
 
-                EV_FATAL << "CRITICAL TEST destCoord: " << destCoord.str() << " sourceCoord: "<< sourceCoord.str() << endl;
+                LTE_EV_DIAG << "CRITICAL TEST destCoord: " << destCoord.str() << " sourceCoord: "<< sourceCoord.str() << endl;
 
                 EV << "LteRealisticChannelModel::getSINR_D2D - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir) << " - snr[" << snrVector[i] << "]\n";
             }
@@ -1432,6 +1479,7 @@ std::vector<double> LteRealisticChannelModel::getSINR_D2D(LteAirFrame *frame, Us
 
 std::tuple<std::vector<double>, std::vector<double>> LteRealisticChannelModel::getRSSI_SINR(LteAirFrame *frame, UserControlInfo* lteInfo_1, MacNodeId destId, Coord destCoord,MacNodeId enbId,std::vector<double> rsrpVector)
 {
+    LTE_PROFILE_SCOPE("LteRealisticChannelModel", "getRSSI_SINR");
     std::vector<double> rssiVector = rsrpVector;
     std::vector<double> snrVector = rsrpVector;
 
@@ -1454,7 +1502,7 @@ std::tuple<std::vector<double>, std::vector<double>> LteRealisticChannelModel::g
         noiseFigure = ueNoiseFigure_;
     }
 
-    EV << "------------ GET SINR D2D----------------" << endl;
+    LTE_EV_DEBUG << "------------ GET SINR D2D----------------" << endl;
 
     /*
      * The RSSI will be calculated as follows
@@ -1503,11 +1551,11 @@ std::tuple<std::vector<double>, std::vector<double>> LteRealisticChannelModel::g
 
         // denominator expressed in dBm as (N+extCell+inCell)
         double denRssi;
-        EV << "LteRealisticChannelModel::getRSSI - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir)  << endl;
+        LTE_EV_DEBUG << "LteRealisticChannelModel::getRSSI - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir)  << endl;
 
         // denominator expressed in dBm as (N+extCell+inCell)
         double denSinr;
-        EV << "LteRealisticChannelModel::getSINR - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir)  << endl;
+        LTE_EV_DEBUG << "LteRealisticChannelModel::getSINR - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir)  << endl;
 
         // Add interference for each band
         for (unsigned int i = 0; i < band_; i++)
@@ -1546,7 +1594,7 @@ std::tuple<std::vector<double>, std::vector<double>> LteRealisticChannelModel::g
             // compute final SINR
             snrVector[i] -=  (noiseFigure + thermalNoise_);
 
-            EV << "LteRealisticChannelModel::getRSSI - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir) << " - rssi[" << rssiVector[i] << "]\n";
+            LTE_EV_DEBUG << "LteRealisticChannelModel::getRSSI - distance from my Peer = " << destCoord.distance(sourceCoord) << " - DIR=" << dirToA(dir) << " - rssi[" << rssiVector[i] << "]\n";
         }
     }
 
@@ -1665,40 +1713,37 @@ double LteRealisticChannelModel::jakesFading(MacNodeId nodeId, double speed,
      *
      * thus the actual map should be choosen carefully (i.e. just check the cqiDL flag)
      */
-    JakesFadingMap * actualJakesMap;
+    LteChannelStateTable* table;
 
     if (cqiDl) // if we are computing a DL CQI we need the Jakes Map stored on the UE side
-        actualJakesMap = obtainUeJakesMap(nodeId);
-
+    {
+        // the table of another node: the D2D receptions computed in parallel only use their own
+        if (LteReceptionEngine::inParallelBatch())
+            throw cRuntimeError("LteRealisticChannelModel::jakesFading - fading on the table of node %d from a parallel reception batch", nodeId);
+        table = obtainUeStateTable(nodeId);
+    }
     else
-        actualJakesMap = &jakesFadingMap_;
+        table = &stateTable_;
 
     //if this is the first time that we compute fading for current user
-    if (actualJakesMap->find(nodeId) == actualJakesMap->end())
+    bool created;
+    int fading = table->fading(nodeId, band_ * fadingPaths_, created);
+    double* angleOfArrival = table->fadingAngles(fading);
+    simtime_t* delaySpread = table->fadingDelays(fading);
+    if (created)
     {
-        //clear the map
-        // FIXME: possible memory leak
-        (*actualJakesMap)[nodeId].clear();
-
         //for each band we are going to create a jakes fading
         for (unsigned int j = 0; j < band_; j++)
         {
-            //clear some structure
-            JakesFadingData temp;
-            temp.angleOfArrival.clear();
-            temp.delaySpread.clear();
-
             //for each fading path
             for (int i = 0; i < fadingPaths_; i++)
             {
                 //get angle of arrivals
-                temp.angleOfArrival.push_back(cos(uniform(getEnvir()->getRNG(0),0, M_PI)));
+                angleOfArrival[j * fadingPaths_ + i] = cos(uniform(rng_,0, M_PI));
 
                 //get delay spread
-                temp.delaySpread.push_back(exponential(getEnvir()->getRNG(0),delayRMS_));
+                delaySpread[j * fadingPaths_ + i] = exponential(rng_,delayRMS_);
             }
-            //store the jakes fadint for this user
-            (*actualJakesMap)[nodeId].push_back(temp);
         }
     }
     // convert carrier frequency from GHz to Hz
@@ -1716,10 +1761,10 @@ double LteRealisticChannelModel::jakesFading(MacNodeId nodeId, double speed,
     for (int i = 0; i < fadingPaths_; i++)
     {
         // Phase shift due to Doppler => t-selectivity.
-        double phi_d = actualJakesMap->at(nodeId).at(band).angleOfArrival[i] * doppler_shift;
+        double phi_d = angleOfArrival[band * fadingPaths_ + i] * doppler_shift;
 
         // Phase shift due to delay spread => f-selectivity.
-        double phi_i = actualJakesMap->at(nodeId).at(band).delaySpread[i].dbl() * f;
+        double phi_i = delaySpread[band * fadingPaths_ + i].dbl() * f;
 
         // Calculate resulting phase due to t-selective and f-selective fading.
         double phi = 2.00 * M_PI * (phi_d * t.dbl() - phi_i);
@@ -1903,7 +1948,7 @@ bool LteRealisticChannelModel::error(LteAirFrame *frame,
     //Harq Reduction
     double totalPer = per * pow(harqReduction_, nTx - 1);
 
-    double er = uniform(getEnvir()->getRNG(0), 0.0, 1.0);
+    double er = uniform(rng_, 0.0, 1.0);
 
     EV << " LteRealisticChannelModel::error direction " << dirToA(dir)
                        << " node " << id << " total ERROR probability  " << per
@@ -2053,7 +2098,7 @@ bool LteRealisticChannelModel::error_D2D(LteAirFrame *frame, UserControlInfo* lt
     // Harq Reduction
     double totalPer = per * pow(harqReduction_, nTx - 1);
 
-    double er = uniform(getEnvir()->getRNG(0),0.0, 1.0);
+    double er = uniform(rng_,0.0, 1.0);
 
     EV << " LteRealisticChannelModel::error direction " << dirToA(dir)
        << " node " << id << " total ERROR probability  " << per
@@ -2074,6 +2119,7 @@ bool LteRealisticChannelModel::error_D2D(LteAirFrame *frame, UserControlInfo* lt
 
 std::tuple<bool, bool> LteRealisticChannelModel::error_Mode4(LteAirFrame *frame, UserControlInfo* lteInfo, std::vector<double> rsrpVector, std::vector<double> sinrVector, int mcs)
 {
+    LTE_PROFILE_SCOPE("LteRealisticChannelModel", "error_Mode4");
     EV << "LteRealisticChannelModel::error_Mode4" << endl;
 
     //get codeword
@@ -2203,7 +2249,7 @@ std::tuple<bool, bool> LteRealisticChannelModel::error_Mode4(LteAirFrame *frame,
             blerSinr = binder_->phyPisaData.GetPsschBler(binder_->phyPisaData.AWGN, binder_->phyPisaData.SISO, mcs, averageSinr);
     }
 
-    double er = uniform(getEnvir()->getRNG(0),0.0, 1.0);
+    double er = uniform(rng_,0.0, 1.0);
 
     bool resultSnr = true;
     bool resultSinr = true;
@@ -2225,12 +2271,23 @@ std::tuple<bool, bool> LteRealisticChannelModel::error_Mode4(LteAirFrame *frame,
 void LteRealisticChannelModel::computeLosProbability(double d,
         MacNodeId nodeId)
 {
-    double p = 0;
     if (!dynamicLos_)
     {
-        losMap_[nodeId] = fixedLos_;
+        LteChannelStateTable::PeerState& link = stateTable_.state(nodeId);
+        link.losValid = true;
+        link.los = fixedLos_;
         return;
     }
+    double p = losProbability(d);
+    double random = uniform(rng_, 0.0, 1.0);
+    LteChannelStateTable::PeerState& link = stateTable_.state(nodeId);
+    link.losValid = true;
+    link.los = (random <= p);
+}
+
+double LteRealisticChannelModel::losProbability(double d)
+{
+    double p = 0;
     switch (scenario_)
     {
     case INDOOR_HOTSPOT:
@@ -2264,17 +2321,13 @@ void LteRealisticChannelModel::computeLosProbability(double d,
     default:
         throw cRuntimeError("Wrong path-loss scenario value %d", scenario_);
     }
-    double random = uniform(getEnvir()->getRNG(0), 0.0, 1.0);
-    if (random <= p)
-        losMap_[nodeId] = true;
-    else
-        losMap_[nodeId] = false;
+    return p;
 }
 
 double LteRealisticChannelModel::computeIndoor(double d, MacNodeId nodeId)
 {
     double a, b;
-    if (losMap_[nodeId])
+    if (isLos(nodeId))
     {
         if (d > 150 || d < 3)
             throw cRuntimeError("Error LOS indoor path loss model is valid for 3<d<150");
@@ -2314,7 +2367,7 @@ double LteRealisticChannelModel::computeUrbanMicro(double d, MacNodeId nodeId)
     // causing sciDecoded ≈ 0 in the NLOS (URBAN_MICROCELL) scenario.
     // Original: log10(carrierFrequency_)  [4 occurrences in this function]
     double fc_GHz = carrierFrequency_ / 1e9;
-    if (losMap_[nodeId])
+    if (isLos(nodeId))
     {
         // LOS situation
         if (d > 5000){
@@ -2355,7 +2408,7 @@ double LteRealisticChannelModel::computeUrbanMacro(double d, MacNodeId nodeId)
     // (3GPP TR 36.843 Table A.2.1.1-2) expect fc in GHz for log10() terms.
     // Original: log10(carrierFrequency_) — added ~180 dB spurious path loss.
     double fc_GHz = carrierFrequency_ / 1e9;
-    if (losMap_[nodeId])
+    if (isLos(nodeId))
     {
         if (d > 5000){
             if(tolerateMaxDistViolation_)
@@ -2401,7 +2454,7 @@ double LteRealisticChannelModel::computeSubUrbanMacro(double d, double& dbp,
     // expect fc in GHz for log10() terms.
     // Original: log10(carrierFrequency_) — added ~180 dB spurious path loss.
     double fc_GHz = carrierFrequency_ / 1e9;
-    if (losMap_[nodeId])
+    if (isLos(nodeId))
     {
         if (d > 5000) {
             if(tolerateMaxDistViolation_)
@@ -2453,7 +2506,7 @@ double LteRealisticChannelModel::computeRuralMacro(double d, double& dbp,
     // expect fc in GHz for log10() terms.
     // Original: log10(carrierFrequency_) — added ~180 dB spurious path loss.
     double fc_GHz = carrierFrequency_ / 1e9;
-    if (losMap_[nodeId])
+    if (isLos(nodeId))
     {
         // LOS situation
         if (d > 10000) {
@@ -2497,24 +2550,24 @@ double LteRealisticChannelModel::getStdDev(bool dist, MacNodeId nodeId)
     {
     case URBAN_MICROCELL:
     case INDOOR_HOTSPOT:
-        if (losMap_[nodeId])
+        if (isLos(nodeId))
             return 3.;
         else
             return 4.;
         break;
     case ANALYTICAL:
-        if (losMap_[nodeId])
+        if (isLos(nodeId))
             return 3.;
         break;
     case URBAN_MACROCELL:
-        if (losMap_[nodeId])
+        if (isLos(nodeId))
             return 4.;
         else
             return 6.;
         break;
     case RURAL_MACROCELL:
     case SUBURBAN_MACROCELL:
-        if (losMap_[nodeId])
+        if (isLos(nodeId))
         {
             if (dist)
                 return 4.;
@@ -2683,7 +2736,10 @@ double LteRealisticChannelModel::computeExtCellPathLoss(double dist, MacNodeId n
         //         if the distance traveled by the UE is smaller than correlation distance shadowing attenuation remain the same
         //        else
         {
-            att = lastComputedSF_.at(nodeId).second;
+            LteChannelStateTable::PeerState* link = stateTable_.find(nodeId);
+            if (link == NULL || !link->shadowingValid)
+                throw cRuntimeError("LteRealisticChannelModel::computeExtCellPathLoss - no shadowing computed for node %d", nodeId);
+            att = link->shadowing;
         }
         EV << "(" << att << ")";
         attenuation += att;
@@ -2692,17 +2748,16 @@ double LteRealisticChannelModel::computeExtCellPathLoss(double dist, MacNodeId n
     return attenuation;
 }
 
-LteRealisticChannelModel::JakesFadingMap * LteRealisticChannelModel::obtainUeJakesMap(MacNodeId id)
+LteChannelStateTable* LteRealisticChannelModel::obtainUeStateTable(MacNodeId id)
 {
     // obtain a reference to UE phy
     LtePhyBase * ltePhy = check_and_cast<LtePhyBase*>(
             getSimulation()->getModule(binder_->getOmnetId(id))->getSubmodule("lteNic")->getSubmodule("phy"));
 
-    // get the associated channel and get a reference to its Jakes Map
+    // get the associated channel and get a reference to its state table
     LteRealisticChannelModel * re = dynamic_cast<LteRealisticChannelModel *>(ltePhy->getChannelModel());
-    JakesFadingMap * j = re->getJakesMap();
 
-    return j;
+    return re->getStateTable();
 }
 
 bool LteRealisticChannelModel::computeMultiCellInterference(MacNodeId eNbId, MacNodeId ueId, Coord coord, bool isCqi,
@@ -2814,6 +2869,7 @@ bool LteRealisticChannelModel::computeMultiCellInterference(MacNodeId eNbId, Mac
 bool LteRealisticChannelModel::computeInCellD2DInterference(MacNodeId eNbId, MacNodeId senderId, Coord senderCoord, MacNodeId destId, Coord destCoord, bool isCqi,
     std::vector<double> * interference,Direction dir)
 {
+    LTE_PROFILE_SCOPE("LteRealisticChannelModel", "computeInCellD2DInterference");
     EV << "**** In Cell D2D Interference for cellId[" << eNbId << "] node["<<destId<<"] ****" << endl;
 
     // Reference to the Physical Channel  of the Interfering UE
@@ -2828,6 +2884,12 @@ bool LteRealisticChannelModel::computeInCellD2DInterference(MacNodeId eNbId, Mac
 
     EV<<NOW<<"ComputeInCellD2DInterference for Node: "<<destId<<endl;
 
+    // bands of the channel in the RB bitmaps of the interferers
+    bool useBitmaps = band_ <= LtePhyUe::UsedRbBitmap::MAX_BANDS;
+    uint64_t bandMask[2];
+    bandMask[0] = (band_ >= 64) ? ~(uint64_t)0 : (((uint64_t)1 << band_) - 1);
+    bandMask[1] = (band_ >= 128) ? ~(uint64_t)0 : (band_ <= 64) ? 0 : (((uint64_t)1 << (band_ - 64)) - 1);
+
     // Get the list of all UEs
     std::vector<UeInfo*> * ueList = binder_->getUeList();
     std::vector<UeInfo*>::iterator it = ueList->begin(), et = ueList->end();
@@ -2865,6 +2927,34 @@ bool LteRealisticChannelModel::computeInCellD2DInterference(MacNodeId eNbId, Mac
         // Compute attenuation using data structures within the Macro Cell.
         std::tuple<double, double> attenuations = getAttenuation_D2D(interferringId, dir, ltePhy->getCoord(), destId, destCoord); // dB
         att = get<1>(attenuations);
+        LTE_PROFILE_COUNT("LteRealisticChannelModel", "inCellD2DInterferers", 1);
+
+        // resolved by the binder when the UE registered
+        const LteBinder::NodeHandles* handles = binder_->getNodeHandles(interferringId);
+        LtePhyUe* uePhy = (handles != NULL && handles->phyUe == ltePhy) ? handles->phyUe : check_and_cast<LtePhyUe*>(ltePhy);
+
+        // RBs of the actual TTI for the CQI, of the previous one for the decoding
+        const LtePhyUe::UsedRbBitmap* bitmap = useBitmaps ? uePhy->getUsedRbBitmap(isCqi ? NOW : NOW - TTI) : NULL;
+        if (bitmap != NULL)
+        {
+            uint64_t words[2] = { bitmap->words_[0] & bandMask[0], bitmap->words_[1] & bandMask[1] };
+            double bandInterference;
+            if (isCqi)
+                bandInterference = dBmToLinear(txPwr-att);
+            else
+            {
+                double usedRbCount = __builtin_popcountll(words[0]) + __builtin_popcountll(words[1]);
+                double recvPower = ltePhy->getTxPwr(dir) + 2 * antennaGainUe_; // dBm
+                bandInterference = dBmToLinear(recvPower-att) / (usedRbCount * 180000);
+            }
+
+            for (unsigned int w = 0; w < 2; w++)
+            {
+                for (uint64_t word = words[w]; word != 0; word &= word - 1)
+                    (*interference)[(w << 6) + __builtin_ctzll(word)] += bandInterference;
+            }
+            continue;
+        }
 
         // The antenna set in computeTxParams is always "MACRO". Here create a fake set with MACRO as the only element
         std::set<Remote> antennas;
@@ -2876,7 +2966,7 @@ bool LteRealisticChannelModel::computeInCellD2DInterference(MacNodeId eNbId, Mac
 
         for (antenna_it = antennas.begin(); antenna_it != antenna_et; ++antenna_it)
         {
-            usedRbCount = check_and_cast<LtePhyUe*>(ltePhy)->getPrevUsedNumberOfRbs(*antenna_it, band_);
+            usedRbCount = uePhy->getPrevUsedNumberOfRbs(*antenna_it, band_);
         }
 
         // CQI computation. We need to check the slot occupation of the actual TTI
@@ -2887,7 +2977,7 @@ bool LteRealisticChannelModel::computeInCellD2DInterference(MacNodeId eNbId, Mac
             {
                 for (antenna_it = antennas.begin(); antenna_it != antenna_et; ++antenna_it)
                 {
-                    temp = check_and_cast<LtePhyUe*>(ltePhy)->getUsedRbs(*antenna_it, i);
+                    temp = uePhy->getUsedRbs(*antenna_it, i);
                     // Compute interference only if the band is occupied by an Interfering Node
                     if( temp!=0 )
                     {
@@ -2904,7 +2994,7 @@ bool LteRealisticChannelModel::computeInCellD2DInterference(MacNodeId eNbId, Mac
             {
                 for (antenna_it = antennas.begin(); antenna_it != antenna_et; ++antenna_it)
                 {
-                    temp = check_and_cast<LtePhyUe*>(ltePhy)->getPrevUsedRbs(*antenna_it, i);
+                    temp = uePhy->getPrevUsedRbs(*antenna_it, i);
                     // Compute interference only if the band was occupied by an interfering Node
                     if( temp!=0 )
                     {
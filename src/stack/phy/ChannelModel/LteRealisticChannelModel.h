@@ -11,6 +11,7 @@
 #define _LTE_LTEREALISTICCHANNELMODEL_H_
 
 #include "stack/phy/ChannelModel/LteChannelModel.h"
+#include "stack/phy/ChannelModel/LteChannelStateStore.h"
 #include "inet/physicallayer/pathloss/NakagamiFading.h"
 
 class LteBinder;
@@ -49,24 +50,29 @@ class LteRealisticChannelModel : public LteChannelModel
     // enable/disable the shadowing
     bool shadowing_;
 
+    // D2D shadowing and LOS kept per link, shared with the other models (see LteLinkShadowing)
+    bool pairwiseShadowing_;
+
     // enable/disable intercell interference computation
     bool enableExtCellInterference_;
     bool enableMultiCellInterference_;
     bool enableD2DInCellInterference_;
 
-    typedef std::pair<simtime_t, inet::Coord> Position;
-
-    // last position of current user
-    std::map<MacNodeId, std::queue<Position> > positionHistory_;
-
     // scenario
     DeploymentScenario scenario_;
 
-    // map that stores for each user if is in Line of Sight or not with eNodeB
-    std::map<MacNodeId, bool> losMap_;
+    // per-peer state: LOS, last computed shadowing, position history, Jakes fading
+    LteChannelStateTable stateTable_;
 
-    // Store the last computed shadowing for each user
-    std::map<MacNodeId, std::pair<simtime_t, double> > lastComputedSF_;
+    // LOS state of the link with a user (false if never computed), transient state included
+    bool isLos(MacNodeId nodeId)
+    {
+        return stateTable_.state(nodeId).los;
+    }
+    bool hasLos(MacNodeId nodeId)
+    {
+        return stateTable_.state(nodeId).losValid;
+    }
 
     //correlation distance used in shadowing computation and
     //also used to recompute the probability of LOS
@@ -118,21 +124,6 @@ class LteRealisticChannelModel : public LteChannelModel
 
     bool tolerateMaxDistViolation_;
 
-    //Struct used to store information about jakes fading
-    struct JakesFadingData
-    {
-        std::vector<double> angleOfArrival;
-        std::vector<simtime_t> delaySpread;
-    };
-
-    // for each node and for each band we store information about jakes fading
-    std::map<MacNodeId, std::vector<JakesFadingData> > jakesFadingMap_;
-
-    typedef std::vector<JakesFadingData> JakesFadingVector;
-    typedef std::map<MacNodeId, JakesFadingVector> JakesFadingMap;
-
-//    typedef std::map<MacNodeId,std::vector<JakesFadingData> > JakesFadingMap;
-
     enum FadingType
     {
         RAYLEIGH, JAKES, NAKAGAMI
@@ -318,9 +309,12 @@ class LteRealisticChannelModel : public LteChannelModel
      */
     void computeLosProbability(double d, MacNodeId nodeId);
 
-    JakesFadingMap * getJakesMap()
+    // LOS probability at distance d for the scenario (dynamic LOS only)
+    double losProbability(double d);
+
+    LteChannelStateTable* getStateTable()
     {
-        return &jakesFadingMap_;
+        return &stateTable_;
     }
 
   protected:
@@ -364,10 +358,10 @@ class LteRealisticChannelModel : public LteChannelModel
     double computeExtCellPathLoss(double dist, MacNodeId nodeId);
 
     /*
-     * Obtain the jakes map for the specified UE
+     * Obtain the state table (holding the jakes data) of the specified UE
      * @param id mac id of the user
      */
-    JakesFadingMap * obtainUeJakesMap(MacNodeId id);
+    LteChannelStateTable* obtainUeStateTable(MacNodeId id);
 };
 
 #endif
@@ -11,7 +11,9 @@
 #include "common/LteCommon.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
 #include "veins/base/modules/BaseMobility.h"
+#include "world/mobility/HighwayMobility.h"
 #include "inet/mobility/contract/IMobility.h"
+#include "common/LteLog.h"
 
 short LtePhyBase::airFramePriority_ = 10;
 
@@ -144,7 +146,7 @@ void LtePhyBase::handleUpperMessage(cMessage* msg)
     frame->setDuration(TTI);
     // set current position
     lteInfo->setCoord(getRadioPosition());
-    EV_FATAL <<"CRITICAL TEST: Co-ordinate is set in LtePhyBase::handleUpperMessage"<<endl;
+    LTE_EV_DIAG <<"CRITICAL TEST: Co-ordinate is set in LtePhyBase::handleUpperMessage"<<endl;
 
     lteInfo->setTxPower(txPower_);
     frame->setControlInfo(lteInfo);
@@ -223,8 +225,8 @@ void LtePhyBase::updateDisplayString()
 void LtePhyBase::sendBroadcast(LteAirFrame *airFrame)
 {
     // delegate the ChannelControl to send the airframe
-    EV_FATAL <<"CRITICAL TEST: Size just before sending: "<< airFrame->getByteLength()<<endl;
-    EV_FATAL <<"CRITICAL TEST: Time just before sending: "<< airFrame->getCreationTime().dbl() * 1000.0 <<endl;
+    LTE_EV_DIAG <<"CRITICAL TEST: Size just before sending: "<< airFrame->getByteLength()<<endl;
+    LTE_EV_DIAG <<"CRITICAL TEST: Time just before sending: "<< airFrame->getCreationTime().dbl() * 1000.0 <<endl;
 
     airFrame->setTimestamp(simTime());
     sendToChannel(airFrame);
@@ -335,7 +337,9 @@ void LtePhyBase::sendUnicast(LteAirFrame *frame)
 
 const inet::Coord& LtePhyBase::getCoord()
 {
-    static inet::Coord out;  // persist last good value (starts 0,0,0)
+    // persist last good value (starts 0,0,0); one per thread, as the
+    // reception engine reads the positions of the interferers concurrently
+    static thread_local inet::Coord out;
 
     // lteNic.phy -> parent is lteNic, grandparent is the host (car/rsu)
     cModule* lteNic = getParentModule();
@@ -367,7 +371,14 @@ const inet::Coord& LtePhyBase::getCoord()
         return out;
     }
 
-    // Case 2: RSU using Veins BaseMobility (stationary via x/y/z in omnetpp.ini)
+    // Case 2: vehicles using the built-in highway/grid mobility (no SUMO)
+    if (auto native = dynamic_cast<HighwayMobility*>(mob)) {
+        const auto p = native->getPositionAt(simTime());
+        out.x = p.x; out.y = p.y; out.z = p.z;
+        return out;
+    }
+
+    // Case 3: RSU using Veins BaseMobility (stationary via x/y/z in omnetpp.ini)
     if (dynamic_cast<veins::BaseMobility*>(mob)) {
         // Use the explicit params you set: *.rsu[*].veinsmobility.{x,y,z}
         bool updated = false;
@@ -19,6 +19,7 @@ LtePhyUe::LtePhyUe()
 {
     handoverStarter_ = NULL;
     handoverTrigger_ = NULL;
+    usedRbBitmapsValid_ = true;
 }
 
 LtePhyUe::~LtePhyUe()
@@ -27,6 +28,43 @@ LtePhyUe::~LtePhyUe()
     delete das_;
 }
 
+void LtePhyUe::storeUsedRbs(const RbMap& rbMap)
+{
+    UsedRBs info;
+    info.time_ = NOW;
+    info.rbMap_ = rbMap;
+    usedRbs_.push_back(info);
+
+    // a second transmission in the same TTI adds its RBs to the same bitmap,
+    // otherwise the older one is reused
+    UsedRbBitmap* bitmap;
+    if (usedRbBitmaps_[0].time_ == NOW)
+        bitmap = &usedRbBitmaps_[0];
+    else if (usedRbBitmaps_[1].time_ == NOW)
+        bitmap = &usedRbBitmaps_[1];
+    else
+    {
+        bitmap = (usedRbBitmaps_[0].time_ < usedRbBitmaps_[1].time_) ? &usedRbBitmaps_[0] : &usedRbBitmaps_[1];
+        *bitmap = UsedRbBitmap();
+        bitmap->time_ = NOW;
+    }
+
+    RbMap::const_iterator at = rbMap.find(MACRO);
+    if (at == rbMap.end())
+        return;
+    for (std::map<Band, unsigned int>::const_iterator bt = at->second.begin(); bt != at->second.end(); ++bt)
+    {
+        if (bt->second == 0)
+            continue;
+        if (bt->first >= UsedRbBitmap::MAX_BANDS)
+        {
+            usedRbBitmapsValid_ = false;
+            return;
+        }
+        bitmap->set(bt->first);
+    }
+}
+
 void LtePhyUe::initialize(int stage)
 {
     LtePhyBase::initialize(stage);
@@ -488,11 +526,7 @@ void LtePhyUe::handleUpperMessage(cMessage* msg)
 
     // Store the RBs used for transmission. For interference computation
     RbMap rbMap = lteInfo->getGrantedBlocks();
-    UsedRBs info;
-    info.time_ = NOW;
-    info.rbMap_ = rbMap;
-
-    usedRbs_.push_back(info);
+    storeUsedRbs(rbMap);
 
     std::vector<UsedRBs>::iterator it = usedRbs_.begin();
     while (it != usedRbs_.end())  // purge old allocations
@@ -103,6 +103,44 @@ class LtePhyUe : public LtePhyBase
     };
     std::vector<UsedRBs> usedRbs_;
 
+  public:
+    /**
+     * RBs used on the MACRO antenna in one TTI, as a bitmap. Written at
+     * transmit time, read by the in-cell D2D interference of every receiver,
+     * which walks the set bits and counts them with popcount instead of
+     * looking up each band in the RbMap.
+     */
+    struct UsedRbBitmap
+    {
+        static const unsigned int MAX_BANDS = 128;
+
+        simtime_t time_;
+        uint64_t words_[2];
+
+        UsedRbBitmap() : time_(-1) { words_[0] = words_[1] = 0; }
+
+        void set(Band b) { words_[b >> 6] |= (uint64_t)1 << (b & 63); }
+    };
+
+  protected:
+    // bitmaps of the last two transmission TTIs, valid while all the bands fit
+    UsedRbBitmap usedRbBitmaps_[2];
+    bool usedRbBitmapsValid_;
+
+    // publishes the RBs of a transmission of this TTI, with usedRbs_
+    void storeUsedRbs(const RbMap& rbMap);
+
+    // lookup that never inserts: the getters below are called concurrently by
+    // the receptions of other nodes (see LteReceptionEngine)
+    static unsigned int usedRbsOf(const RbMap& rbMap, const Remote antenna, Band b)
+    {
+        RbMap::const_iterator at = rbMap.find(antenna);
+        if (at == rbMap.end())
+            return 0;
+        std::map<Band, unsigned int>::const_iterator bt = at->second.find(b);
+        return bt == at->second.end() ? 0 : bt->second;
+    }
+
     virtual void initialize(int stage);
     virtual void handleSelfMessage(cMessage *msg);
     virtual void handleAirFrame(cMessage* msg);
@@ -153,8 +191,9 @@ class LtePhyUe : public LtePhyBase
         for (; it != usedRbs_.end(); ++it)
         {
             if (it->time_ == NOW)
-                return it->rbMap_[antenna][b];
+                return usedRbsOf(it->rbMap_, antenna, b);
         }
+        return 0;
     }
     unsigned int getPrevUsedRbs(const Remote antenna, Band b)
     {
@@ -162,10 +201,26 @@ class LtePhyUe : public LtePhyBase
         for (; it != usedRbs_.end(); ++it)
         {
             if (it->time_ == NOW-0.001)
-                return it->rbMap_[antenna][b];
+                return usedRbsOf(it->rbMap_, antenna, b);
         }
         return 0;
     }
+    /**
+     * Bitmap of the RBs used in the TTI "t" (NOW or NOW - TTI), NULL when this
+     * UE did not transmit then or used a band beyond UsedRbBitmap::MAX_BANDS:
+     * the callers then fall back to getUsedRbs() and getPrevUsedRbs()
+     */
+    const UsedRbBitmap* getUsedRbBitmap(simtime_t t) const
+    {
+        if (!usedRbBitmapsValid_)
+            return NULL;
+        for (const UsedRbBitmap& bitmap : usedRbBitmaps_)
+        {
+            if (bitmap.time_ == t)
+                return &bitmap;
+        }
+        return NULL;
+    }
     double getPrevUsedNumberOfRbs(const Remote antenna, int numBands)
     {
         std::vector<UsedRBs>::iterator it = usedRbs_.begin();
@@ -174,7 +229,7 @@ class LtePhyUe : public LtePhyBase
         {
             if (it->time_ == NOW-0.001){
                 for(unsigned int i=0;i<numBands;i++) {
-                    if (it->rbMap_[antenna][i] != 0)
+                    if (usedRbsOf(it->rbMap_, antenna, i) != 0)
                         usedRBs++;
                 }
             }
@@ -11,6 +11,7 @@
 #include "stack/phy/layer/LtePhyUeD2D.h"
 #include "stack/phy/packet/LteFeedbackPkt.h"
 #include "stack/d2dModeSelection/D2DModeSelectionBase.h"
+#include "common/LteLog.h"
 
 Define_Module(LtePhyUeD2D);
 
@@ -241,11 +242,7 @@ void LtePhyUeD2D::handleUpperMessage(cMessage* msg)
 
     // Store the RBs used for transmission. For interference computation
     RbMap rbMap = lteInfo->getGrantedBlocks();
-    UsedRBs info;
-    info.time_ = NOW;
-    info.rbMap_ = rbMap;
-
-    usedRbs_.push_back(info);
+    storeUsedRbs(rbMap);
 
     std::vector<UsedRBs>::iterator it = usedRbs_.begin();
     while (it != usedRbs_.end())  // purge old allocations
@@ -287,7 +284,7 @@ void LtePhyUeD2D::handleUpperMessage(cMessage* msg)
     frame->setDuration(TTI);
     // set current position
     lteInfo->setCoord(getRadioPosition());
-    EV_FATAL <<"CRITICAL TEST: Co-ordinate is set in LtePhyUeD2D::handleUpperMessage"<<endl;
+    LTE_EV_DIAG <<"CRITICAL TEST: Co-ordinate is set in LtePhyUeD2D::handleUpperMessage"<<endl;
 
     lteInfo->setTxPower(txPower_);
     lteInfo->setD2dTxPower(d2dTxPower_);
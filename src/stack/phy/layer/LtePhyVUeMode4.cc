@@ -20,7 +20,10 @@
 #include "stack/phy/packet/LteFeedbackPkt.h"
 #include "stack/d2dModeSelection/D2DModeSelectionBase.h"
 #include "stack/phy/packet/SpsCandidateResources.h"
-#include "stack/phy/packet/cbr_m.h"
+#include "stack/phy/packet/Cbr.h"
+#include "common/LteProfiler.h"
+#include "common/LteLog.h"
+#include "common/LteStreamRng.h"
 
 #include <fstream>
 #include <iomanip>
@@ -69,10 +72,20 @@ LtePhyVUeMode4::LtePhyVUeMode4()
 {
     handoverStarter_ = NULL;
     handoverTrigger_ = NULL;
+    updateSubframeTimer_ = NULL;
+    pendingSci_ = NULL;
+    receptionEngine_ = NULL;
+    receptionRng_ = NULL;
 }
 
 LtePhyVUeMode4::~LtePhyVUeMode4()
 {
+    cancelAndDelete(updateSubframeTimer_);
+    delete pendingSci_;
+
+    if (receptionEngine_ != NULL)
+        receptionEngine_->cancel(this);
+    delete receptionRng_;
 }
 
 void LtePhyVUeMode4::initialize(int stage)
@@ -83,6 +96,7 @@ void LtePhyVUeMode4::initialize(int stage)
     if (stage == inet::INITSTAGE_LOCAL)
     {
         adjacencyPSCCHPSSCH_             = par("adjacencyPSCCHPSSCH");
+        mergedSciTb_                     = par("mergedSciTb");
         randomScheduling_                = par("randomScheduling");
         sensingWindowSizeOverride_       = par("sensingWindowSizeOverride");
         pStep_                           = par("pStep");
@@ -192,6 +206,22 @@ void LtePhyVUeMode4::initialize(int stage)
         posX                        = registerSignal("posX");
         posY                        = registerSignal("posY");
 
+        tbNotReceived               = registerSignal("tbNotReceived");
+
+        std::string statRecording = par("statRecording").stdstringValue();
+        if (statRecording == "aggregated")
+            aggregateStats_ = true;
+        else if (statRecording == "perEvent")
+            aggregateStats_ = false;
+        else
+            throw cRuntimeError("LtePhyVUeMode4::initialize - unknown statRecording '%s' (perEvent|aggregated)", statRecording.c_str());
+
+        if (aggregateStats_)
+            statAggregator_.init(this, par("statBucket").doubleValue(), par("pdrDistanceBin").doubleValue(), par("pdrDistanceBins").intValue());
+
+        positionSampling_ = par("positionSampling");
+        positionCountDown_ = 1;
+
         subchannelReceived_ = 0;
         subchannelsUsed_ = 0;
 
@@ -209,6 +239,15 @@ void LtePhyVUeMode4::initialize(int stage)
 
         nodeId_ = getAncestorPar("macNodeId");
 
+        // batched receptions: the channel of this node draws from a stream of its own
+        LteReceptionEngine* engine = LteReceptionEngine::getInstance();
+        if (engine->isEnabled())
+        {
+            receptionEngine_ = engine;
+            receptionRng_ = new LteStreamRng(LteStreamRng::getRunSeedSet(), nodeId_);
+            channelModel_->setRNG(receptionRng_);
+        }
+
         initialiseSensingWindow();
     }
 }
@@ -217,6 +256,10 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
 {
     if (msg->isName("d2dDecodingTimer"))
     {
+        // the first timer of the TTI processes the receptions of all the nodes
+        if (receptionEngine_ != NULL)
+            receptionEngine_->flush();
+
         std::sort(begin(sciInfo_), end(sciInfo_), [](const std::tuple<LteAirFrame*, std::vector<double>, std::vector<double>, std::vector<double>, double, double> &t1,
         const std::tuple<LteAirFrame*, std::vector<double>, std::vector<double>, std::vector<double>, double, double> &t2) {
             return get<5>(t1) < get<5>(t2); // or use a custom compare function
@@ -264,14 +307,14 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
             // decode the selected frame
             decodeAirFrame(frame, lteInfo, rsrpVector, rssiVector, sinrVector, attenuation);
 
-            emit(sciReceived, sciReceived_);
-            emit(sciUnsensed, sciUnsensed_);
-            emit(sciDecoded, sciDecoded_);
-            emit(sciFailedDueToProp, sciFailedDueToProp_);
-            emit(sciFailedDueToInterference, sciFailedDueToInterference_);
-            emit(sciFailedHalfDuplex, sciFailedHalfDuplex_);
-            emit(subchannelReceived, subchannelReceived_);
-            emit(subchannelsUsed, subchannelsUsed_);
+            recordStat(sciReceived, sciReceived_);
+            recordStat(sciUnsensed, sciUnsensed_);
+            recordStat(sciDecoded, sciDecoded_);
+            recordStat(sciFailedDueToProp, sciFailedDueToProp_);
+            recordStat(sciFailedDueToInterference, sciFailedDueToInterference_);
+            recordStat(sciFailedHalfDuplex, sciFailedHalfDuplex_);
+            recordStat(subchannelReceived, subchannelReceived_);
+            recordStat(subchannelsUsed, subchannelsUsed_);
 
             sciReceived_ = 0;
             sciDecoded_ = 0;
@@ -289,19 +332,7 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
             if(missingPosition != missingTbs.end()) {
                 missingTbs.erase(missingPosition);
                 // This corresponds to where we are missing a TB, record results as being negative to identify this.
-                emit(txRxDistanceTB, -1);
-                emit(tbReceived, -1);
-                emit(tbDecoded, -1);
-                emit(tbFailedDueToNoSCI, -1);
-                emit(tbFailedDueToProp, -1);
-                emit(tbFailedDueToInterference, -1);
-                emit(tbFailedButSCIReceived, -1);
-                emit(tbFailedHalfDuplex, -1);
-                emit(periodic, -1);
-
-                emit(tbFailedDueToPropIgnoreSCI ,-1);
-                emit(tbFailedDueToInterferenceIgnoreSCI ,-1);
-                emit(tbDecodedIgnoreSCI ,-1);
+                recordMissingTb();
             } else {
                 std::tuple<LteAirFrame*, std::vector<double>, std::vector<double>, std::vector<double>, double, double> tbTuple = tbInfo_.back();
                 LteAirFrame* frame = get<0>(tbTuple);
@@ -317,18 +348,18 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
                 // decode the selected frame
                 decodeAirFrame(frame, lteInfo, rsrpVector, rssiVector, sinrVector, attenuation);
 
-                emit(tbReceived, tbReceived_);
-                emit(tbDecoded, tbDecoded_);
-                emit(tbFailedDueToNoSCI, tbFailedDueToNoSCI_);
-                emit(tbFailedDueToProp, tbFailedDueToProp_);
-                emit(tbFailedDueToInterference, tbFailedDueToInterference_);
-                emit(tbFailedButSCIReceived, tbFailedButSCIReceived_);
-                emit(tbFailedHalfDuplex, tbFailedHalfDuplex_);
-                emit(periodic, int(lteInfo->getPeriodic()));
+                recordStat(tbReceived, tbReceived_);
+                recordStat(tbDecoded, tbDecoded_);
+                recordStat(tbFailedDueToNoSCI, tbFailedDueToNoSCI_);
+                recordStat(tbFailedDueToProp, tbFailedDueToProp_);
+                recordStat(tbFailedDueToInterference, tbFailedDueToInterference_);
+                recordStat(tbFailedButSCIReceived, tbFailedButSCIReceived_);
+                recordStat(tbFailedHalfDuplex, tbFailedHalfDuplex_);
+                recordStat(periodic, int(lteInfo->getPeriodic()));
 
-                emit(tbFailedDueToPropIgnoreSCI ,tbFailedDueToPropIgnoreSCI_);
-                emit(tbFailedDueToInterferenceIgnoreSCI ,tbFailedDueToInterferenceIgnoreSCI_);
-                emit(tbDecodedIgnoreSCI ,tbDecodedIgnoreSCI_);
+                recordStat(tbFailedDueToPropIgnoreSCI, tbFailedDueToPropIgnoreSCI_);
+                recordStat(tbFailedDueToInterferenceIgnoreSCI, tbFailedDueToInterferenceIgnoreSCI_);
+                recordStat(tbDecodedIgnoreSCI, tbDecodedIgnoreSCI_);
 
                 tbReceived_ = 0;
                 tbDecoded_ = 0;
@@ -346,19 +377,7 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
         }
         if (!missingTbs.empty()){
             for(int i=0; i<missingTbs.size(); i++){
-                emit(txRxDistanceTB, -1);
-                emit(tbReceived, -1);
-                emit(tbDecoded, -1);
-                emit(tbFailedDueToNoSCI, -1);
-                emit(tbFailedDueToProp, -1);
-                emit(tbFailedDueToInterference, -1);
-                emit(tbFailedButSCIReceived, -1);
-                emit(tbFailedHalfDuplex, -1);
-                emit(periodic, -1);
-
-                emit(tbFailedDueToPropIgnoreSCI ,-1);
-                emit(tbFailedDueToInterferenceIgnoreSCI ,-1);
-                emit(tbDecodedIgnoreSCI ,-1);
+                recordMissingTb();
             }
         }
         std::vector<cPacket*>::iterator it;
@@ -374,6 +393,9 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
     }
     else if (msg->isName("updateSubframe"))
     {
+        // an SCI still pending here lost its TB: it goes out on its own
+        flushPendingSci();
+
         transmitting_ = false;
         if (beginTransmission_){
             transmitting_ = true;
@@ -392,7 +414,7 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
         } else {
             cbrCountDown_ --;
         }
-        delete msg;
+        // msg is updateSubframeTimer_, already rescheduled by updateSubframe()
     }
     else
         LtePhyUe::handleSelfMessage(msg);
@@ -401,6 +423,7 @@ void LtePhyVUeMode4::handleSelfMessage(cMessage *msg)
 // TODO: ***reorganize*** method
 void LtePhyVUeMode4::handleAirFrame(cMessage* msg)
 {
+    LTE_PROFILE_SCOPE("LtePhyVUeMode4", "handleAirFrame");
     UserControlInfo* lteInfo = check_and_cast<UserControlInfo*>(msg->removeControlInfo());
 
     connectedNodeId_ = masterId_;
@@ -443,15 +466,18 @@ void LtePhyVUeMode4::handleAirFrame(cMessage* msg)
     }
 
     Coord myCoord = getCoord();
-    EV_FATAL <<"CRITICAL TEST: Receiver Co-ordinates: X:"<< myCoord.str() <<endl;
-    EV_FATAL <<"CRITICAL TEST: Sender Co-ordinates: X:"<< lteInfo->getCoord().str() <<endl;
+    LTE_EV_DIAG <<"CRITICAL TEST: Receiver Co-ordinates: X:"<< myCoord.str() <<endl;
+    LTE_EV_DIAG <<"CRITICAL TEST: Sender Co-ordinates: X:"<< lteInfo->getCoord().str() <<endl;
     // Only store frames which are within 1500m over this the interference caused is negligible.
     if (myCoord.distance(lteInfo->getCoord()) < 1500) {
         // store frame, together with related control info
         frame->setControlInfo(lteInfo);
 
         // Capture the Airframe for decoding later
-        storeAirFrame(frame);
+        if (receptionEngine_ != NULL)
+            receptionEngine_->deliver(this, frame, myCoord);
+        else
+            storeAirFrame(frame);
     } else {
         delete lteInfo;
         delete frame;
@@ -480,6 +506,8 @@ void LtePhyVUeMode4::handleUpperMessage(cMessage* msg)
         }
         else
         {
+            flushPendingSci();
+
             sciGrant_ = grant;
             lteInfo->setUserTxParams(sciGrant_->getUserTxParams()->dup());
             lteInfo->setGrantedBlocks(sciGrant_->getGrantedBlocks());
@@ -523,7 +551,14 @@ void LtePhyVUeMode4::handleUpperMessage(cMessage* msg)
 
     frame = prepareAirFrame(msg, lteInfo);
 
-    emit(tbSent, 1);
+    if (pendingSci_ != NULL)
+    {
+        // PSCCH and PSSCH of this transmission leave on the same frame
+        frame->setSciPart(pendingSci_);
+        pendingSci_ = NULL;
+    }
+
+    recordStat(tbSent, 1);
 
     if (lteInfo->getDirection() == D2D_MULTI)
         sendBroadcast(frame);
@@ -594,11 +629,7 @@ RbMap LtePhyVUeMode4::sendSciMessage(cMessage* msg, UserControlInfo* lteInfo)
     }
 
     // Store the RBs used for transmission. For interference computation
-    UsedRBs info;
-    info.time_ = NOW;
-    info.rbMap_ = allRbs;
-
-    usedRbs_.push_back(info);
+    storeUsedRbs(allRbs);
 
     std::vector<UsedRBs>::iterator it = usedRbs_.begin();
     while (it != usedRbs_.end())  // purge old allocations
@@ -624,12 +655,25 @@ RbMap LtePhyVUeMode4::sendSciMessage(cMessage* msg, UserControlInfo* lteInfo)
 
     // create LteAirFrame and encapsulate the received packet
     SidelinkControlInformation* SCI = createSCIMessage();
-    LteAirFrame* sciFrame = prepareAirFrame(SCI, SCIInfo);
 
-    emit(sciSent, 1);
-    emit(subchannelSent, sciGrant_->getStartingSubchannel());
-    emit(subchannelsUsedToSend, sciGrant_->getNumSubchannels());
-    sendBroadcast(sciFrame);
+    recordStat(sciSent, 1);
+    recordStat(subchannelSent, sciGrant_->getStartingSubchannel());
+    recordStat(subchannelsUsedToSend, sciGrant_->getNumSubchannels());
+
+    if (mergedSciTb_)
+    {
+        // the SCI rides on the frame of the TB that follows in this TTI
+        SCIInfo->setCoord(getCoord());
+        SCIInfo->setTxPower(txPower_);
+        SCIInfo->setD2dTxPower(d2dTxPower_);
+        SCI->setControlInfo(SCIInfo);
+        pendingSci_ = SCI;
+    }
+    else
+    {
+        LteAirFrame* sciFrame = prepareAirFrame(SCI, SCIInfo);
+        sendBroadcast(sciFrame);
+    }
 
     delete sciGrant_;
     delete lteInfo;
@@ -637,6 +681,17 @@ RbMap LtePhyVUeMode4::sendSciMessage(cMessage* msg, UserControlInfo* lteInfo)
     return (rbMap);
 }
 
+void LtePhyVUeMode4::flushPendingSci()
+{
+    if (pendingSci_ == NULL)
+        return;
+
+    UserControlInfo* sciInfo = check_and_cast<UserControlInfo*>(pendingSci_->removeControlInfo());
+    LteAirFrame* sciFrame = prepareAirFrame(pendingSci_, sciInfo);
+    pendingSci_ = NULL;
+    sendBroadcast(sciFrame);
+}
+
 void LtePhyVUeMode4::computeRandomCSRs(LteMode4SchedulingGrant* &grant) {
     // Function determines all possible CSRs which fit the packet and returns this to the MAC layer
     // Determine the total number of possible CSRs
@@ -709,6 +764,18 @@ void LtePhyVUeMode4::computeRandomCSRs(LteMode4SchedulingGrant* &grant) {
 }
 
 void LtePhyVUeMode4::computeCSRs(LteMode4SchedulingGrant* &grant) {
+    LTE_PROFILE_SCOPE("LtePhyVUeMode4", "computeCSRs");
+    std::vector<std::tuple<double, int, int, bool>> optimalCSRs = selectCSRs(grant);
+    LTE_PROFILE_COUNT("LtePhyVUeMode4", "candidateCSRs", optimalCSRs.size());
+
+    // Send the packet up to the MAC layer where it will choose the CSR and the retransmission if that is specified
+    // Need to generate the message that is to be sent to the upper layers.
+    SpsCandidateResources* candidateResourcesMessage = new SpsCandidateResources("CSRs");
+    candidateResourcesMessage->setCSRs(optimalCSRs);
+    send(candidateResourcesMessage, upperGateOut_);
+}
+
+std::vector<std::tuple<double, int, int, bool>> LtePhyVUeMode4::selectCSRs(LteMode4SchedulingGrant* &grant) {
     EV << NOW << " LtePhyVUeMode4::computeCSRs - going through sensing window to compute CSRS..." << endl;
     // Determine the total number of possible CSRs
     if (grant->getMaximumLatency() >= 100) {
@@ -1094,11 +1161,7 @@ void LtePhyVUeMode4::computeCSRs(LteMode4SchedulingGrant* &grant) {
         optimalCSRs = orderedCSRs;
     }
 
-    // Send the packet up to the MAC layer where it will choose the CSR and the retransmission if that is specified
-    // Need to generate the message that is to be sent to the upper layers.
-    SpsCandidateResources* candidateResourcesMessage = new SpsCandidateResources("CSRs");
-    candidateResourcesMessage->setCSRs(optimalCSRs);
-    send(candidateResourcesMessage, upperGateOut_);
+    return optimalCSRs;
 }
 
 std::vector<std::tuple<double, int, int, bool>> LtePhyVUeMode4::selectBestRSSIs(std::unordered_map<int, std::set<int>> possibleCSRs,
@@ -1125,7 +1188,7 @@ std::vector<std::tuple<double, int, int, bool>> LtePhyVUeMode4::selectBestRSSIs(
 
     unsigned int grantLength = grant->getNumSubchannels();
 
-    EV_FATAL <<"grantLength : "<<grantLength<<endl;
+    LTE_EV_DIAG <<"grantLength : "<<grantLength<<endl;
 
     // This will be avgRSSI -> (subframeIndex, subchannelIndex)
     std::vector<std::tuple<double, int, int, bool>> orderedCSRs;
@@ -1215,7 +1278,7 @@ std::vector<std::tuple<double, int, int, bool>> LtePhyVUeMode4::selectBestRSRPs(
     EV << NOW << " LtePhyVUeMode4::selectBestRSSIs - Selecting best CSRs from possible CSRs(selectBestRSRPs)..." << endl;
     int decrease = pStep_;
     if(grant == nullptr){
-        EV_FATAL <<"null grant"<<endl;
+        LTE_EV_DIAG <<"null grant"<<endl;
     }
     if (grant->getPeriod() < 100)
     {
@@ -1443,26 +1506,104 @@ LteAirFrame* LtePhyVUeMode4::prepareAirFrame(cMessage* msg, UserControlInfo* lte
     return frame;
 }
 
+void LtePhyVUeMode4::recordMissingTb()
+{
+    if (aggregateStats_)
+    {
+        statAggregator_.collect(tbNotReceived, 1);
+        return;
+    }
+
+    emit(txRxDistanceTB, -1);
+    emit(tbReceived, -1);
+    emit(tbDecoded, -1);
+    emit(tbFailedDueToNoSCI, -1);
+    emit(tbFailedDueToProp, -1);
+    emit(tbFailedDueToInterference, -1);
+    emit(tbFailedButSCIReceived, -1);
+    emit(tbFailedHalfDuplex, -1);
+    emit(periodic, -1);
+
+    emit(tbFailedDueToPropIgnoreSCI ,-1);
+    emit(tbFailedDueToInterferenceIgnoreSCI ,-1);
+    emit(tbDecodedIgnoreSCI ,-1);
+}
+
 void LtePhyVUeMode4::storeAirFrame(LteAirFrame* newFrame)
+{
+    LTE_PROFILE_SCOPE("LtePhyVUeMode4", "storeAirFrame");
+    LteReceptionEngine::Delivery delivery;
+    delivery.receiver = this;
+    delivery.frame = newFrame;
+    delivery.rxCoord = getCoord();
+    delivery.arrival = NOW;
+
+    computeReception(delivery);
+    commitReception(delivery);
+}
+
+void LtePhyVUeMode4::computeReception(LteReceptionEngine::Delivery& delivery)
+{
+    LteAirFrame* newFrame = delivery.frame;
+    UserControlInfo* newInfo = check_and_cast<UserControlInfo*>(newFrame->getControlInfo());
+
+    std::tuple<std::vector<double>, double> rsrpAttenuation = channelModel_->getRSRP_D2D(newFrame, newInfo, nodeId_, delivery.rxCoord);
+    delivery.rsrpVector = get<0>(rsrpAttenuation);
+    delivery.attenuation = get<1>(rsrpAttenuation);
+
+    // Seems we don't really actually need the enbId, I have set it to 0 as it is referenced but never used for calc
+    std::tuple<std::vector<double>, std::vector<double>> rssiSinrVectors = channelModel_->getRSSI_SINR(newFrame, newInfo, nodeId_, delivery.rxCoord, 0, delivery.rsrpVector);
+
+    delivery.rssiVector = get<0>(rssiSinrVectors);
+    delivery.sinrVector = get<1>(rssiSinrVectors);
+}
+
+void LtePhyVUeMode4::commitReception(LteReceptionEngine::Delivery& delivery)
 {
     // implements the capture effect
     // store the frame received from the nearest transmitter
+    LteAirFrame* newFrame = delivery.frame;
     UserControlInfo* newInfo = check_and_cast<UserControlInfo*>(newFrame->getControlInfo());
-    Coord myCoord = getCoord();
 
-    std::tuple<std::vector<double>, double> rsrpAttenuation = channelModel_->getRSRP_D2D(newFrame, newInfo, nodeId_, myCoord);
-    std::vector<double> rsrpVector = get<0>(rsrpAttenuation);
-    double attenuation = get<1>(rsrpAttenuation);
+    std::vector<double>& rsrpVector = delivery.rsrpVector;
+    std::vector<double>& rssiVector = delivery.rssiVector;
+    std::vector<double>& sinrVector = delivery.sinrVector;
+    double attenuation = delivery.attenuation;
 
-    // Seems we don't really actually need the enbId, I have set it to 0 as it is referenced but never used for calc
-    std::tuple<std::vector<double>, std::vector<double>> rssiSinrVectors = channelModel_->getRSSI_SINR(newFrame, newInfo, nodeId_, myCoord, 0, rsrpVector);
+    RbMap grantedBlocks = newInfo->getGrantedBlocks();
+    double avgSinr = averageSinr(grantedBlocks, sinrVector);
+
+    if (newFrame->hasSciPart())
+    {
+        // Merged SCI+TB frame: the PSCCH part shares the RSRP, fading and
+        // interference computed above, it only differs by its RBs. It is
+        // queued as a frame of its own so that decoding stays SCI-then-TB.
+        cPacket* sci = newFrame->removeSciPart();
+        UserControlInfo* sciInfo = check_and_cast<UserControlInfo*>(sci->removeControlInfo());
+
+        LteAirFrame* sciFrame = new LteAirFrame("airframe");
+        sciFrame->encapsulate(sci);
+        sciFrame->setTimestamp(newFrame->getTimestamp());
+        sciFrame->setControlInfo(sciInfo);
+
+        RbMap sciBlocks = sciInfo->getGrantedBlocks();
+        double sciAvgSinr = averageSinr(sciBlocks, sinrVector);
+
+        sciInfo_.push_back(std::make_tuple(sciFrame, rsrpVector, rssiVector, sinrVector, attenuation, sciAvgSinr));
+    }
 
-    std::vector<double> rssiVector = get<0>(rssiSinrVectors);
-    std::vector<double> sinrVector = get<1>(rssiSinrVectors);
+    // Need to be able to figure out which subchannel is associated to the Rbs in this case
+    if (newInfo->getFrameType() == SCIPKT){
+        sciInfo_.push_back(std::make_tuple(newFrame, rsrpVector, rssiVector, sinrVector, attenuation, avgSinr));
+    }  else{
+        tbInfo_.push_back(std::make_tuple(newFrame, rsrpVector, rssiVector, sinrVector, attenuation, avgSinr));
+    }
+}
 
+double LtePhyVUeMode4::averageSinr(RbMap& grantedBlocks, std::vector<double>& sinrVector)
+{
     int countAssignedRbs = 0;
     double avgSinr = 0.0;
-    RbMap grantedBlocks = newInfo->getGrantedBlocks();
 
     RbMap::iterator it;
     std::map<Band, unsigned int>::iterator jt;
@@ -1478,18 +1619,12 @@ void LtePhyVUeMode4::storeAirFrame(LteAirFrame* newFrame)
         }
     }
 
-    avgSinr = avgSinr / countAssignedRbs;
-
-    // Need to be able to figure out which subchannel is associated to the Rbs in this case
-    if (newInfo->getFrameType() == SCIPKT){
-        sciInfo_.push_back(std::make_tuple(newFrame, rsrpVector, rssiVector, sinrVector, attenuation, avgSinr));
-    }  else{
-        tbInfo_.push_back(std::make_tuple(newFrame, rsrpVector, rssiVector, sinrVector, attenuation, avgSinr));
-    }
+    return avgSinr / countAssignedRbs;
 }
 
 void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo, std::vector<double> &rsrpVector, std::vector<double> &rssiVector, std::vector<double> &sinrVector, double &attenuation)
 {
+    LTE_PROFILE_SCOPE("LtePhyVUeMode4", "decodeAirFrame");
     EV << NOW << " LtePhyVUeMode4::decodeAirFrame - Start decoding..." << endl;
 
     // apply decider to received packet
@@ -1501,7 +1636,7 @@ void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo
     if(lteInfo->getFrameType() == SCIPKT)
     {
         double pkt_dist = getCoord().distance(lteInfo->getCoord());
-        emit(txRxDistanceSCI, pkt_dist);
+        recordStat(txRxDistanceSCI, pkt_dist);
 
         SidelinkControlInformation *sci = check_and_cast<SidelinkControlInformation *>(pkt);
         std::tuple<int, int> indexAndLength = decodeRivValue(sci, lteInfo);
@@ -1510,7 +1645,7 @@ void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo
 
         subchannelReceived_ = subchannelIndex;
         subchannelsUsed_ = lengthInSubchannels;
-        emit(senderID, lteInfo->getSourceId());
+        recordStat(senderID, lteInfo->getSourceId());
 
         if (!transmitting_)
         {
@@ -1598,7 +1733,7 @@ void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo
     else
     {
         double pkt_dist = getCoord().distance(lteInfo->getCoord());
-        emit(txRxDistanceTB, pkt_dist);
+        recordStat(txRxDistanceTB, pkt_dist);
 
         simtime_t phyDelay = NOW - frame->getTimestamp();
         simtime_t ipg = SIMTIME_ZERO;
@@ -1655,7 +1790,7 @@ void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo
                 }
             }
             if (!foundCorrespondingSci || !sciDecodedSuccessfully) {
-                EV_FATAL << "CRITICAL TEST: tbFailedDueToNoSCI_"<<endl;
+                LTE_EV_DIAG << "CRITICAL TEST: tbFailedDueToNoSCI_"<<endl;
                 tbFailedDueToNoSCI_ += 1;
                 if (!prop_result) {
                     tbFailedDueToPropIgnoreSCI_ += 1;
@@ -1684,7 +1819,7 @@ void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo
                 if ( jt != previousTransmissionTimes_.end() ) {
                     simtime_t elapsed_time = NOW - jt->second;
                     ipg = elapsed_time;
-                    emit(interPacketDelay, elapsed_time);
+                    recordStat(interPacketDelay, elapsed_time.dbl());
                 }
 
 
@@ -1757,6 +1892,9 @@ void LtePhyVUeMode4::decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo
             tbFailedHalfDuplex_ += 1;
         }
 
+        if (aggregateStats_ && !transmitting_)
+            statAggregator_.collectReception(pkt_dist, fullDecode);
+
         delete frame;
 
         // AKID-CODE-BUG-FIX: Changed from interference_result to fullDecode. The HARQ layer
@@ -1973,9 +2111,13 @@ std::vector<MacNodeId> LtePhyVUeMode4::getNeighbours()
 
 void LtePhyVUeMode4::updateSubframe()
 {
-    // Ensure for every 1ms we record the position of the vehicle
-    emit(posX, getCoord().x);
-    emit(posY, getCoord().y);
+    // Record the position of the vehicle every positionSampling_ subframes (1: every 1ms)
+    if (positionSampling_ > 0 && --positionCountDown_ <= 0)
+    {
+        emit(posX, getCoord().x);
+        emit(posY, getCoord().y);
+        positionCountDown_ = positionSampling_;
+    }
 
     int sensingWindowLength = pStep_ * 10;
     if (sensingWindowSizeOverride_ > 0){
@@ -2008,9 +2150,7 @@ void LtePhyVUeMode4::updateSubframe()
         }
     }
 
-    cMessage* updateSubframe = new cMessage("updateSubframe");
-    updateSubframe->setSchedulingPriority(0);        // Generate the subframe at start of next TTI
-    scheduleAt(NOW + TTI, updateSubframe);
+    scheduleAt(NOW + TTI, updateSubframeTimer_);
 }
 
 void LtePhyVUeMode4::initialiseSensingWindow()
@@ -2060,9 +2200,9 @@ void LtePhyVUeMode4::initialiseSensingWindow()
         subframeTime += TTI;
     }
     // Send self message to trigger another subframes creation and insertion. Need one for every TTI
-    cMessage* updateSubframe = new cMessage("updateSubframe");
-    updateSubframe->setSchedulingPriority(0);        // Generate the subframe at start of next TTI
-    scheduleAt(NOW + TTI, updateSubframe);
+    updateSubframeTimer_ = new cMessage("updateSubframe");
+    updateSubframeTimer_->setSchedulingPriority(0);        // Generate the subframe at start of next TTI
+    scheduleAt(NOW + TTI, updateSubframeTimer_);
 }
 
 int LtePhyVUeMode4::translateIndex(int fallBack) {
@@ -2078,6 +2218,14 @@ int LtePhyVUeMode4::translateIndex(int fallBack) {
     }
 }
 
+void LtePhyVUeMode4::setD2dTxPower(double power)
+{
+    Enter_Method_Silent();
+
+    // the SCI and the data of the next transmissions carry the new power
+    d2dTxPower_ = power;
+}
+
 void LtePhyVUeMode4::finish()
 {
     if (getSimulation()->getSimulationStage() != CTX_FINISH)
@@ -2099,6 +2247,9 @@ void LtePhyVUeMode4::finish()
         deployer_->detachUser(nodeId_);
     }
 
+    if (aggregateStats_)
+        statAggregator_.finish();
+
     std::vector<std::vector<Subchannel *>>::iterator it;
     for (it=sensingWindow_.begin();it!=sensingWindow_.end();it++)
     {
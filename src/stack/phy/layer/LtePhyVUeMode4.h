@@ -11,13 +11,15 @@
 // email : b.mccarthy@cs.ucc.ie
 
 #include "stack/phy/layer/LtePhyUeD2D.h"
-#include "stack/phy/packet/SidelinkControlInformation_m.h"
+#include "stack/phy/packet/SidelinkControlInformation.h"
 #include "stack/mac/packet/LteSchedulingGrant.h"
 #include "stack/mac/allocator/LteAllocationModule.h"
 #include "stack/phy/layer/Subchannel.h"
+#include "common/LteStatAggregator.h"
+#include "stack/phy/layer/LteReceptionEngine.h"
 #include <unordered_map>
 
-class LtePhyVUeMode4 : public LtePhyUeD2D
+class LtePhyVUeMode4 : public LtePhyUeD2D, public LteReceptionEngine::Receiver
 {
   protected:
 
@@ -25,6 +27,7 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
     double d2dTxPower_;
 
     bool adjacencyPSCCHPSSCH_;
+    bool mergedSciTb_;
     int pStep_;
     int numSubchannels_;
     int subchannelSize_ ;
@@ -47,6 +50,8 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
 
     cMessage* d2dDecodingTimer_; // timer for triggering decoding at the end of the TTI. Started when the first airframe is received
 
+    cMessage* updateSubframeTimer_; // rescheduled every TTI to advance the sensing window
+
     std::vector<std::tuple<LteAirFrame*, std::vector<double>, std::vector<double>, std::vector<double>, double, double>> tbInfo_;
 
     std::vector<std::tuple<LteAirFrame*, std::vector<double>, std::vector<double>, std::vector<double>, double, double>> sciInfo_;
@@ -57,6 +62,14 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
 
     std::vector<cPacket*> scis_;
 
+    // SCI waiting for its TB when SCI and TB share one air frame (mergedSciTb)
+    cPacket* pendingSci_;
+
+    // batched reception of the TTI (NULL: every frame is processed on arrival)
+    LteReceptionEngine* receptionEngine_;
+    // random stream of the channel model when the engine is enabled
+    cRNG* receptionRng_;
+
     // SCI stats
     simsignal_t sciSent;
 
@@ -134,6 +147,17 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
     simsignal_t posX;
     simsignal_t posY;
 
+    // SCIs whose TB was not received, only collected in aggregated mode
+    simsignal_t tbNotReceived;
+
+    // Aggregated recording of the per-TTI statistics (statRecording = "aggregated")
+    bool aggregateStats_;
+    LteStatAggregator statAggregator_;
+
+    // posX/posY are recorded every positionSampling_ subframes
+    int positionSampling_;
+    int positionCountDown_;
+
     int subchannelReceived_;
     int subchannelsUsed_;
 
@@ -145,7 +169,23 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
     std::string deviceName_;   // e.g., "rsu[0]" or "ue[3]"
     std::string logFilePath_;  // e.g., "simulation_logs/rsu[0].csv"
 
+    // Per-TTI statistics go through here: emitted, or folded into the aggregator
+    void recordStat(simsignal_t signal, double value)
+    {
+        if (aggregateStats_)
+            statAggregator_.collect(signal, value);
+        else
+            emit(signal, value);
+    }
+
+    // Records an SCI whose TB never arrived (-1 on every TB statistic when emitting)
+    void recordMissingTb();
+
     void storeAirFrame(LteAirFrame* newFrame);
+    // the two halves of storeAirFrame(), also called by the reception engine
+    virtual void computeReception(LteReceptionEngine::Delivery& delivery);
+    virtual void commitReception(LteReceptionEngine::Delivery& delivery);
+    double averageSinr(RbMap& grantedBlocks, std::vector<double>& sinrVector);
     LteAirFrame* extractAirFrame();
     void decodeAirFrame(LteAirFrame* frame, UserControlInfo* lteInfo, std::vector<double> &rsrpVector, std::vector<double> &rssiVector, std::vector<double> &sinrVector, double &attenuation);
     // ---------------------------------------------------------------- //
@@ -164,9 +204,15 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
 
     virtual RbMap sendSciMessage(cMessage* sci, UserControlInfo* lteInfo);
 
+    // Sends a pending SCI on its own frame, if its TB never came
+    virtual void flushPendingSci();
+
     // Compute Candidate Single Subframe Resources which the MAC layer can use for transmission
     virtual void computeCSRs(LteMode4SchedulingGrant* &grant);
 
+    // Sensing-based selection behind computeCSRs: returns the CSRs to report, without sending them to the MAC
+    virtual std::vector<std::tuple<double, int, int, bool>> selectCSRs(LteMode4SchedulingGrant* &grant);
+
     virtual void computeRandomCSRs(LteMode4SchedulingGrant* &grant);
 
     virtual void updateSubframe();
@@ -199,5 +245,8 @@ class LtePhyVUeMode4 : public LtePhyUeD2D
             return d2dTxPower_;
         return txPower_;
     }
+
+    // Sidelink transmit power (dBm) of the next transmissions, set by the congestion control of the application
+    virtual void setD2dTxPower(double power);
 };
 
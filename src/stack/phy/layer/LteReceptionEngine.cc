@@ -0,0 +1,274 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "stack/phy/layer/LteReceptionEngine.h"
+
+#include <map>
+
+#include "corenetwork/binder/LteBinder.h"
+#include "stack/phy/ChannelModel/LteRealisticChannelModel.h"
+#include "stack/phy/layer/LtePhyBase.h"
+#include "stack/phy/packet/LteAirFrame.h"
+
+using namespace omnetpp;
+
+// set while the thread takes part in a parallel batch
+static thread_local bool parallelBatch = false;
+
+LteReceptionEngine::LteReceptionEngine() :
+    threads_(0),
+    binder_(NULL),
+    batch_(NULL),
+    nextGroup_(0),
+    generation_(0),
+    busyWorkers_(0),
+    stop_(false),
+    batches_(0),
+    parallelBatches_(0),
+    deliveries_(0),
+    maxBatch_(0)
+{
+}
+
+LteReceptionEngine::~LteReceptionEngine()
+{
+    stopWorkers();
+}
+
+LteReceptionEngine* LteReceptionEngine::getInstance()
+{
+    static LteReceptionEngine instance;
+    return &instance;
+}
+
+void LteReceptionEngine::configure(int threads, LteBinder* binder)
+{
+    if (threads < 0)
+        throw cRuntimeError("LteReceptionEngine::configure - the number of threads cannot be negative");
+
+    // leftovers of a previous run in the same process
+    for (unsigned int i = 0; i < pending_.size(); i++)
+        delete pending_[i].frame;
+    pending_.clear();
+    stopWorkers();
+
+    threads_ = threads;
+    binder_ = binder;
+
+    batches_ = 0;
+    parallelBatches_ = 0;
+    deliveries_ = 0;
+    maxBatch_ = 0;
+}
+
+void LteReceptionEngine::deliver(Receiver* receiver, LteAirFrame* frame, const inet::Coord& rxCoord)
+{
+    Delivery delivery;
+    delivery.receiver = receiver;
+    delivery.frame = frame;
+    delivery.rxCoord = rxCoord;
+    delivery.arrival = simTime();
+    delivery.attenuation = 0;
+    pending_.push_back(delivery);
+}
+
+void LteReceptionEngine::cancel(Receiver* receiver)
+{
+    std::vector<Delivery>::iterator it = pending_.begin();
+    while (it != pending_.end())
+    {
+        if (it->receiver == receiver)
+        {
+            delete it->frame;
+            it = pending_.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void LteReceptionEngine::flush()
+{
+    if (pending_.empty())
+        return;
+
+    // the deliveries queued so far are processed; the commits may queue new ones
+    std::vector<Delivery> batch;
+    batch.swap(pending_);
+
+    for (unsigned int i = 0; i < batch.size(); i++)
+    {
+        if (batch[i].arrival != simTime())
+            throw cRuntimeError("LteReceptionEngine::flush - delivery of t=%s still pending at t=%s",
+                batch[i].arrival.str().c_str(), simTime().str().c_str());
+    }
+
+    // the interference computation resolves the channel of every UE on
+    // first use: do it here, the workers only read the UE list
+    std::vector<UeInfo*>* ueList = binder_->getUeList();
+    for (unsigned int i = 0; i < ueList->size(); i++)
+    {
+        UeInfo* info = (*ueList)[i];
+        if (!info->init)
+        {
+            info->realChan = dynamic_cast<LteRealisticChannelModel*>(info->phy->getChannelModel());
+            info->init = true;
+        }
+    }
+
+    // one group per receiver, in order of first delivery
+    std::map<Receiver*, size_t> groupOf;
+    groups_.clear();
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        std::map<Receiver*, size_t>::iterator it = groupOf.find(batch[i].receiver);
+        if (it == groupOf.end())
+        {
+            it = groupOf.insert(std::make_pair(batch[i].receiver, groups_.size())).first;
+            groups_.push_back(std::vector<size_t>());
+        }
+        groups_[it->second].push_back(i);
+    }
+    errors_.assign(groups_.size(), std::exception_ptr());
+
+    batches_++;
+    deliveries_ += batch.size();
+    if (batch.size() > maxBatch_)
+        maxBatch_ = batch.size();
+
+    batch_ = &batch;
+    nextGroup_ = 0;
+
+    bool parallel = threads_ > 1 && groups_.size() > 1 && !getEnvir()->isLoggingEnabled();
+#ifdef LTE_PROFILING
+    // the profiler sections are not thread safe
+    parallel = false;
+#endif
+
+    if (parallel)
+    {
+        if (workers_.empty())
+            startWorkers();
+
+        parallelBatches_++;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation_++;
+            busyWorkers_ = workers_.size();
+        }
+        wake_.notify_all();
+
+        parallelBatch = true;
+        runGroups();
+        parallelBatch = false;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busyWorkers_ == 0; });
+    }
+    else
+        runGroups();
+
+    batch_ = NULL;
+
+    // report the error of the first receiver, whatever thread computed it
+    for (unsigned int g = 0; g < errors_.size(); g++)
+    {
+        if (errors_[g])
+        {
+            for (unsigned int i = 0; i < batch.size(); i++)
+                delete batch[i].frame;
+            std::rethrow_exception(errors_[g]);
+        }
+    }
+
+    for (unsigned int i = 0; i < batch.size(); i++)
+        batch[i].receiver->commitReception(batch[i]);
+}
+
+bool LteReceptionEngine::inParallelBatch()
+{
+    return parallelBatch;
+}
+
+void LteReceptionEngine::runGroups()
+{
+    size_t g;
+    while ((g = nextGroup_++) < groups_.size())
+    {
+        try
+        {
+            const std::vector<size_t>& group = groups_[g];
+            for (unsigned int i = 0; i < group.size(); i++)
+            {
+                Delivery& delivery = (*batch_)[group[i]];
+                delivery.receiver->computeReception(delivery);
+            }
+        }
+        catch (...)
+        {
+            errors_[g] = std::current_exception();
+        }
+    }
+}
+
+void LteReceptionEngine::startWorkers()
+{
+    stop_ = false;
+    // the simulation thread is one of the threads of the batch
+    for (int i = 1; i < threads_; i++)
+        workers_.push_back(std::thread(&LteReceptionEngine::workerLoop, this, generation_));
+}
+
+void LteReceptionEngine::stopWorkers()
+{
+    if (workers_.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (unsigned int i = 0; i < workers_.size(); i++)
+        workers_[i].join();
+    workers_.clear();
+}
+
+void LteReceptionEngine::workerLoop(uint64_t seen)
+{
+    parallelBatch = true;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+            seen = generation_;
+        }
+
+        runGroups();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busyWorkers_--;
+        }
+        done_.notify_one();
+    }
+}
+
+void LteReceptionEngine::recordStatistics(cComponent* owner) const
+{
+    owner->recordScalar("receptionEngine:threads", threads_);
+    owner->recordScalar("receptionEngine:batches", batches_);
+    owner->recordScalar("receptionEngine:parallelBatches", parallelBatches_);
+    owner->recordScalar("receptionEngine:deliveries", deliveries_);
+    owner->recordScalar("receptionEngine:maxBatch", maxBatch_);
+}
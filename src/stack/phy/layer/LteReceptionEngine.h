@@ -0,0 +1,150 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_LTERECEPTIONENGINE_H_
+#define _LTE_LTERECEPTIONENGINE_H_
+
+#include <omnetpp.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "inet/common/geometry/common/Coord.h"
+
+class LteAirFrame;
+class LteBinder;
+
+/**
+ * Batched processing of the sidelink receptions of a TTI.
+ *
+ * Without the engine every receiving PHY computes RSRP, RSSI and SINR of an
+ * air frame as soon as the frame arrives. With the engine the PHY only hands
+ * the frame over with deliver(); the first decoding timer of the TTI calls
+ * flush(), which computes the channel of all the pending deliveries, one task
+ * per receiver, on a pool of threads, then commits the results on the
+ * simulation thread in delivery order.
+ *
+ * The computation of a receiver only touches its own channel model, which
+ * draws from a random stream of its own (see LteStreamRng): the results are
+ * the same for any number of threads, 1 included. They differ from the ones
+ * of the per-arrival processing, since the channel is computed at the end of
+ * the TTI and with other random numbers.
+ *
+ * The batch runs on the simulation thread alone when logging is enabled
+ * (the EV streams are not thread safe) and in builds with LTE_PROFILING.
+ *
+ * There is one engine per process, configured by the binder
+ * ("receptionThreads" parameter, 0 disables it).
+ */
+class LteReceptionEngine
+{
+  public:
+    class Receiver;
+
+    struct Delivery
+    {
+        Receiver* receiver;
+        LteAirFrame* frame;           // with its UserControlInfo attached
+        inet::Coord rxCoord;          // position of the receiver at delivery
+        omnetpp::simtime_t arrival;
+
+        // results of computeReception()
+        std::vector<double> rsrpVector;
+        std::vector<double> rssiVector;
+        std::vector<double> sinrVector;
+        double attenuation;
+    };
+
+    /**
+     * Interface of the PHY layers processed by the engine.
+     */
+    class Receiver
+    {
+      public:
+        virtual ~Receiver() {}
+
+        // Channel computations of a delivery. Called on a worker thread: it
+        // must only modify the delivery and state owned by the receiver
+        virtual void computeReception(Delivery& delivery) = 0;
+
+        // Stores the results, on the simulation thread, in delivery order
+        virtual void commitReception(Delivery& delivery) = 0;
+    };
+
+    static LteReceptionEngine* getInstance();
+
+    /**
+     * (Re)configures the engine at the beginning of a run.
+     *
+     * @param threads size of the batch, the simulation thread included; 0 disables the engine
+     * @param binder the binder of the network, whose UE list is read by the receptions
+     */
+    void configure(int threads, LteBinder* binder);
+
+    bool isEnabled() const { return threads_ > 0; }
+
+    // Queues the reception of a frame; the receiver must have a decoding timer scheduled at NOW
+    void deliver(Receiver* receiver, LteAirFrame* frame, const inet::Coord& rxCoord);
+
+    // Computes and commits all the pending deliveries
+    void flush();
+
+    // Drops the pending deliveries of a receiver being deleted
+    void cancel(Receiver* receiver);
+
+    // Records the batch counters as scalars of the given component
+    void recordStatistics(omnetpp::cComponent* owner) const;
+
+    // True on a thread computing the receptions of a parallel batch: the
+    // channel state of other nodes must not be modified from there
+    static bool inParallelBatch();
+
+  private:
+    int threads_;
+    LteBinder* binder_;
+
+    std::vector<Delivery> pending_;
+
+    // current batch: for each receiver, its deliveries in arrival order
+    std::vector<Delivery>* batch_;
+    std::vector<std::vector<size_t> > groups_;
+    std::vector<std::exception_ptr> errors_;
+    std::atomic<size_t> nextGroup_;
+
+    // workers, started on the first parallel batch
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    uint64_t generation_;
+    unsigned int busyWorkers_;
+    bool stop_;
+
+    uint64_t batches_;
+    uint64_t parallelBatches_;
+    uint64_t deliveries_;
+    uint64_t maxBatch_;
+
+    LteReceptionEngine();
+    ~LteReceptionEngine();
+
+    void startWorkers();
+    void stopWorkers();
+    // seen: the last batch started before the worker
+    void workerLoop(uint64_t seen);
+
+    // computes the groups not taken yet by another thread
+    void runGroups();
+};
+
+#endif
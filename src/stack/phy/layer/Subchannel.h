@@ -11,7 +11,7 @@
 #define SUBCHANNEL_H_
 
 #include "common/LteCommon.h"
-#include "stack/phy/packet/SidelinkControlInformation_m.h"
+#include "stack/phy/packet/SidelinkControlInformation.h"
 
 class Subchannel
 {
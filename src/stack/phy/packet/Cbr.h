@@ -0,0 +1,48 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_CBR_H_
+#define _LTE_CBR_H_
+
+#include "stack/phy/packet/cbr_m.h"
+#include "common/LteObjectPool.h"
+
+/**
+ * Channel busy ratio report, sent by the PHY to the MAC and the application
+ * every 100 ms. Pooled, as every vehicle creates one.
+ */
+class Cbr : public Cbr_Base
+{
+  public:
+    Cbr(const char *name = NULL, short kind = 0) :
+        Cbr_Base(name, kind)
+    {
+    }
+    Cbr(const Cbr& other) :
+        Cbr_Base(other)
+    {
+    }
+    Cbr& operator=(const Cbr& other)
+    {
+        if (this == &other)
+            return *this;
+        Cbr_Base::operator=(other);
+        return *this;
+    }
+    virtual Cbr *dup() const
+    {
+        return new Cbr(*this);
+    }
+
+    LTE_POOLED_OBJECT(Cbr)
+};
+
+Register_Class(Cbr);
+
+#endif
@@ -17,3 +17,20 @@ RemoteUnitPhyDataVector LteAirFrame::getRemoteUnitPhyDataVector()
 {
     return remoteUnitPhyDataVector;
 }
+
+void LteAirFrame::setSciPart(cPacket* sci)
+{
+    if (sciPart_ != NULL)
+        throw cRuntimeError("LteAirFrame::setSciPart - frame %s already carries an SCI", getName());
+    take(sci);
+    sciPart_ = sci;
+}
+
+cPacket* LteAirFrame::removeSciPart()
+{
+    cPacket* sci = sciPart_;
+    if (sci != NULL)
+        drop(sci);
+    sciPart_ = NULL;
+    return sci;
+}
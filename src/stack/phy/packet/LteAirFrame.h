@@ -13,26 +13,52 @@
 #include "common/LteCommon.h"
 #include "stack/phy/packet/LteAirFrame_m.h"
 #include "common/LteControlInfo.h"
+#include "common/LteObjectPool.h"
 
 class LteAirFrame : public LteAirFrame_Base
 {
   protected:
     RemoteUnitPhyDataVector remoteUnitPhyDataVector;
+
+    // PSCCH part of a merged SCI+TB frame, with its own control info attached
+    cPacket* sciPart_;
     public:
     LteAirFrame(const char *name = NULL, int kind = 0) :
-        LteAirFrame_Base(name, kind)
+        LteAirFrame_Base(name, kind),
+        sciPart_(NULL)
     {
     }
     LteAirFrame(const LteAirFrame& other) :
-        LteAirFrame_Base(other)
+        LteAirFrame_Base(other),
+        sciPart_(NULL)
     {
         operator=(other);
     }
+    virtual ~LteAirFrame()
+    {
+        if (sciPart_ != NULL)
+            dropAndDelete(sciPart_);
+    }
     LteAirFrame& operator=(const LteAirFrame& other)
     {
+        if (this == &other)
+            return *this;
+
         LteAirFrame_Base::operator=(other);
         this->remoteUnitPhyDataVector = other.remoteUnitPhyDataVector;
 
+        // copy the SCI part together with its own control info
+        if (sciPart_ != NULL)
+            dropAndDelete(sciPart_);
+        sciPart_ = NULL;
+        if (other.sciPart_ != NULL)
+        {
+            cPacket* sci = other.sciPart_->dup();
+            if (other.sciPart_->getControlInfo() != NULL)
+                sci->setControlInfo(check_and_cast<UserControlInfo*>(other.sciPart_->getControlInfo())->dup());
+            setSciPart(sci);
+        }
+
         // copy the attached control info, if any
         if (other.getControlInfo() != NULL)
         {
@@ -49,6 +75,17 @@ class LteAirFrame : public LteAirFrame_Base
     // ADD CODE HERE to redefine and implement pure virtual functions from LteAirFrame_Base
     void addRemoteUnitPhyDataVector(RemoteUnitPhyData data);
     RemoteUnitPhyDataVector getRemoteUnitPhyDataVector();
+
+    /*
+     * Merged sidelink transmission: the frame encapsulates the TB and carries
+     * the SCI beside it, so that one frame per receiver covers both channels.
+     * The SCI keeps its UserControlInfo (with the PSCCH RBs) attached.
+     */
+    void setSciPart(cPacket* sci);
+    cPacket* removeSciPart();
+    bool hasSciPart() const { return sciPart_ != NULL; }
+
+    LTE_POOLED_OBJECT(LteAirFrame)
 };
 
 Register_Class(LteAirFrame);
@@ -0,0 +1,48 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_SIDELINKCONTROLINFORMATION_H_
+#define _LTE_SIDELINKCONTROLINFORMATION_H_
+
+#include "stack/phy/packet/SidelinkControlInformation_m.h"
+#include "common/LteObjectPool.h"
+
+/**
+ * SCI format 1 carried on the PSCCH. Pooled: one is created per
+ * transmission and copied to every receiver in range.
+ */
+class SidelinkControlInformation : public SidelinkControlInformation_Base
+{
+  public:
+    SidelinkControlInformation(const char *name = NULL, short kind = 0) :
+        SidelinkControlInformation_Base(name, kind)
+    {
+    }
+    SidelinkControlInformation(const SidelinkControlInformation& other) :
+        SidelinkControlInformation_Base(other)
+    {
+    }
+    SidelinkControlInformation& operator=(const SidelinkControlInformation& other)
+    {
+        if (this == &other)
+            return *this;
+        SidelinkControlInformation_Base::operator=(other);
+        return *this;
+    }
+    virtual SidelinkControlInformation *dup() const
+    {
+        return new SidelinkControlInformation(*this);
+    }
+
+    LTE_POOLED_OBJECT(SidelinkControlInformation)
+};
+
+Register_Class(SidelinkControlInformation);
+
+#endif
@@ -177,9 +177,7 @@ inline std::ostream& operator<<(std::ostream& out, const std::vector<T,A>& vec)
     return out;
 }
 
-Register_Class(SidelinkControlInformation)
-
-SidelinkControlInformation::SidelinkControlInformation(const char *name, short kind) : ::omnetpp::cPacket(name,kind)
+SidelinkControlInformation_Base::SidelinkControlInformation_Base(const char *name, short kind) : ::omnetpp::cPacket(name,kind)
 {
     this->priority = 0;
     this->resourceReservationInterval = 0;
@@ -190,16 +188,16 @@ SidelinkControlInformation::SidelinkControlInformation(const char *name, short k
     this->retransmissionIndex = 0;
 }
 
-SidelinkControlInformation::SidelinkControlInformation(const SidelinkControlInformation& other) : ::omnetpp::cPacket(other)
+SidelinkControlInformation_Base::SidelinkControlInformation_Base(const SidelinkControlInformation_Base& other) : ::omnetpp::cPacket(other)
 {
     copy(other);
 }
 
-SidelinkControlInformation::~SidelinkControlInformation()
+SidelinkControlInformation_Base::~SidelinkControlInformation_Base()
 {
 }
 
-SidelinkControlInformation& SidelinkControlInformation::operator=(const SidelinkControlInformation& other)
+SidelinkControlInformation_Base& SidelinkControlInformation_Base::operator=(const SidelinkControlInformation_Base& other)
 {
     if (this==&other) return *this;
     ::omnetpp::cPacket::operator=(other);
@@ -207,7 +205,7 @@ SidelinkControlInformation& SidelinkControlInformation::operator=(const Sidelink
     return *this;
 }
 
-void SidelinkControlInformation::copy(const SidelinkControlInformation& other)
+void SidelinkControlInformation_Base::copy(const SidelinkControlInformation_Base& other)
 {
     this->priority = other.priority;
     this->resourceReservationInterval = other.resourceReservationInterval;
@@ -218,7 +216,7 @@ void SidelinkControlInformation::copy(const SidelinkControlInformation& other)
     this->retransmissionIndex = other.retransmissionIndex;
 }
 
-void SidelinkControlInformation::parsimPack(omnetpp::cCommBuffer *b) const
+void SidelinkControlInformation_Base::parsimPack(omnetpp::cCommBuffer *b) const
 {
     ::omnetpp::cPacket::parsimPack(b);
     doParsimPacking(b,this->priority);
@@ -230,7 +228,7 @@ void SidelinkControlInformation::parsimPack(omnetpp::cCommBuffer *b) const
     doParsimPacking(b,this->retransmissionIndex);
 }
 
-void SidelinkControlInformation::parsimUnpack(omnetpp::cCommBuffer *b)
+void SidelinkControlInformation_Base::parsimUnpack(omnetpp::cCommBuffer *b)
 {
     ::omnetpp::cPacket::parsimUnpack(b);
     doParsimUnpacking(b,this->priority);
@@ -242,72 +240,72 @@ void SidelinkControlInformation::parsimUnpack(omnetpp::cCommBuffer *b)
     doParsimUnpacking(b,this->retransmissionIndex);
 }
 
-unsigned int SidelinkControlInformation::getPriority() const
+unsigned int SidelinkControlInformation_Base::getPriority() const
 {
     return this->priority;
 }
 
-void SidelinkControlInformation::setPriority(unsigned int priority)
+void SidelinkControlInformation_Base::setPriority(unsigned int priority)
 {
     this->priority = priority;
 }
 
-unsigned int SidelinkControlInformation::getResourceReservationInterval() const
+unsigned int SidelinkControlInformation_Base::getResourceReservationInterval() const
 {
     return this->resourceReservationInterval;
 }
 
-void SidelinkControlInformation::setResourceReservationInterval(unsigned int resourceReservationInterval)
+void SidelinkControlInformation_Base::setResourceReservationInterval(unsigned int resourceReservationInterval)
 {
     this->resourceReservationInterval = resourceReservationInterval;
 }
 
-unsigned int SidelinkControlInformation::getFrequencyResourceLocation() const
+unsigned int SidelinkControlInformation_Base::getFrequencyResourceLocation() const
 {
     return this->frequencyResourceLocation;
 }
 
-void SidelinkControlInformation::setFrequencyResourceLocation(unsigned int frequencyResourceLocation)
+void SidelinkControlInformation_Base::setFrequencyResourceLocation(unsigned int frequencyResourceLocation)
 {
     this->frequencyResourceLocation = frequencyResourceLocation;
 }
 
-unsigned int SidelinkControlInformation::getTimeGapRetrans() const
+unsigned int SidelinkControlInformation_Base::getTimeGapRetrans() const
 {
     return this->timeGapRetrans;
 }
 
-void SidelinkControlInformation::setTimeGapRetrans(unsigned int timeGapRetrans)
+void SidelinkControlInformation_Base::setTimeGapRetrans(unsigned int timeGapRetrans)
 {
     this->timeGapRetrans = timeGapRetrans;
 }
 
-unsigned int SidelinkControlInformation::getMcs() const
+unsigned int SidelinkControlInformation_Base::getMcs() const
 {
     return this->mcs;
 }
 
-void SidelinkControlInformation::setMcs(unsigned int mcs)
+void SidelinkControlInformation_Base::setMcs(unsigned int mcs)
 {
     this->mcs = mcs;
 }
 
-unsigned int SidelinkControlInformation::getOneShotLocation() const
+unsigned int SidelinkControlInformation_Base::getOneShotLocation() const
 {
     return this->oneShotLocation;
 }
 
-void SidelinkControlInformation::setOneShotLocation(unsigned int oneShotLocation)
+void SidelinkControlInformation_Base::setOneShotLocation(unsigned int oneShotLocation)
 {
     this->oneShotLocation = oneShotLocation;
 }
 
-unsigned int SidelinkControlInformation::getRetransmissionIndex() const
+unsigned int SidelinkControlInformation_Base::getRetransmissionIndex() const
 {
     return this->retransmissionIndex;
 }
 
-void SidelinkControlInformation::setRetransmissionIndex(unsigned int retransmissionIndex)
+void SidelinkControlInformation_Base::setRetransmissionIndex(unsigned int retransmissionIndex)
 {
     this->retransmissionIndex = retransmissionIndex;
 }
@@ -354,13 +352,13 @@ SidelinkControlInformationDescriptor::~SidelinkControlInformationDescriptor()
 
 bool SidelinkControlInformationDescriptor::doesSupport(omnetpp::cObject *obj) const
 {
-    return dynamic_cast<SidelinkControlInformation *>(obj)!=nullptr;
+    return dynamic_cast<SidelinkControlInformation_Base *>(obj)!=nullptr;
 }
 
 const char **SidelinkControlInformationDescriptor::getPropertyNames() const
 {
     if (!propertynames) {
-        static const char *names[] = {  nullptr };
+        static const char *names[] = { "customize",  nullptr };
         omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
         const char **basenames = basedesc ? basedesc->getPropertyNames() : nullptr;
         propertynames = mergeLists(basenames, names);
@@ -370,6 +368,7 @@ const char **SidelinkControlInformationDescriptor::getPropertyNames() const
 
 const char *SidelinkControlInformationDescriptor::getProperty(const char *propertyname) const
 {
+    if (!strcmp(propertyname,"customize")) return "true";
     omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
     return basedesc ? basedesc->getProperty(propertyname) : nullptr;
 }
@@ -488,7 +487,7 @@ int SidelinkControlInformationDescriptor::getFieldArraySize(void *object, int fi
             return basedesc->getFieldArraySize(object, field);
         field -= basedesc->getFieldCount();
     }
-    SidelinkControlInformation *pp = (SidelinkControlInformation *)object; (void)pp;
+    SidelinkControlInformation_Base *pp = (SidelinkControlInformation_Base *)object; (void)pp;
     switch (field) {
         default: return 0;
     }
@@ -502,7 +501,7 @@ const char *SidelinkControlInformationDescriptor::getFieldDynamicTypeString(void
             return basedesc->getFieldDynamicTypeString(object,field,i);
         field -= basedesc->getFieldCount();
     }
-    SidelinkControlInformation *pp = (SidelinkControlInformation *)object; (void)pp;
+    SidelinkControlInformation_Base *pp = (SidelinkControlInformation_Base *)object; (void)pp;
     switch (field) {
         default: return nullptr;
     }
@@ -516,7 +515,7 @@ std::string SidelinkControlInformationDescriptor::getFieldValueAsString(void *ob
             return basedesc->getFieldValueAsString(object,field,i);
         field -= basedesc->getFieldCount();
     }
-    SidelinkControlInformation *pp = (SidelinkControlInformation *)object; (void)pp;
+    SidelinkControlInformation_Base *pp = (SidelinkControlInformation_Base *)object; (void)pp;
     switch (field) {
         case 0: return ulong2string(pp->getPriority());
         case 1: return ulong2string(pp->getResourceReservationInterval());
@@ -537,7 +536,7 @@ bool SidelinkControlInformationDescriptor::setFieldValueAsString(void *object, i
             return basedesc->setFieldValueAsString(object,field,i,value);
         field -= basedesc->getFieldCount();
     }
-    SidelinkControlInformation *pp = (SidelinkControlInformation *)object; (void)pp;
+    SidelinkControlInformation_Base *pp = (SidelinkControlInformation_Base *)object; (void)pp;
     switch (field) {
         case 0: pp->setPriority(string2ulong(value)); return true;
         case 1: pp->setResourceReservationInterval(string2ulong(value)); return true;
@@ -571,7 +570,7 @@ void *SidelinkControlInformationDescriptor::getFieldStructValuePointer(void *obj
             return basedesc->getFieldStructValuePointer(object, field, i);
         field -= basedesc->getFieldCount();
     }
-    SidelinkControlInformation *pp = (SidelinkControlInformation *)object; (void)pp;
+    SidelinkControlInformation_Base *pp = (SidelinkControlInformation_Base *)object; (void)pp;
     switch (field) {
         default: return nullptr;
     }
@@ -26,6 +26,7 @@
  * //
  * packet SidelinkControlInformation
  * {
+ *     \@customize(true);
  *     unsigned int priority;
  *     unsigned int resourceReservationInterval;
  *     unsigned int frequencyResourceLocation;
@@ -35,8 +36,32 @@
  *     unsigned int retransmissionIndex;
  * }
  * </pre>
+ *
+ * SidelinkControlInformation_Base is only useful if it gets subclassed, and SidelinkControlInformation is derived from it.
+ * The minimum code to be written for SidelinkControlInformation is the following:
+ *
+ * <pre>
+ * class SidelinkControlInformation : public SidelinkControlInformation_Base
+ * {
+ *   private:
+ *     void copy(const SidelinkControlInformation& other) { ... }
+
+ *   public:
+ *     SidelinkControlInformation(const char *name=nullptr, short kind=0) : SidelinkControlInformation_Base(name,kind) {}
+ *     SidelinkControlInformation(const SidelinkControlInformation& other) : SidelinkControlInformation_Base(other) {copy(other);}
+ *     SidelinkControlInformation& operator=(const SidelinkControlInformation& other) {if (this==&other) return *this; SidelinkControlInformation_Base::operator=(other); copy(other); return *this;}
+ *     virtual SidelinkControlInformation *dup() const override {return new SidelinkControlInformation(*this);}
+ *     // ADD CODE HERE to redefine and implement pure virtual functions from SidelinkControlInformation_Base
+ * };
+ * </pre>
+ *
+ * The following should go into a .cc (.cpp) file:
+ *
+ * <pre>
+ * Register_Class(SidelinkControlInformation)
+ * </pre>
  */
-class SidelinkControlInformation : public ::omnetpp::cPacket
+class SidelinkControlInformation_Base : public ::omnetpp::cPacket
 {
   protected:
     unsigned int priority;
@@ -48,18 +73,20 @@ class SidelinkControlInformation : public ::omnetpp::cPacket
     unsigned int retransmissionIndex;
 
   private:
-    void copy(const SidelinkControlInformation& other);
+    void copy(const SidelinkControlInformation_Base& other);
 
   protected:
     // protected and unimplemented operator==(), to prevent accidental usage
-    bool operator==(const SidelinkControlInformation&);
+    bool operator==(const SidelinkControlInformation_Base&);
+    // make constructors protected to avoid instantiation
+    SidelinkControlInformation_Base(const char *name=nullptr, short kind=0);
+    SidelinkControlInformation_Base(const SidelinkControlInformation_Base& other);
+    // make assignment operator protected to force the user override it
+    SidelinkControlInformation_Base& operator=(const SidelinkControlInformation_Base& other);
 
   public:
-    SidelinkControlInformation(const char *name=nullptr, short kind=0);
-    SidelinkControlInformation(const SidelinkControlInformation& other);
-    virtual ~SidelinkControlInformation();
-    SidelinkControlInformation& operator=(const SidelinkControlInformation& other);
-    virtual SidelinkControlInformation *dup() const override {return new SidelinkControlInformation(*this);}
+    virtual ~SidelinkControlInformation_Base();
+    virtual SidelinkControlInformation_Base *dup() const override {throw omnetpp::cRuntimeError("You forgot to manually add a dup() function to class SidelinkControlInformation");}
     virtual void parsimPack(omnetpp::cCommBuffer *b) const override;
     virtual void parsimUnpack(omnetpp::cCommBuffer *b) override;
 
@@ -80,8 +107,6 @@ class SidelinkControlInformation : public ::omnetpp::cPacket
     virtual void setRetransmissionIndex(unsigned int retransmissionIndex);
 };
 
-inline void doParsimPacking(omnetpp::cCommBuffer *b, const SidelinkControlInformation& obj) {obj.parsimPack(b);}
-inline void doParsimUnpacking(omnetpp::cCommBuffer *b, SidelinkControlInformation& obj) {obj.parsimUnpack(b);}
 
 
 #endif // ifndef __SIDELINKCONTROLINFORMATION_M_H
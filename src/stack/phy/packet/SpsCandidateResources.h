@@ -19,6 +19,7 @@
 #include "stack/mac/packet/LteSchedulingGrant.h"
 #include "common/LteCommon.h"
 #include "stack/phy/layer/Subchannel.h"
+#include "common/LteObjectPool.h"
 
 class SpsCandidateResources: public SpsCandidateResources_Base
 {
@@ -63,4 +64,6 @@ class SpsCandidateResources: public SpsCandidateResources_Base
     {
         return CSRs;
     }
+
+    LTE_POOLED_OBJECT(SpsCandidateResources)
 };
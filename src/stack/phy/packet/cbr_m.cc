@@ -177,23 +177,21 @@ inline std::ostream& operator<<(std::ostream& out, const std::vector<T,A>& vec)
     return out;
 }
 
-Register_Class(Cbr)
-
-Cbr::Cbr(const char *name, short kind) : ::omnetpp::cPacket(name,kind)
+Cbr_Base::Cbr_Base(const char *name, short kind) : ::omnetpp::cPacket(name,kind)
 {
     this->cbr = 0;
 }
 
-Cbr::Cbr(const Cbr& other) : ::omnetpp::cPacket(other)
+Cbr_Base::Cbr_Base(const Cbr_Base& other) : ::omnetpp::cPacket(other)
 {
     copy(other);
 }
 
-Cbr::~Cbr()
+Cbr_Base::~Cbr_Base()
 {
 }
 
-Cbr& Cbr::operator=(const Cbr& other)
+Cbr_Base& Cbr_Base::operator=(const Cbr_Base& other)
 {
     if (this==&other) return *this;
     ::omnetpp::cPacket::operator=(other);
@@ -201,29 +199,29 @@ Cbr& Cbr::operator=(const Cbr& other)
     return *this;
 }
 
-void Cbr::copy(const Cbr& other)
+void Cbr_Base::copy(const Cbr_Base& other)
 {
     this->cbr = other.cbr;
 }
 
-void Cbr::parsimPack(omnetpp::cCommBuffer *b) const
+void Cbr_Base::parsimPack(omnetpp::cCommBuffer *b) const
 {
     ::omnetpp::cPacket::parsimPack(b);
     doParsimPacking(b,this->cbr);
 }
 
-void Cbr::parsimUnpack(omnetpp::cCommBuffer *b)
+void Cbr_Base::parsimUnpack(omnetpp::cCommBuffer *b)
 {
     ::omnetpp::cPacket::parsimUnpack(b);
     doParsimUnpacking(b,this->cbr);
 }
 
-double Cbr::getCbr() const
+double Cbr_Base::getCbr() const
 {
     return this->cbr;
 }
 
-void Cbr::setCbr(double cbr)
+void Cbr_Base::setCbr(double cbr)
 {
     this->cbr = cbr;
 }
@@ -270,13 +268,13 @@ CbrDescriptor::~CbrDescriptor()
 
 bool CbrDescriptor::doesSupport(omnetpp::cObject *obj) const
 {
-    return dynamic_cast<Cbr *>(obj)!=nullptr;
+    return dynamic_cast<Cbr_Base *>(obj)!=nullptr;
 }
 
 const char **CbrDescriptor::getPropertyNames() const
 {
     if (!propertynames) {
-        static const char *names[] = {  nullptr };
+        static const char *names[] = { "customize",  nullptr };
         omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
         const char **basenames = basedesc ? basedesc->getPropertyNames() : nullptr;
         propertynames = mergeLists(basenames, names);
@@ -286,6 +284,7 @@ const char **CbrDescriptor::getPropertyNames() const
 
 const char *CbrDescriptor::getProperty(const char *propertyname) const
 {
+    if (!strcmp(propertyname,"customize")) return "true";
     omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
     return basedesc ? basedesc->getProperty(propertyname) : nullptr;
 }
@@ -380,7 +379,7 @@ int CbrDescriptor::getFieldArraySize(void *object, int field) const
             return basedesc->getFieldArraySize(object, field);
         field -= basedesc->getFieldCount();
     }
-    Cbr *pp = (Cbr *)object; (void)pp;
+    Cbr_Base *pp = (Cbr_Base *)object; (void)pp;
     switch (field) {
         default: return 0;
     }
@@ -394,7 +393,7 @@ const char *CbrDescriptor::getFieldDynamicTypeString(void *object, int field, in
             return basedesc->getFieldDynamicTypeString(object,field,i);
         field -= basedesc->getFieldCount();
     }
-    Cbr *pp = (Cbr *)object; (void)pp;
+    Cbr_Base *pp = (Cbr_Base *)object; (void)pp;
     switch (field) {
         default: return nullptr;
     }
@@ -408,7 +407,7 @@ std::string CbrDescriptor::getFieldValueAsString(void *object, int field, int i)
             return basedesc->getFieldValueAsString(object,field,i);
         field -= basedesc->getFieldCount();
     }
-    Cbr *pp = (Cbr *)object; (void)pp;
+    Cbr_Base *pp = (Cbr_Base *)object; (void)pp;
     switch (field) {
         case 0: return double2string(pp->getCbr());
         default: return "";
@@ -423,7 +422,7 @@ bool CbrDescriptor::setFieldValueAsString(void *object, int field, int i, const
             return basedesc->setFieldValueAsString(object,field,i,value);
         field -= basedesc->getFieldCount();
     }
-    Cbr *pp = (Cbr *)object; (void)pp;
+    Cbr_Base *pp = (Cbr_Base *)object; (void)pp;
     switch (field) {
         case 0: pp->setCbr(string2double(value)); return true;
         default: return false;
@@ -451,7 +450,7 @@ void *CbrDescriptor::getFieldStructValuePointer(void *object, int field, int i)
             return basedesc->getFieldStructValuePointer(object, field, i);
         field -= basedesc->getFieldCount();
     }
-    Cbr *pp = (Cbr *)object; (void)pp;
+    Cbr_Base *pp = (Cbr_Base *)object; (void)pp;
     switch (field) {
         default: return nullptr;
     }
@@ -26,28 +26,55 @@
  * //
  * packet Cbr
  * {
+ *     \@customize(true);
  *     double cbr;
  * }
  * </pre>
+ *
+ * Cbr_Base is only useful if it gets subclassed, and Cbr is derived from it.
+ * The minimum code to be written for Cbr is the following:
+ *
+ * <pre>
+ * class Cbr : public Cbr_Base
+ * {
+ *   private:
+ *     void copy(const Cbr& other) { ... }
+
+ *   public:
+ *     Cbr(const char *name=nullptr, short kind=0) : Cbr_Base(name,kind) {}
+ *     Cbr(const Cbr& other) : Cbr_Base(other) {copy(other);}
+ *     Cbr& operator=(const Cbr& other) {if (this==&other) return *this; Cbr_Base::operator=(other); copy(other); return *this;}
+ *     virtual Cbr *dup() const override {return new Cbr(*this);}
+ *     // ADD CODE HERE to redefine and implement pure virtual functions from Cbr_Base
+ * };
+ * </pre>
+ *
+ * The following should go into a .cc (.cpp) file:
+ *
+ * <pre>
+ * Register_Class(Cbr)
+ * </pre>
  */
-class Cbr : public ::omnetpp::cPacket
+class Cbr_Base : public ::omnetpp::cPacket
 {
   protected:
     double cbr;
 
   private:
-    void copy(const Cbr& other);
+    void copy(const Cbr_Base& other);
 
   protected:
     // protected and unimplemented operator==(), to prevent accidental usage
-    bool operator==(const Cbr&);
+    bool operator==(const Cbr_Base&);
+    // make constructors protected to avoid instantiation
+    Cbr_Base(const char *name=nullptr, short kind=0);
+    Cbr_Base(const Cbr_Base& other);
+    // make assignment operator protected to force the user override it
+    Cbr_Base& operator=(const Cbr_Base& other);
 
   public:
-    Cbr(const char *name=nullptr, short kind=0);
-    Cbr(const Cbr& other);
-    virtual ~Cbr();
-    Cbr& operator=(const Cbr& other);
-    virtual Cbr *dup() const override {return new Cbr(*this);}
+    virtual ~Cbr_Base();
+    virtual Cbr_Base *dup() const override {throw omnetpp::cRuntimeError("You forgot to manually add a dup() function to class Cbr");}
     virtual void parsimPack(omnetpp::cCommBuffer *b) const override;
     virtual void parsimUnpack(omnetpp::cCommBuffer *b) override;
 
@@ -56,8 +83,6 @@ class Cbr : public ::omnetpp::cPacket
     virtual void setCbr(double cbr);
 };
 
-inline void doParsimPacking(omnetpp::cCommBuffer *b, const Cbr& obj) {obj.parsimPack(b);}
-inline void doParsimUnpacking(omnetpp::cCommBuffer *b, Cbr& obj) {obj.parsimUnpack(b);}
 
 
 #endif // ifndef __CBR_M_H
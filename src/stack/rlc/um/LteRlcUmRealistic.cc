@@ -12,6 +12,26 @@
 
 Define_Module(LteRlcUmRealistic);
 
+LteRlcUmRealistic::LteRlcUmRealistic()
+{
+    fastPath_ = false;
+    pooledRx_ = false;
+    rxIdleTimer_ = NULL;
+    rxContextReady_ = false;
+    rxEnginesHighWater_ = 0;
+    rxEnginesReclaimed_ = 0;
+}
+
+LteRlcUmRealistic::~LteRlcUmRealistic()
+{
+    for (UmRxEngines::iterator it = rxEngines_.begin(); it != rxEngines_.end(); ++it)
+        delete it->second;
+    for (unsigned int i = 0; i < rxEnginePool_.size(); i++)
+        delete rxEnginePool_[i];
+
+    cancelAndDelete(rxIdleTimer_);
+}
+
 UmTxEntity* LteRlcUmRealistic::getTxBuffer(LteControlInfo* lteInfo)
 {
     MacNodeId nodeId = ctrlInfoToUeId(lteInfo);
@@ -96,6 +116,89 @@ UmRxEntity* LteRlcUmRealistic::getRxBuffer(LteControlInfo* lteInfo)
     }
 }
 
+UmRxEngine* LteRlcUmRealistic::getRxEngine(LteControlInfo* lteInfo)
+{
+    MacNodeId nodeId;
+    if (lteInfo->getDirection() == DL)
+        nodeId = lteInfo->getDestId();
+    else
+        nodeId = lteInfo->getSourceId();
+    LogicalCid lcid = lteInfo->getLcid();
+
+    // Find the engine for this CID
+    MacCid cid = idToMacCid(nodeId, lcid);
+    UmRxEngines::iterator it = rxEngines_.find(cid);
+    if (it != rxEngines_.end())
+        return it->second;
+
+    if (!rxContextReady_)
+    {
+        rxContext_.init(this, par("rxTimeout").doubleValue(), par("rxWindowSize"));
+        rxContextReady_ = true;
+    }
+
+    // Not found: take one from the pool
+    UmRxEngine* rxEngine;
+    if (rxEnginePool_.empty())
+    {
+        rxEngine = new UmRxEngine(&rxContext_, this);
+    }
+    else
+    {
+        rxEngine = rxEnginePool_.back();
+        rxEnginePool_.pop_back();
+    }
+
+    std::unordered_map<MacCid, UmRxEngine::History>::iterator hit = rxHistory_.find(cid);
+    if (hit != rxHistory_.end())
+    {
+        rxEngine->bind(cid, lteInfo->dup(), &hit->second);
+        rxHistory_.erase(hit);
+    }
+    else
+    {
+        rxEngine->bind(cid, lteInfo->dup(), NULL);
+    }
+    rxEngines_[cid] = rxEngine;
+    if (rxEngines_.size() > rxEnginesHighWater_)
+        rxEnginesHighWater_ = rxEngines_.size();
+
+    EV << "LteRlcUmRealistic : Bound UmRxEngine for node: " << nodeId << " for Lcid: " << lcid << "\n";
+
+    return rxEngine;
+}
+
+void LteRlcUmRealistic::reclaimIdleRxEngines()
+{
+    for (UmRxEngines::iterator it = rxEngines_.begin(); it != rxEngines_.end(); )
+    {
+        UmRxEngine* rxEngine = it->second;
+        if (NOW - rxEngine->getLastActivity() >= rxIdleTimeout_ && rxEngine->isIdle())
+        {
+            // a partially reassembled SDU, if any, is dropped
+            rxHistory_[it->first] = rxEngine->release();
+            rxEnginePool_.push_back(rxEngine);
+            it = rxEngines_.erase(it);
+            rxEnginesReclaimed_++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // a flow silent for longer than rxHistoryTimeout is heard again as a new one
+    if (rxHistoryTimeout_ <= SIMTIME_ZERO)
+        return;
+    for (std::unordered_map<MacCid, UmRxEngine::History>::iterator hit = rxHistory_.begin(); hit != rxHistory_.end(); )
+    {
+        if (NOW - hit->second.lastActivity >= rxHistoryTimeout_)
+            hit = rxHistory_.erase(hit);
+        else
+            ++hit;
+    }
+}
+
 void LteRlcUmRealistic::handleUpperMessage(cPacket *pkt)
 {
 
@@ -126,10 +229,18 @@ void LteRlcUmRealistic::handleUpperMessage(cPacket *pkt)
 
     // create a message so as to notify the MAC layer that the queue contains new data
     LteRlcPdu* newDataPkt = new LteRlcPdu("newDataPkt");
-    // make a copy of the RLC SDU
-    LteRlcSdu* rlcPktDup = rlcPkt->dup();
-    // the MAC will only be interested in the size of this packet
-    newDataPkt->encapsulate(rlcPktDup);
+    if (fastPath_)
+    {
+        // the MAC will only be interested in the size of this packet, no need for a copy of the SDU
+        newDataPkt->setByteLength(rlcPkt->getByteLength());
+    }
+    else
+    {
+        // make a copy of the RLC SDU
+        LteRlcSdu* rlcPktDup = rlcPkt->dup();
+        // the MAC will only be interested in the size of this packet
+        newDataPkt->encapsulate(rlcPktDup);
+    }
     newDataPkt->setControlInfo(lteInfo->dup());
 
     EV << "LteRlcUmRealistic::handleUpperMessage - Sending message " << newDataPkt->getName() << " to port UM_Sap_down$o\n";
@@ -165,6 +276,14 @@ void LteRlcUmRealistic::handleLowerMessage(cPacket *pkt)
 
         delete macSduRequest;
     }
+    else if (pooledRx_)
+    {
+        UmRxEngine* rxEngine = getRxEngine(lteInfo);
+
+        // Bufferize PDU, it stays owned by this module
+        EV << "LteRlcUmRealistic::handleLowerMessage - Enque packet " << pkt->getName() << " into the Rx engine\n";
+        rxEngine->enque(pkt);
+    }
     else
     {
         // Extract informations from fragment
@@ -215,6 +334,26 @@ void LteRlcUmRealistic::deleteQueues(MacNodeId nodeId)
             ++rit;
         }
     }
+    for (UmRxEngines::iterator eit = rxEngines_.begin(); eit != rxEngines_.end(); )
+    {
+        if (nodeType == UE || (nodeType == ENODEB && MacCidToNodeId(eit->first) == nodeId))
+        {
+            eit->second->release();
+            rxEnginePool_.push_back(eit->second);
+            eit = rxEngines_.erase(eit);
+        }
+        else
+        {
+            ++eit;
+        }
+    }
+    for (std::unordered_map<MacCid, UmRxEngine::History>::iterator hit = rxHistory_.begin(); hit != rxHistory_.end(); )
+    {
+        if (nodeType == UE || (nodeType == ENODEB && MacCidToNodeId(hit->first) == nodeId))
+            hit = rxHistory_.erase(hit);
+        else
+            ++hit;
+    }
 }
 
 /*
@@ -245,4 +384,53 @@ void LteRlcUmRealistic::initialize()
 
     WATCH_MAP(txEntities_);
     WATCH_MAP(rxEntities_);
+
+    fastPath_ = par("fastPath");
+    initRxEntities();
+}
+
+void LteRlcUmRealistic::initRxEntities()
+{
+    std::string rxEntityType = par("rxEntityType").stdstringValue();
+    if (rxEntityType == "pooled")
+        pooledRx_ = true;
+    else if (rxEntityType == "module")
+        pooledRx_ = false;
+    else
+        throw cRuntimeError("LteRlcUmRealistic::initRxEntities - unknown rxEntityType '%s' (module|pooled)", rxEntityType.c_str());
+
+    rxIdleTimeout_ = par("rxIdleTimeout");
+    rxHistoryTimeout_ = par("rxHistoryTimeout");
+    if (pooledRx_ && rxIdleTimeout_ > 0)
+    {
+        rxIdleTimer_ = new cMessage("rxIdleTimer");
+        scheduleAt(NOW + rxIdleTimeout_, rxIdleTimer_);
+    }
+
+    WATCH(pooledRx_);
+    WATCH(rxEnginesHighWater_);
+    WATCH(rxEnginesReclaimed_);
+}
+
+void LteRlcUmRealistic::handleMessage(cMessage* msg)
+{
+    if (!msg->isSelfMessage())
+    {
+        LteRlcUm::handleMessage(msg);
+        return;
+    }
+
+    if (msg == rxIdleTimer_)
+    {
+        reclaimIdleRxEngines();
+        scheduleAt(NOW + rxIdleTimeout_, rxIdleTimer_);
+        return;
+    }
+
+    // t-reordering of a pooled entity, the timer id is the CID of the flow
+    TTimerMsg* timer = check_and_cast<TTimerMsg*>(msg);
+    UmRxEngines::iterator it = rxEngines_.find(timer->getTimerId());
+    if (it == rxEngines_.end())
+        throw cRuntimeError("LteRlcUmRealistic::handleMessage - no UmRxEngine for timer of CID %u", timer->getTimerId());
+    it->second->handleTimer(msg);
 }
@@ -11,9 +11,11 @@
 #define _LTE_LTERLCUMREALISTIC_H_
 
 #include <omnetpp.h>
+#include <unordered_map>
 #include "stack/rlc/um/LteRlcUm.h"
 #include "stack/rlc/um/entity/UmTxEntity.h"
 #include "stack/rlc/um/entity/UmRxEntity.h"
+#include "stack/rlc/um/entity/UmRxEngine.h"
 #include "stack/rlc/packet/LteRlcDataPdu.h"
 #include "stack/mac/layer/LteMacBase.h"
 
@@ -44,12 +46,8 @@ class UmRxEntity;
 class LteRlcUmRealistic : public LteRlcUm
 {
   public:
-    LteRlcUmRealistic()
-    {
-    }
-    virtual ~LteRlcUmRealistic()
-    {
-    }
+    LteRlcUmRealistic();
+    virtual ~LteRlcUmRealistic();
 
     /**
      * deleteQueues() must be called on handover
@@ -66,6 +64,17 @@ class LteRlcUmRealistic : public LteRlcUm
      */
     virtual void initialize();
 
+    /**
+     * Reads the receive entity type and sets up the pooled entities
+     */
+    void initRxEntities();
+
+    /**
+     * Handles the timers of the pooled receive entities,
+     * everything else goes to LteRlcUm::handleMessage()
+     */
+    virtual void handleMessage(cMessage *msg);
+
     virtual void finish()
     {
     }
@@ -94,6 +103,24 @@ class LteRlcUmRealistic : public LteRlcUm
      */
     UmRxEntity* getRxBuffer(LteControlInfo* lteInfo);
 
+    /**
+     * getRxEngine() is the counterpart of getRxBuffer() for pooled
+     * receive entities: the engine of the CID is taken from the pool
+     * (or created) the first time the flow is heard, and bound to the
+     * flow state left by a previous engine, if any.
+     *
+     * @param lteInfo flow-related info
+     * @return pointer to the receive engine for that CID
+     */
+    UmRxEngine* getRxEngine(LteControlInfo* lteInfo);
+
+    /**
+     * Returns to the pool the engines of the flows idle for
+     * more than rxIdleTimeout, keeping their per-flow counters
+     * until the flow has been idle for rxHistoryTimeout
+     */
+    void reclaimIdleRxEngines();
+
     /**
      * handler for traffic coming
      * from the upper layer (PDCP)
@@ -140,6 +167,29 @@ class LteRlcUmRealistic : public LteRlcUm
     typedef std::map<MacCid, UmRxEntity*> UmRxEntities;
     UmTxEntities txEntities_;
     UmRxEntities rxEntities_;
+
+    // single-SDU transmit fast path (parameter fastPath)
+    bool fastPath_;
+
+    /*
+     * Pooled receive entities (rxEntityType = "pooled")
+     */
+    bool pooledRx_;
+    simtime_t rxIdleTimeout_;
+    simtime_t rxHistoryTimeout_;
+    cMessage* rxIdleTimer_;
+
+    // signals and parameters shared by all the engines, set up with the first one
+    UmRxEngine::Context rxContext_;
+    bool rxContextReady_;
+
+    typedef std::unordered_map<MacCid, UmRxEngine*> UmRxEngines;
+    UmRxEngines rxEngines_;
+    std::vector<UmRxEngine*> rxEnginePool_;
+    std::unordered_map<MacCid, UmRxEngine::History> rxHistory_;
+
+    unsigned int rxEnginesHighWater_;
+    unsigned int rxEnginesReclaimed_;
 };
 
 #endif
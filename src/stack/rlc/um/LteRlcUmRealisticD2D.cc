@@ -40,8 +40,16 @@ void LteRlcUmRealisticD2D::handleLowerMessage(cPacket *pkt)
         else  // rx side
         {
             // get the corresponding Rx buffer & call handler
-            UmRxEntity* rxbuf = getRxBuffer(lteInfo);
-            rxbuf->rlcHandleD2DModeSwitch(switchPkt->getOldConnection(), switchPkt->getOldMode());
+            if (pooledRx_)
+            {
+                UmRxEngine* rxEngine = getRxEngine(lteInfo);
+                rxEngine->rlcHandleD2DModeSwitch(switchPkt->getOldConnection(), switchPkt->getOldMode());
+            }
+            else
+            {
+                UmRxEntity* rxbuf = getRxBuffer(lteInfo);
+                rxbuf->rlcHandleD2DModeSwitch(switchPkt->getOldConnection(), switchPkt->getOldMode());
+            }
 
             delete switchPkt;
         }
@@ -94,5 +102,8 @@ void LteRlcUmRealisticD2D::initialize(int stage)
 
         WATCH_MAP(txEntities_);
         WATCH_MAP(rxEntities_);
+
+        fastPath_ = par("fastPath");
+        initRxEntities();
     }
 }
@@ -0,0 +1,829 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "stack/rlc/um/entity/UmRxEngine.h"
+#include "stack/mac/layer/LteMacBase.h"
+#include "stack/rlc/um/LteRlcUm.h"
+#include "stack/rlc/packet/LteRlcDataPdu.h"
+
+unsigned int UmRxEngine::totalCellRcvdBytes_ = 0;
+
+void UmRxEngine::Context::init(LteRlcUm* rlc, double reorderingTimeout, unsigned int rxWindowSize)
+{
+    host = rlc;
+    timeout = reorderingTimeout;
+    windowSize = rxWindowSize;
+
+    LteMacBase* mac = check_and_cast<LteMacBase*>(rlc->getParentModule()->getParentModule()->getSubmodule("mac"));
+    nodeB = getRlcByMacNodeId(mac->getMacCellId(), UM);
+    ownerNodeId = mac->getMacNodeId();
+
+    if (mac->getNodeType() == ENODEB)
+    {
+        rlcCellPacketLoss = rlc->registerSignal("rlcCellPacketLossUl");
+        rlcPacketLoss = rlc->registerSignal("rlcPacketLossUl");
+        rlcPduPacketLoss = rlc->registerSignal("rlcPduPacketLossUl");
+        rlcDelay = rlc->registerSignal("rlcDelayUl");
+        rlcThroughput = rlc->registerSignal("rlcThroughputUl");
+        rlcPduDelay = rlc->registerSignal("rlcPduDelayUl");
+        rlcPduThroughput = rlc->registerSignal("rlcPduThroughputUl");
+        rlcCellThroughput = rlc->registerSignal("rlcCellThroughputUl");
+    }
+    else // UE
+    {
+        rlcPacketLoss = rlc->registerSignal("rlcPacketLossDl");
+        rlcPduPacketLoss = rlc->registerSignal("rlcPduPacketLossDl");
+        rlcDelay = rlc->registerSignal("rlcDelayDl");
+        rlcThroughput = rlc->registerSignal("rlcThroughputDl");
+        rlcPduDelay = rlc->registerSignal("rlcPduDelayDl");
+        rlcPduThroughput = rlc->registerSignal("rlcPduThroughputDl");
+
+        rlcCellThroughput = rlc->registerSignal("rlcCellThroughputDl");
+        rlcCellPacketLoss = rlc->registerSignal("rlcCellPacketLossDl");
+    }
+
+    rlcPacketLossD2D = rlc->registerSignal("rlcPacketLossD2D");
+    rlcPduPacketLossD2D = rlc->registerSignal("rlcPduPacketLossD2D");
+    rlcDelayD2D = rlc->registerSignal("rlcDelayD2D");
+    rlcThroughputD2D = rlc->registerSignal("rlcThroughputD2D");
+    rlcPduDelayD2D = rlc->registerSignal("rlcPduDelayD2D");
+    rlcPduThroughputD2D = rlc->registerSignal("rlcPduThroughputD2D");
+
+    rlcPacketLossTotal = rlc->registerSignal("rlcPacketLossTotal");
+}
+
+UmRxEngine::UmRxEngine(const Context* context, cSimpleModule* timerHost) :
+    ctx_(context),
+    cid_(0),
+    lteControlInfo_(NULL),
+    numBufferedPdus_(0),
+    t_reordering_(timerHost),
+    buffered_(NULL)
+{
+    rxWindowDesc_.windowSize_ = ctx_->windowSize;
+    pduBuffer_.resize(ctx_->windowSize, NULL);
+    received_.resize(ctx_->windowSize, false);
+    release();
+}
+
+UmRxEngine::~UmRxEngine()
+{
+    clearBuffer();
+    delete lteControlInfo_;
+}
+
+void UmRxEngine::bind(MacCid cid, LteControlInfo* lteInfo, const History* history)
+{
+    cid_ = cid;
+    t_reordering_.setTimerId(cid);
+    lteControlInfo_ = lteInfo;
+    lastActivity_ = NOW;
+
+    if (history != NULL)
+    {
+        rxWindowDesc_ = history->rxWindowDesc;
+        lastSnoDelivered_ = history->lastSnoDelivered;
+        lastPduReassembled_ = history->lastPduReassembled;
+        totalPduRcvdBytes_ = history->totalPduRcvdBytes;
+        totalRcvdBytes_ = history->totalRcvdBytes;
+        init_ = history->init;
+    }
+}
+
+UmRxEngine::History UmRxEngine::release()
+{
+    History history;
+    history.rxWindowDesc = rxWindowDesc_;
+    history.lastSnoDelivered = lastSnoDelivered_;
+    history.lastPduReassembled = lastPduReassembled_;
+    history.totalPduRcvdBytes = totalPduRcvdBytes_;
+    history.totalRcvdBytes = totalRcvdBytes_;
+    history.init = init_;
+    history.lastActivity = lastActivity_;
+
+    clearBuffer();
+    if (t_reordering_.busy())
+        t_reordering_.stop();
+
+    delete lteControlInfo_;
+    lteControlInfo_ = NULL;
+
+    // back to the state of a newly created entity
+    rxWindowDesc_.clear();
+    rxWindowDesc_.windowSize_ = ctx_->windowSize;
+    lastSnoDelivered_ = 0;
+    lastPduReassembled_ = 0;
+    totalPduRcvdBytes_ = 0;
+    totalRcvdBytes_ = 0;
+    init_ = false;
+    resetFlag_ = false;
+
+    return history;
+}
+
+bool UmRxEngine::isIdle()
+{
+    return numBufferedPdus_ == 0 && !t_reordering_.busy();
+}
+
+void UmRxEngine::clearBuffer()
+{
+    for (unsigned int i = 0; i < pduBuffer_.size(); i++)
+    {
+        delete pduBuffer_[i];
+        pduBuffer_[i] = NULL;
+        received_[i] = false;
+    }
+    numBufferedPdus_ = 0;
+
+    delete buffered_;
+    buffered_ = NULL;
+}
+
+cModule* UmRxEngine::statModule(LteControlInfo* lteInfo) const
+{
+    MacNodeId ueId;
+    if (lteInfo->getDirection() == DL || lteInfo->getDirection() == D2D || lteInfo->getDirection() == D2D_MULTI)   // This module is at a UE
+        ueId = ctx_->ownerNodeId;
+    else  // UL. This module is at the eNB: get the node id of the sender
+        ueId = lteInfo->getSourceId();
+
+    return getRlcByMacNodeId(ueId, UM);
+}
+
+void UmRxEngine::enque(cPacket* pkt)
+{
+    EV << NOW << " UmRxEngine::enque - buffering new PDU" << endl;
+
+    LteRlcUmDataPdu* pdu = check_and_cast<LteRlcUmDataPdu*>(pkt);
+    LteControlInfo* lteInfo = check_and_cast<LteControlInfo*>(pdu->getControlInfo());
+    lastActivity_ = NOW;
+
+    // Get the RLC PDU Transmission sequence number (x)
+    unsigned int tsn = pdu->getPduSequenceNumber();
+
+    if (!init_ && lteInfo->getDirection() == D2D_MULTI)
+    {
+        // for D2D multicast connections, the first received PDU must be considered as the first valid PDU
+        rxWindowDesc_.clear(tsn);
+        // setting the window size to 1 lets the entity to deliver immediately out-of-sequence SDU,
+        // since reordering is not applicable for D2D multicast communications
+        rxWindowDesc_.windowSize_ = 1;
+        init_ = true;
+    }
+
+    // get the position in the buffer
+    int index = tsn - rxWindowDesc_.firstSno_;
+
+    EV << NOW << " UmRxEngine::enque - tsn " << tsn << ", the corresponding index in the buffer is " << index << endl;
+
+    // x was already received
+    if (tsn >= rxWindowDesc_.firstSnoForReordering_ && tsn < rxWindowDesc_.highestReceivedSno_ && received_.at(index) == true)
+    {
+        EV << NOW << " UmRxEngine::enque the received PDU has index " << index << " which points to an already busy location. Discard the PDU" << endl;
+        delete pdu;
+        return;
+    }
+
+    // x was already considered for reordering & reassembling
+    if (tsn < rxWindowDesc_.firstSnoForReordering_)
+    {
+        EV << NOW << " UmRxEngine::enque the received PDU with " << tsn << " SN was already considered for reordering. Discard the PDU" << endl;
+        delete pdu;
+        return;
+    }
+
+    // x falls outside the rxWindow
+    if (tsn >= rxWindowDesc_.highestReceivedSno_)
+    {
+        // move forward the rxWindow and try to reassemble
+
+        unsigned int old = rxWindowDesc_.highestReceivedSno_;
+        rxWindowDesc_.highestReceivedSno_ = tsn+1;
+        if (rxWindowDesc_.firstSno_ + rxWindowDesc_.windowSize_ < rxWindowDesc_.highestReceivedSno_)
+        {
+            int shift = rxWindowDesc_.highestReceivedSno_ - old;
+            while (shift > 0)
+            {
+                // if "shift" is greater than the window size, we advance the window in several steps
+
+                int p = (shift < rxWindowDesc_.windowSize_) ? shift : rxWindowDesc_.windowSize_;
+                shift -= p;
+                if (rxWindowDesc_.firstSno_ + p > tsn)  // HACK to avoid that the window go ahead of the received tsn
+                {
+                    p = tsn-rxWindowDesc_.firstSno_;
+                }
+
+                for (int i=0; i < p; i++)
+                {
+                    // try to reassemble the PDU
+                    reassemble(i);
+                }
+
+                // move the window (update buffer and firstSno)
+                moveRxWindow(p);
+            }
+
+            // check whether firstSnoForReordering_ falls out the window
+            if (rxWindowDesc_.firstSnoForReordering_ < rxWindowDesc_.firstSno_)
+            {
+                rxWindowDesc_.firstSnoForReordering_ = rxWindowDesc_.firstSno_;
+            }
+        }
+    }
+
+    // buffer the received PDU at the correct position in the buffer
+    // get the position in the buffer (the buffer may has been shifted)
+    index = tsn - rxWindowDesc_.firstSno_;
+    if (pduBuffer_.at(index) != NULL)
+        throw cRuntimeError("UmRxEngine::enque(): position %d already used", index);
+    pduBuffer_[index] = pdu;
+    received_.at(index) = true;
+    numBufferedPdus_++;
+
+    // emit statistics
+    totalPduRcvdBytes_ += pdu->getByteLength();
+    double tputSample = (double)totalPduRcvdBytes_ / (NOW - getSimulation()->getWarmupPeriod());
+    cModule* ue = statModule(lteInfo);
+    if (lteInfo->getDirection() != D2D && lteInfo->getDirection() != D2D_MULTI)  // UE in IM
+    {
+        ue->emit(ctx_->rlcPduThroughput, tputSample);
+        ue->emit(ctx_->rlcPduDelay, (NOW - pdu->getCreationTime()).dbl());
+    }
+    else // UE in DM
+    {
+        ue->emit(ctx_->rlcPduThroughputD2D, tputSample);
+        ue->emit(ctx_->rlcPduDelayD2D, (NOW - pdu->getCreationTime()).dbl());
+    }
+
+    EV << NOW << " UmRxEngine::enque - tsn " << tsn << ", the corresponding index after shift in the buffer is " << index << endl;
+    EV << NOW << " UmRxEngine::enque - firstSnoReordering " << rxWindowDesc_.firstSnoForReordering_ << endl;
+
+    if (received_.at(rxWindowDesc_.firstSnoForReordering_-rxWindowDesc_.firstSno_) == true)
+    {
+        unsigned int old = rxWindowDesc_.firstSnoForReordering_;
+
+        // move to the first missing SN
+        while (received_.at(rxWindowDesc_.firstSnoForReordering_-rxWindowDesc_.firstSno_) == true)
+        {
+            rxWindowDesc_.firstSnoForReordering_++;
+            if (rxWindowDesc_.firstSnoForReordering_ == rxWindowDesc_.highestReceivedSno_) // end of the window
+                break;
+        }
+
+        int index = old - rxWindowDesc_.firstSno_;
+        for (unsigned int i = index; i < rxWindowDesc_.firstSnoForReordering_ - rxWindowDesc_.firstSno_; i++)
+        {
+            // try to reassemble
+            reassemble(i);
+        }
+    }
+
+    // handle t-reordering
+
+    // if t_reordering is running
+    if (t_reordering_.busy())
+    {
+        if (rxWindowDesc_.reorderingSno_ <= rxWindowDesc_.firstSnoForReordering_ ||
+                rxWindowDesc_.reorderingSno_ < rxWindowDesc_.firstSno_ || rxWindowDesc_.reorderingSno_ > rxWindowDesc_.highestReceivedSno_ )
+        {
+            t_reordering_.stop();
+        }
+    }
+    // if t_reordering is not running
+    if (!t_reordering_.busy())
+    {
+        if (rxWindowDesc_.highestReceivedSno_ > rxWindowDesc_.firstSnoForReordering_)
+        {
+            t_reordering_.start(ctx_->timeout);
+            rxWindowDesc_.reorderingSno_ = rxWindowDesc_.highestReceivedSno_;
+        }
+    }
+}
+
+void UmRxEngine::moveRxWindow(const int pos)
+{
+    EV << NOW << " UmRxEngine::moveRxWindow moving forth of " << pos << " locations" << endl;
+
+    if (pos <= 0)
+        return;  // ignore the shift , it is uneffective.
+
+    if (pos>rxWindowDesc_.windowSize_)
+        throw cRuntimeError("UmRxEngine::moveRxWindow(): positions %d win size %d ",pos,rxWindowDesc_.windowSize_);
+
+    for (unsigned int i = pos; i < rxWindowDesc_.windowSize_; ++i)
+    {
+        pduBuffer_.at(i-pos) = pduBuffer_.at(i);
+        pduBuffer_.at(i) = NULL;
+        received_.at(i-pos) = received_.at(i);
+        received_.at(i) = false;
+    }
+
+    rxWindowDesc_.firstSno_ += pos;
+
+    EV << NOW << " UmRxEngine::moveRxWindow first sequence number updated to " << rxWindowDesc_.firstSno_ << endl;
+}
+
+void UmRxEngine::toPdcp(LteRlcSdu* rlcSdu)
+{
+    // the SDU is deleted by the caller: its control info moves to the PDCP PDU
+    LteControlInfo* lteInfo = check_and_cast<LteControlInfo*>(rlcSdu->removeControlInfo());
+    unsigned int sno = rlcSdu->getSnoMainPacket();
+    unsigned int length = rlcSdu->getByteLength();
+    simtime_t ts = rlcSdu->getCreationTime();
+
+    // create a PDCP PDU and send it to the upper layer
+    LtePdcpPdu* pdcpPdu = check_and_cast<LtePdcpPdu*>(rlcSdu->decapsulate());
+    pdcpPdu->setControlInfo(lteInfo);
+
+    // emit statistics
+    cModule* ue = statModule(lteInfo);
+    cModule* nodeB = ctx_->nodeB;
+    // check whether some PDCP PDUs have not been delivered
+    while (sno > lastSnoDelivered_+1)
+    {
+        // emit statistic: packet loss
+        if (lteInfo->getDirection() != D2D && lteInfo->getDirection() != D2D_MULTI)
+            ue->emit(ctx_->rlcPacketLoss, 1.0);
+        else
+            ue->emit(ctx_->rlcPacketLossD2D, 1.0);
+        ue->emit(ctx_->rlcPacketLossTotal, 1.0);
+        if (nodeB != nullptr)
+        {
+            nodeB->emit(ctx_->rlcCellPacketLoss, 1.0);
+        }
+        lastSnoDelivered_++;
+    }
+    // update the last sno delivered to the current sno
+    lastSnoDelivered_ = sno;
+
+    // emit statistic: throughput
+    totalCellRcvdBytes_ += length;
+    totalRcvdBytes_ += length;
+    double cellTputSample = (double)totalCellRcvdBytes_ / (NOW - getSimulation()->getWarmupPeriod());
+    double tputSample = (double)totalRcvdBytes_ / (NOW - getSimulation()->getWarmupPeriod());
+
+    if (nodeB != nullptr)
+    {
+        nodeB->emit(ctx_->rlcCellThroughput, cellTputSample);
+    }
+    if (lteInfo->getDirection() != D2D && lteInfo->getDirection() != D2D_MULTI)  // UE in IM
+    {
+        ue->emit(ctx_->rlcThroughput, tputSample);
+    }
+    else
+    {
+        ue->emit(ctx_->rlcThroughputD2D, tputSample);
+    }
+
+    // emit statistic: packet loss
+    if (nodeB != nullptr)
+    {
+        nodeB->emit(ctx_->rlcCellPacketLoss, 0.0);
+    }
+    if (lteInfo->getDirection() != D2D && lteInfo->getDirection() != D2D_MULTI)  // UE in IM
+    {
+        ue->emit(ctx_->rlcPacketLoss, 0.0);
+        ue->emit(ctx_->rlcPacketLossTotal, 0.0);
+        // emit statistic: delay
+        ue->emit(ctx_->rlcDelay, (NOW - ts).dbl());
+    }
+    else
+    {
+        ue->emit(ctx_->rlcPacketLossD2D, 0.0);
+        ue->emit(ctx_->rlcPacketLossTotal, 0.0);
+        // emit statistic: delay
+        ue->emit(ctx_->rlcDelayD2D, (NOW - ts).dbl());
+    }
+
+    EV << NOW << " UmRxEngine::toPdcp Created PDCP PDU with length " <<  pdcpPdu->getByteLength() << " bytes" << endl;
+    EV << NOW << " UmRxEngine::toPdcp Send packet to upper layer" << endl;
+
+    ctx_->host->sendDefragmented(pdcpPdu);
+}
+
+void UmRxEngine::reassemble(unsigned int index)
+{
+    if (received_.at(index) == false)
+    {
+        // consider the case when a PDU is missing or already delivered
+        EV << NOW << " UmRxEngine::reassemble PDU at index " << index << " has not been received or already delivered" << endl;
+        return;
+    }
+    EV << NOW << " UmRxEngine::reassemble Consider PDU at index " << index << " for reassembly" << endl;
+
+    LteRlcUmDataPdu* pdu = pduBuffer_.at(index);
+    LteControlInfo* lteInfo = check_and_cast<LteControlInfo*>(pdu->removeControlInfo());
+
+    // get PDU seq number
+    unsigned int pduSno = pdu->getPduSequenceNumber();
+
+    if (resetFlag_)
+    {
+        // by doing this, the arrived PDU will be considered in order. For example, when D2D is enabled,
+        // this helps to retrieve the synchronization between SNs at the tx and rx after a mode switch
+        lastPduReassembled_ = pduSno-1;
+    }
+
+    // get framing info
+    FramingInfo fi = pdu->getFramingInfo();
+
+    // get the number of (portions of) SDUs in the PDU
+    unsigned int numSdu = pdu->getNumSdu();
+
+    // for each SDU
+    for (unsigned int i=0; i<numSdu; i++)
+    {
+        LteRlcSdu* rlcSdu = check_and_cast<LteRlcSdu*>(pdu->popSdu());
+        unsigned int sduSno = rlcSdu->getSnoMainPacket();
+        unsigned int sduWholeLength = rlcSdu->getLengthMainPacket(); // the length of the whole sdu
+        unsigned int sduLength = rlcSdu->getByteLength();
+
+        if (i==0) // first SDU
+        {
+            if (resetFlag_)
+            {
+                // by doing this, the first extracted SDU will be considered in order. For example, when D2D is enabled,
+                // this helps to retrieve the synchronization between SNs at the tx and rx after a mode switch
+                lastSnoDelivered_ = sduSno-1;
+                resetFlag_ = false;
+            }
+
+            if (i == numSdu-1) // there is only one SDU iOT_n this PDU
+            {
+                // read the FI field
+                switch(fi)
+                {
+                    case 0: {  // FI=00
+                        EV << NOW << " UmRxEngine::reassemble The PDU includes one whole SDU [sno=" << sduSno << "]" << endl;
+                        if (sduLength != sduWholeLength)
+                            throw cRuntimeError("UmRxEngine::reassemble(): failed reassembly, the reassembled SDU has size %d B, while the original SDU had size %d B",sduLength,sduWholeLength);
+
+                        toPdcp(rlcSdu);
+
+                        if (buffered_ != NULL)
+                        {
+                            delete buffered_;
+                            buffered_ = NULL;
+                        }
+
+                        break;
+                    }
+                    case 1: {  // FI=01
+                        EV << NOW << " UmRxEngine::reassemble The PDU includes the first part [" << sduLength <<" B] of a SDU [sno=" << sduSno << "]" << endl;
+
+                        if (buffered_ != NULL)
+                        {
+                            delete buffered_;
+                            buffered_ = NULL;
+                        }
+
+                        // buffer the SDU and wait for the missing portion
+                        buffered_ = rlcSdu->dup();
+
+                        EV << NOW << " UmRxEngine::reassemble Wait for the missing part..." << endl;
+
+                        break;
+                    }
+                    case 2: {  // FI=10
+                        // it is the last portion of a SDU, take the awaiting SDU
+                        EV << NOW << " UmRxEngine::reassemble The PDU includes the last part [" << sduLength <<" B] of a SDU [sno=" << sduSno << "]" << endl;
+
+                        // check SDU SN
+                        if (buffered_ == NULL || (rlcSdu->getSnoMainPacket() != buffered_->getSnoMainPacket()))
+                        {
+                            if (buffered_ != NULL)
+                            {
+                                delete buffered_;
+                                buffered_ = NULL;
+                            }
+
+                            EV << NOW << " UmRxEngine::reassemble The SDU cannot be reassembled, first part missing" << endl;
+
+                            delete rlcSdu;
+
+                            continue;
+                        }
+
+                        EV << NOW << " UmRxEngine::reassemble The waiting SDU has size " <<  buffered_->getByteLength() << " bytes" << endl;
+
+                        unsigned int reassembledLength = buffered_->getByteLength() + rlcSdu->getByteLength();
+                        if (reassembledLength < sduWholeLength)
+                        {
+                            if (buffered_ != NULL)
+                            {
+                                delete buffered_;
+                                buffered_ = NULL;
+                            }
+
+                            EV << NOW << " UmRxEngine::reassemble The SDU cannot be reassembled, mid part missing" << endl;
+
+                            delete rlcSdu;
+
+                            continue;
+                        }
+                        else if (reassembledLength > sduWholeLength)
+                        {
+                            throw cRuntimeError("UmRxEngine::reassemble(): failed reassembly, the reassembled SDU has size %d B, while the original SDU had size %d B",sduLength,sduWholeLength);
+                        }
+                        rlcSdu->setByteLength(reassembledLength);
+//                        rlcSdu->setByteLength(buffered_->getByteLength() + rlcSdu->getByteLength());
+
+                        toPdcp(rlcSdu);
+
+                        if (buffered_ != NULL)
+                        {
+                            delete buffered_;
+                            buffered_ = NULL;
+                        }
+
+                        break;
+                    }
+                    case 3: {  // FI=11
+                        // add the length of this SDU to the awaiting SDU and wait for the missing portion
+                        EV << NOW << " UmRxEngine::reassemble The PDU includes the mid part [" << sduLength <<" B] of a SDU [sno=" << sduSno << "]" << endl;
+
+                        // check SDU SN
+                        if (buffered_ == NULL || (rlcSdu->getSnoMainPacket() != buffered_->getSnoMainPacket()))
+                        {
+                            if (buffered_ != NULL)
+                            {
+                                delete buffered_;
+                                buffered_ = NULL;
+                            }
+
+                            EV << NOW << " UmRxEngine::reassemble The SDU cannot be reassembled, first part missing" << endl;
+
+                            delete rlcSdu;
+
+                            continue;
+                        }
+
+                        buffered_->setByteLength(buffered_->getByteLength() + rlcSdu->getByteLength());
+
+                        EV << NOW << " UmRxEngine::reassemble The waiting SDU has size " << buffered_->getByteLength() << " bytes, was " <<  buffered_->getByteLength() - sduLength << " bytes" << endl;
+                        EV << NOW << " UmRxEngine::reassemble Wait for the missing part..." << endl;
+
+                        break;
+                    }
+                    default: { throw cRuntimeError("UmRxEngine::reassemble(): FI field was not valid %d ",fi); }
+                }
+            }
+            else
+            {
+                EV << NOW << " UmRxEngine::reassemble Read the first chunk of the PDU" << endl;
+
+                // read the FI field
+                switch(fi)
+                {
+
+                    case 0: case 1: {  // FI=00 or FI=01
+                        // it is a whole SDU, send the sdu to the PDCP
+
+                        EV << NOW << " UmRxEngine::reassemble This is a whole SDU [sno=" << sduSno << "]" << endl;
+                        if (sduLength != sduWholeLength)
+                            throw cRuntimeError("UmRxEngine::reassemble(): failed reassembly, the reassembled SDU has size %d B, while the original SDU had size %d B",sduLength,sduWholeLength);
+
+                        toPdcp(rlcSdu);
+
+                        if (buffered_ != NULL)
+                        {
+                            delete buffered_;
+                            buffered_ = NULL;
+                        }
+
+                        break;
+                    }
+                    case 2: case 3: {  // FI=10 or FI=11
+                        // it is the last portion of a SDU, take the awaiting SDU and send to the PDCP
+                        EV << NOW << " UmRxEngine::reassemble This is the last part [" << sduLength <<" B] of a SDU [sno=" << sduSno << "]" << endl;
+
+                        // check SDU SN
+                        if (buffered_ == NULL || (rlcSdu->getSnoMainPacket() != buffered_->getSnoMainPacket()))
+                        {
+                            if (buffered_ != NULL)
+                            {
+                                delete buffered_;
+                                buffered_ = NULL;
+                            }
+
+                            EV << NOW << " UmRxEngine::reassemble The SDU cannot be reassembled, first part missing" << endl;
+
+                            delete rlcSdu;
+
+                            continue;
+                        }
+
+                        EV << NOW << " UmRxEngine::reassemble The waiting SDU has size " <<  buffered_->getByteLength() << " bytes" << endl;
+
+                        unsigned int reassembledLength = buffered_->getByteLength() + rlcSdu->getByteLength();
+                        if (reassembledLength < sduWholeLength)
+                        {
+                            if (buffered_ != NULL)
+                            {
+                                delete buffered_;
+                                buffered_ = NULL;
+                            }
+
+                            EV << NOW << " UmRxEngine::reassemble The SDU cannot be reassembled, mid part missing" << endl;
+
+                            delete rlcSdu;
+
+                            continue;
+                        }
+                        else if (reassembledLength > sduWholeLength)
+                        {
+                            throw cRuntimeError("UmRxEngine::reassemble(): failed reassembly, the reassembled SDU has size %d B, while the original SDU had size %d B",sduLength,sduWholeLength);
+                        }
+                        rlcSdu->setByteLength(reassembledLength);
+//                        rlcSdu->setByteLength(buffered_->getByteLength() + rlcSdu->getByteLength());
+
+                        toPdcp(rlcSdu);
+
+                        if (buffered_ != NULL)
+                        {
+                            delete buffered_;
+                            buffered_ = NULL;
+                        }
+
+                        break;
+                    }
+                    default: { throw cRuntimeError("UmRxEngine::reassemble(): FI field was not valid %d ",fi); }
+                }
+            }
+        }
+        else if (i == numSdu-1)   // last SDU
+        {
+            // read the FI field
+            switch(fi)
+            {
+                case 0: case 2: {  // FI=00 or FI=10
+                    // it is a whole SDU, send the sdu to the PDCP
+                    EV << NOW << " UmRxEngine::reassemble This is a whole SDU [sno=" << sduSno << "]" << endl;
+                    if (sduLength != sduWholeLength)
+                        throw cRuntimeError("UmRxEngine::reassemble(): failed reassembly, the reassembled SDU has size %d B, while the original SDU had size %d B",sduLength,sduWholeLength);
+
+                    toPdcp(rlcSdu);
+
+                    if (buffered_ != NULL)
+                    {
+                        delete buffered_;
+                        buffered_ = NULL;
+                    }
+
+                    break;
+                }
+                case 1: case 3: {  // FI=01 or FI=11
+                    // it is the first portion of a SDU, bufferize it
+                    EV << NOW << " UmRxEngine::reassemble The PDU includes the first part [" << sduLength <<" B] of a SDU [sno=" << sduSno << "]" << endl;
+
+                    if (buffered_ != NULL)
+                    {
+                        delete buffered_;
+                        buffered_ = NULL;
+                    }
+
+                    buffered_ = rlcSdu->dup();
+
+                    EV << NOW << " UmRxEngine::reassemble Wait for the missing part..." << endl;
+
+                    break;
+                }
+                default: { throw cRuntimeError("UmRxEngine::reassemble(): FI field was not valid %d ",fi); }
+            }
+        }
+        else
+        {
+            // it is a whole SDU, send to the PDCP
+            EV << NOW << " UmRxEngine::reassemble This is a whole SDU [sno=" << sduSno << "]" << endl;
+            if (sduLength != sduWholeLength)
+                throw cRuntimeError("UmRxEngine::reassemble(): failed reassembly, the reassembled SDU has size %d B, while the original SDU had size %d B",sduLength,sduWholeLength);
+
+            toPdcp(rlcSdu);
+
+            if (buffered_ != NULL)
+            {
+                delete buffered_;
+                buffered_ = NULL;
+            }
+        }
+
+        delete rlcSdu;
+
+    }
+    // remove PDU from buffer
+    pduBuffer_.at(index) = NULL;
+    received_.at(index) = false;
+    numBufferedPdus_--;
+    EV << NOW << " UmRxEngine::reassemble Removed PDU from position " << index << endl;
+
+    // emit statistics
+    cModule* ue = statModule(lteInfo);
+    // check whether some PDCP PDUs have not been delivered
+    while (pduSno > lastPduReassembled_+1)
+    {
+        // emit statistic: packet loss
+        if (lteInfo->getDirection() != D2D && lteInfo->getDirection() != D2D_MULTI)  // UE in IM
+        {
+            ue->emit(ctx_->rlcPduPacketLoss, 1.0);
+        }
+        else
+        {
+            ue->emit(ctx_->rlcPduPacketLossD2D, 1.0);
+        }
+
+        lastPduReassembled_++;
+    }
+
+    // update the last sno reassembled to the current sno
+    lastPduReassembled_ = pduSno;
+
+    // emit statistic: packet loss
+    if (lteInfo->getDirection() != D2D && lteInfo->getDirection() != D2D_MULTI)  // UE in IM
+    {
+        ue->emit(ctx_->rlcPduPacketLoss, 0.0);
+    }
+    else
+    {
+        ue->emit(ctx_->rlcPduPacketLossD2D, 0.0);
+    }
+
+    delete lteInfo;
+    delete pdu;
+}
+
+void UmRxEngine::handleTimer(cMessage* msg)
+{
+    t_reordering_.handle();
+
+    EV << NOW << " UmRxEngine::handleTimer : t_reordering timer has expired " << endl;
+
+    unsigned int old = rxWindowDesc_.firstSnoForReordering_;
+
+    // move to the first missing SN
+    while (received_.at(rxWindowDesc_.firstSnoForReordering_-rxWindowDesc_.firstSno_) == true
+             || rxWindowDesc_.firstSnoForReordering_ < rxWindowDesc_.reorderingSno_)
+    {
+        rxWindowDesc_.firstSnoForReordering_++;
+        if (rxWindowDesc_.firstSnoForReordering_ == rxWindowDesc_.highestReceivedSno_) // end of the window
+            break;
+    }
+
+    int index = old - rxWindowDesc_.firstSno_;
+    for (unsigned int i = index; i < rxWindowDesc_.firstSnoForReordering_ - rxWindowDesc_.firstSno_; i++)
+    {
+        // try to reassemble
+        reassemble(i);
+    }
+
+    if (rxWindowDesc_.highestReceivedSno_ > rxWindowDesc_.firstSnoForReordering_)
+    {
+        rxWindowDesc_.reorderingSno_ = rxWindowDesc_.highestReceivedSno_;
+        t_reordering_.start(ctx_->timeout);
+    }
+
+    delete msg;
+}
+
+void UmRxEngine::rlcHandleD2DModeSwitch(bool oldConnection, bool oldMode)
+{
+    if (oldConnection)
+    {
+        if (getNodeTypeById(ctx_->ownerNodeId) == UE && oldMode == IM)
+        {
+            EV << NOW << " UmRxEngine::rlcHandleD2DModeSwitch - nothing to do on DL leg of IM flow" << endl;
+            return;
+        }
+
+        EV << NOW << " UmRxEngine::rlcHandleD2DModeSwitch - clear RX buffer of the RLC entity associated to the old mode" << endl;
+        for (unsigned int i = 0; i < rxWindowDesc_.windowSize_; i++)
+        {
+            // try to reassemble
+            reassemble(i);
+        }
+
+        // clear the buffer
+        clearBuffer();
+
+        // stop the timer
+        if (t_reordering_.busy())
+            t_reordering_.stop();
+    }
+    else
+    {
+        EV << NOW << " UmRxEngine::rlcHandleD2DModeSwitch - handle numbering of the RLC entity associated to the new selected mode" << endl;
+
+        // reset sequence numbering
+        rxWindowDesc_.clear();
+
+        // reset counters
+        lastPduReassembled_ = 0;
+        lastSnoDelivered_ = 0;
+    }
+}
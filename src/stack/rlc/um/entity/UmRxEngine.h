@@ -0,0 +1,180 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_UMRXENGINE_H_
+#define _LTE_UMRXENGINE_H_
+
+#include <omnetpp.h>
+#include "common/timer/TTimer.h"
+#include "common/LteControlInfo.h"
+#include "stack/pdcp_rrc/packet/LtePdcpPdu_m.h"
+#include "stack/rlc/LteRlcDefs.h"
+
+class LteRlcUm;
+class LteRlcSdu;
+class LteRlcUmDataPdu;
+
+/**
+ * @class UmRxEngine
+ * @brief Reordering and reassembly of a UM receive flow
+ *
+ * Implements the procedures described in 3GPP TS 36.322 as a plain
+ * object, so that it can be hosted in two ways:
+ * - by an UmRxEntity module, one per flow, which owns the PDUs and on
+ *   which the t-reordering timer is scheduled;
+ * - by LteRlcUmRealistic itself for pooled entities: PDUs stay owned by
+ *   the UM module, the timer is scheduled on it (with the MacCid as
+ *   timer id) and engines are recycled when a flow goes idle. The
+ *   per-flow counters survive in a History record, so that a flow heard
+ *   again goes on as if its entity had never been released.
+ * Statistics are emitted through the signals the host registered once
+ * in a shared Context.
+ */
+class UmRxEngine
+{
+  public:
+    /**
+     * Per-host data shared by all the engines of a UM module
+     */
+    struct Context
+    {
+        LteRlcUm* host;
+        cModule* nodeB;              // reference to eNB for statistic purpose
+        MacNodeId ownerNodeId;
+
+        double timeout;              // t-reordering
+        unsigned int windowSize;
+
+        simsignal_t rlcCellPacketLoss;
+        simsignal_t rlcPacketLoss;
+        simsignal_t rlcPduPacketLoss;
+        simsignal_t rlcDelay;
+        simsignal_t rlcPduDelay;
+        simsignal_t rlcCellThroughput;
+        simsignal_t rlcThroughput;
+        simsignal_t rlcPduThroughput;
+        simsignal_t rlcPacketLossD2D;
+        simsignal_t rlcPduPacketLossD2D;
+        simsignal_t rlcDelayD2D;
+        simsignal_t rlcPduDelayD2D;
+        simsignal_t rlcThroughputD2D;
+        simsignal_t rlcPduThroughputD2D;
+        simsignal_t rlcPacketLossTotal;
+
+        /** Registers the signals, "rlc" being the UM module the SDUs are delivered to */
+        void init(LteRlcUm* rlc, double reorderingTimeout, unsigned int rxWindowSize);
+    };
+
+    /**
+     * Per-flow state kept across a release of the engine
+     */
+    struct History
+    {
+        RlcUmRxWindowDesc rxWindowDesc;
+        unsigned int lastSnoDelivered;
+        unsigned int lastPduReassembled;
+        unsigned int totalPduRcvdBytes;
+        unsigned int totalRcvdBytes;
+        bool init;
+        simtime_t lastActivity;
+    };
+
+    /**
+     * @param context shared parameters and signals, must outlive the engine
+     * @param timerHost module the t-reordering timer is scheduled on
+     */
+    UmRxEngine(const Context* context, cSimpleModule* timerHost);
+    ~UmRxEngine();
+
+    /**
+     * Prepares a pooled engine for a new flow
+     *
+     * @param cid flow identifier, used as timer id
+     * @param lteInfo control info of the first packet of the flow (ownership taken)
+     * @param history state of a previous engine of the same flow, or NULL
+     */
+    void bind(MacCid cid, LteControlInfo* lteInfo, const History* history);
+
+    /** Drops any buffered PDU/SDU and returns the state to keep for the flow */
+    History release();
+
+    /*
+     * Enqueues a lower layer packet into the PDU buffer
+     * @param pdu the packet to be enqueued
+     */
+    void enque(cPacket* pkt);
+
+    /** t-reordering expiry, msg is the timer message (deleted here) */
+    void handleTimer(cMessage* msg);
+
+    // called when a D2D mode switch is triggered
+    void rlcHandleD2DModeSwitch(bool oldConnection, bool oldMode);
+
+    LteControlInfo* getLteControlInfo() { return lteControlInfo_; }
+    MacCid getCid() const { return cid_; }
+    simtime_t getLastActivity() const { return lastActivity_; }
+
+    /** True when nothing is pending: no PDU in the window, no timer running */
+    bool isIdle();
+
+  private:
+    const Context* ctx_;
+
+    static unsigned int totalCellRcvdBytes_;
+
+    MacCid cid_;
+    LteControlInfo* lteControlInfo_;
+    simtime_t lastActivity_;
+
+    unsigned int totalPduRcvdBytes_;
+    unsigned int totalRcvdBytes_;
+
+    // The PDU enqueue buffer, PDUs are owned by the host module
+    std::vector<LteRlcUmDataPdu*> pduBuffer_;
+    unsigned int numBufferedPdus_;
+
+    // State variables
+    RlcUmRxWindowDesc rxWindowDesc_;
+
+    // Timer to manage reordering of the PDUs
+    TTimer t_reordering_;
+
+    // For each PDU a received status variable is kept.
+    std::vector<bool> received_;
+
+    // The SDU waiting for the missing portion
+    LteRlcSdu* buffered_;
+
+    // Sequence number of the last SDU delivered to the upper layer
+    unsigned int lastSnoDelivered_;
+
+    // Sequence number of the last correctly reassembled PDU
+    unsigned int lastPduReassembled_;
+
+    bool init_;
+
+    // If true, the next PDU and the corresponding SDUs are considered in order
+    bool resetFlag_;
+
+    // module the statistics of a flow are emitted from
+    cModule* statModule(LteControlInfo* lteInfo) const;
+
+    void clearBuffer();
+
+    // move forward the reordering window
+    void moveRxWindow(const int pos);
+
+    // consider the PDU at position 'index' for reassembly
+    void reassemble(unsigned int index);
+
+    // deliver a PDCP PDU to the PDCP layer
+    void toPdcp(LteRlcSdu* rlcSdu);
+};
+
+#endif
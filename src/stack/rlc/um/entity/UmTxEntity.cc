@@ -23,6 +23,9 @@ void UmTxEntity::initialize()
     // store the node id of the owner module
     LteMacBase* mac = check_and_cast<LteMacBase*>(getParentModule()->getParentModule()->getSubmodule("mac"));
     ownerNodeId_ = mac->getMacNodeId();
+
+    lteRlc_ = check_and_cast<LteRlcUm *>(getParentModule()->getSubmodule("um"));
+    fastPath_ = lteRlc_->par("fastPath");
 }
 
 void UmTxEntity::enque(cPacket* pkt)
@@ -40,6 +43,16 @@ void UmTxEntity::rlcPduMake(int pduLength)
 {
     EV << NOW << " UmTxEntity::rlcPduMake - PDU with size " << pduLength << " requested from MAC"<< endl;
 
+    if (fastPath_)
+    {
+        LteRlcUmDataPdu* rlcPdu = rlcPduMakeSingleSdu(pduLength);
+        if (rlcPdu != NULL)
+        {
+            lteRlc_->sendToLowerLayer(rlcPdu);
+            return;
+        }
+    }
+
     // create the RLC PDU
     LteRlcUmDataPdu* rlcPdu = new LteRlcUmDataPdu("lteRlcFragment");
 
@@ -144,8 +157,34 @@ void UmTxEntity::rlcPduMake(int pduLength)
     // send to MAC layer
     EV << NOW << " UmTxEntity::rlcPduMake - send PDU " << rlcPdu->getPduSequenceNumber() << " with size " << rlcPdu->getByteLength() << " bytes to lower layer" << endl;
 
-    LteRlcUm* lteRlc = check_and_cast<LteRlcUm *>(getParentModule()->getSubmodule("um"));
-    lteRlc->sendToLowerLayer(rlcPdu);
+    lteRlc_->sendToLowerLayer(rlcPdu);
+}
+
+LteRlcUmDataPdu* UmTxEntity::rlcPduMakeSingleSdu(int pduLength)
+{
+    // only one whole SDU, fitting in the requested size: there is nothing to segment or concatenate
+    if (sduQueue_.getLength() != 1 || firstIsFragment_)
+        return NULL;
+
+    LteRlcSdu* rlcSdu = check_and_cast<LteRlcSdu*>(sduQueue_.front());
+    int sduLength = rlcSdu->getByteLength();
+    if (sduLength == 0 || pduLength - RLC_HEADER_UM < sduLength)
+        return NULL;
+
+    EV << NOW << " UmTxEntity::rlcPduMakeSingleSdu - whole SDU sduSno[" << rlcSdu->getSnoMainPacket()
+       << "], length[" << sduLength << "]" << endl;
+
+    sduQueue_.pop();
+
+    // same PDU as rlcPduMake() builds for a single whole SDU (FI=00)
+    LteRlcUmDataPdu* rlcPdu = new LteRlcUmDataPdu("lteRlcFragment");
+    rlcPdu->pushSdu(rlcSdu);
+    rlcPdu->setFramingInfo(0);
+    rlcPdu->setPduSequenceNumber(sno_++);
+    rlcPdu->setControlInfo(LteControlInfo_->dup());
+    rlcPdu->setByteLength(RLC_HEADER_UM + sduLength);
+
+    return rlcPdu;
 }
 
 void UmTxEntity::removeDataFromQueue()
@@ -13,6 +13,7 @@
 #include <omnetpp.h>
 #include "stack/rlc/um/LteRlcUmRealistic.h"
 #include "stack/rlc/LteRlcDefs.h"
+#include "stack/rlc/packet/LteRlcDataPdu.h"
 
 /**
  * @class UmTxEntity
@@ -43,6 +44,8 @@ class UmTxEntity : public cSimpleModule
     UmTxEntity()
     {
         LteControlInfo_ = NULL;
+        lteRlc_ = NULL;
+        fastPath_ = false;
     }
     virtual ~UmTxEntity()
     {
@@ -99,11 +102,25 @@ class UmTxEntity : public cSimpleModule
      */
     virtual void initialize();
 
+    /**
+     * Builds the PDU of a single whole SDU filling the request,
+     * the common case of broadcast sidelink traffic
+     *
+     * @return the PDU, or NULL if the queue does not allow the fast path
+     */
+    LteRlcUmDataPdu* rlcPduMakeSingleSdu(int pduLength);
+
   private:
 
     // Node id of the owner module
     MacNodeId ownerNodeId_;
 
+    // UM module the PDUs are sent through
+    LteRlcUm* lteRlc_;
+
+    // single-SDU fast path enabled on the UM module
+    bool fastPath_;
+
     /// Next PDU sequence number to be assigned
     unsigned int sno_;
 };
@@ -0,0 +1,218 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "world/mobility/HighwayMobility.h"
+
+#include <algorithm>
+#include <cmath>
+
+Define_Module(HighwayMobility);
+
+HighwayMobility::HighwayMobility() :
+    leader_(NULL), leaderResolved_(false)
+{
+}
+
+void HighwayMobility::initialize(int stage)
+{
+    BaseMobility::initialize(stage);
+
+    if (stage == 0)
+    {
+        std::string layout = par("layout").stdstringValue();
+        if (layout == "highway")
+            layout_ = HIGHWAY;
+        else if (layout == "grid")
+            layout_ = GRID;
+        else
+            throw cRuntimeError("HighwayMobility::initialize - unknown layout '%s' (highway|grid)", layout.c_str());
+
+        std::string model = par("speedModel").stdstringValue();
+        if (model == "constant")
+            speedModel_ = CONSTANT;
+        else if (model == "idm")
+            speedModel_ = IDM;
+        else
+            throw cRuntimeError("HighwayMobility::initialize - unknown speed model '%s' (constant|idm)", model.c_str());
+
+        lanesPerDirection_ = par("lanesPerDirection");
+        laneWidth_ = par("laneWidth");
+        blockLength_ = par("blockLength");
+        gridStreets_ = par("gridStreets");
+        origin_ = veins::Coord(par("originX").doubleValue(), par("originY").doubleValue(), par("originZ").doubleValue());
+
+        desiredSpeed_ = par("speed");
+        maxAcceleration_ = par("maxAcceleration");
+        comfortableDeceleration_ = par("comfortableDeceleration");
+        minGap_ = par("minGap");
+        timeHeadway_ = par("timeHeadway");
+        vehicleLength_ = par("vehicleLength");
+
+        double density = par("density");
+        if (lanesPerDirection_ <= 0 || density <= 0 || desiredSpeed_ < 0)
+            throw cRuntimeError("HighwayMobility::initialize - lanesPerDirection and density must be positive, speed non-negative");
+
+        // a two-way highway, or gridStreets two-way streets in each of the two orientations
+        numLanes_ = 2 * lanesPerDirection_ * (layout_ == GRID ? 2 * gridStreets_ : 1);
+        if (numLanes_ <= 0)
+            throw cRuntimeError("HighwayMobility::initialize - gridStreets must be positive");
+
+        cModule* host = getParentModule();
+        numVehicles_ = host->isVector() ? host->getVectorSize() : 1;
+        int index = host->isVector() ? host->getIndex() : 0;
+
+        int perLane = (numVehicles_ + numLanes_ - 1) / numLanes_;
+        double spacing = 1000.0 / density;
+        if (layout_ == GRID)
+        {
+            // the streets span the grid, one block past the last cross street before
+            // wrapping around, and the vehicles of a lane are spread along them
+            if (blockLength_ <= 0)
+                throw cRuntimeError("HighwayMobility::initialize - blockLength must be positive");
+            roadLength_ = gridStreets_ * blockLength_;
+            spacing = roadLength_ / perLane;
+            if (spacing < vehicleLength_ + minGap_)
+                throw cRuntimeError("HighwayMobility::initialize - %d vehicles per lane do not fit in %g m streets, "
+                    "increase gridStreets or blockLength", perLane, roadLength_);
+        }
+        else
+            roadLength_ = perLane * spacing;
+
+        // lanes are staggered, so that vehicles on adjacent lanes are not side by side
+        lane_ = index % numLanes_;
+        s_ = (index / numLanes_) * spacing + lane_ * spacing / numLanes_;
+        speed_ = desiredSpeed_;
+        lastUpdate_ = simTime();
+
+        veins::Coord pos, direction;
+        placeOnLane(s_, pos, direction);
+        move.setStart(pos, simTime());
+        move.setDirectionByVector(direction);
+        move.setSpeed(speed_);
+
+        WATCH(lane_);
+        WATCH(s_);
+        WATCH(speed_);
+    }
+}
+
+void HighwayMobility::placeOnLane(double s, veins::Coord& pos, veins::Coord& direction) const
+{
+    // lane index: [street][orientation][direction][lane within direction]
+    int laneInDirection = lane_ % lanesPerDirection_;
+    int dir = (lane_ / lanesPerDirection_) % 2;
+    int orientation = (layout_ == GRID) ? (lane_ / (2 * lanesPerDirection_)) % 2 : 0;
+    int street = (layout_ == GRID) ? lane_ / (4 * lanesPerDirection_) : 0;
+
+    // lateral offset from the street axis, right-hand traffic
+    double lateral = (laneInDirection + 0.5) * laneWidth_;
+    double along = (dir == 0) ? s : roadLength_ - s;
+    double sign = (dir == 0) ? 1.0 : -1.0;
+    double axis = street * blockLength_;
+
+    if (orientation == 0)
+    {
+        // east (dir 0) / west bound; y grows downwards on the playground
+        pos = veins::Coord(origin_.x + along, origin_.y + axis + sign * lateral, origin_.z);
+        direction = veins::Coord(sign, 0, 0);
+    }
+    else
+    {
+        // south (dir 0) / north bound
+        pos = veins::Coord(origin_.x + axis - sign * lateral, origin_.y + along, origin_.z);
+        direction = veins::Coord(0, sign, 0);
+    }
+}
+
+void HighwayMobility::resolveLeader()
+{
+    leaderResolved_ = true;
+
+    cModule* host = getParentModule();
+    if (!host->isVector())
+        return;
+
+    // the next vehicle in the lane, the last one follows the first (ring)
+    int next = host->getIndex() + numLanes_;
+    if (next >= numVehicles_)
+        next = lane_;
+    if (next == host->getIndex())
+        return;
+
+    cModule* leaderHost = host->getParentModule()->getSubmodule(host->getName(), next);
+    cModule* mob = leaderHost ? leaderHost->getSubmodule(getName()) : NULL;
+    leader_ = dynamic_cast<HighwayMobility*>(mob);
+    if (leader_ == NULL)
+        throw cRuntimeError("HighwayMobility::resolveLeader - %s has no HighwayMobility submodule '%s'",
+            leaderHost ? leaderHost->getFullPath().c_str() : "leader", getName());
+}
+
+double HighwayMobility::gapToLeader() const
+{
+    double ds = leader_->s_ - s_;
+    if (ds < 0)
+        ds += roadLength_;
+    return std::max(ds - vehicleLength_, 0.0);
+}
+
+double HighwayMobility::idmAcceleration(double gap, double leaderSpeed) const
+{
+    double free = 1.0 - pow(speed_ / desiredSpeed_, 4);
+    if (leader_ == NULL)
+        return maxAcceleration_ * free;
+
+    double dv = speed_ - leaderSpeed;
+    double desiredGap = minGap_ + std::max(0.0, speed_ * timeHeadway_ + speed_ * dv / (2 * sqrt(maxAcceleration_ * comfortableDeceleration_)));
+    double interaction = desiredGap / std::max(gap, 0.1);
+    return maxAcceleration_ * (free - interaction * interaction);
+}
+
+void HighwayMobility::makeMove()
+{
+    double dt = SIMTIME_DBL(simTime() - lastUpdate_);
+    lastUpdate_ = simTime();
+
+    if (speedModel_ == IDM && desiredSpeed_ > 0)
+    {
+        if (!leaderResolved_)
+            resolveLeader();
+
+        // ballistic update; the leader state is the one of its last update
+        double gap = leader_ ? gapToLeader() : 0;
+        double a = idmAcceleration(gap, leader_ ? leader_->speed_ : 0);
+        double v = std::max(speed_ + a * dt, 0.0);
+        double ds = (speed_ + v) / 2 * dt;
+        if (leader_ && ds > gap)
+        {
+            ds = gap;
+            v = 0;
+        }
+        s_ += ds;
+        speed_ = v;
+    }
+    else
+    {
+        s_ += speed_ * dt;
+    }
+
+    s_ = fmod(s_, roadLength_);
+
+    veins::Coord pos, direction;
+    placeOnLane(s_, pos, direction);
+    move.setStart(pos, simTime());
+    move.setDirectionByVector(direction);
+    move.setSpeed(speed_);
+}
+
+veins::Heading HighwayMobility::getHeading() const
+{
+    // Veins headings: counter-clockwise from east, with y growing downwards
+    veins::Coord direction = move.getDirection();
+    return veins::Heading(atan2(-direction.y, direction.x));
+}
@@ -0,0 +1,113 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef HIGHWAYMOBILITY_H
+#define HIGHWAYMOBILITY_H
+
+#include <omnetpp.h>
+
+#include "veins/base/modules/BaseMobility.h"
+#include "veins/base/utils/Heading.h"
+
+/**
+ * Built-in vehicular mobility, without SUMO/TraCI.
+ *
+ * Every lane is a closed ring of roadLength metres: a multi-lane, two-way
+ * highway, or the horizontal and vertical streets of a Manhattan grid.
+ * The host vector is spread over the lanes (vehicle i drives in lane
+ * i % numLanes). On the highway the spacing is given by the density in
+ * vehicles/km/lane, so the road length follows from the number of vehicles;
+ * the grid streets are gridStreets * blockLength long, so the density
+ * follows from the number of vehicles instead. Vehicles keep their lane
+ * and drive at a constant speed or follow the vehicle ahead with the
+ * Intelligent Driver Model.
+ *
+ * Being a veins::BaseMobility, the module sits under "veinsmobility" and
+ * answers the same position/speed queries the PHY and the applications
+ * already issue for TraCIMobility and stationary RSUs.
+ */
+class HighwayMobility : public veins::BaseMobility
+{
+  protected:
+    enum Layout
+    {
+        HIGHWAY, GRID
+    };
+    enum SpeedModel
+    {
+        CONSTANT, IDM
+    };
+
+    Layout layout_;
+    SpeedModel speedModel_;
+
+    // road geometry
+    int numVehicles_;
+    int lanesPerDirection_;
+    int numLanes_;
+    double laneWidth_;
+    double roadLength_;
+    double blockLength_;
+    int gridStreets_;
+    veins::Coord origin_;
+
+    // IDM parameters
+    double desiredSpeed_;
+    double maxAcceleration_;
+    double comfortableDeceleration_;
+    double minGap_;
+    double timeHeadway_;
+    double vehicleLength_;
+
+    // state along the lane
+    int lane_;
+    double s_;
+    double speed_;
+    simtime_t lastUpdate_;
+
+    // vehicle ahead in the same lane (NULL when driving alone)
+    HighwayMobility* leader_;
+    bool leaderResolved_;
+
+  protected:
+    virtual void initialize(int stage) override;
+
+    /** Advances the vehicle along its lane by one update interval */
+    virtual void makeMove() override;
+
+    /** Lanes are rings, nothing ever leaves the road */
+    virtual void fixIfHostGetsOutside() override {}
+
+    /** Position and driving direction for a given lane offset */
+    void placeOnLane(double s, veins::Coord& pos, veins::Coord& direction) const;
+
+    /** Distance to the rear of the vehicle ahead, along the ring */
+    double gapToLeader() const;
+
+    /** Intelligent Driver Model acceleration */
+    double idmAcceleration(double gap, double leaderSpeed) const;
+
+    void resolveLeader();
+
+  public:
+    HighwayMobility();
+
+    double getSpeed() const
+    {
+        return speed_;
+    }
+    veins::Heading getHeading() const;
+
+    double getLaneOffset() const
+    {
+        return s_;
+    }
+};
+
+#endif
@@ -20,6 +20,8 @@
 #include "inet/mobility/contract/IMobility.h"
 #include "inet/common/ModuleAccess.h"
 #include "veins/modules/mobility/traci/TraCIMobility.h"
+#include "veins/base/modules/BaseMobility.h"
+#include "common/LteLog.h"
 
 
 static int parseInt(const char *s, int defaultValue)
@@ -89,8 +91,8 @@ void ChannelAccess::initialize(int stage)
                         hostModule->getFullPath().c_str());
         }
         myRadioRef = cc->registerRadio(this);
-        EV_FATAL << "CRITICAL TEST: radioPos is updated from ChannelAccess::initialize"<<endl;
-        EV_FATAL << "CRITICAL TEST: Initialized Position is "<<radioPos.str() <<endl;
+        LTE_EV_DIAG << "CRITICAL TEST: radioPos is updated from ChannelAccess::initialize"<<endl;
+        LTE_EV_DIAG << "CRITICAL TEST: Initialized Position is "<<radioPos.str() <<endl;
         cc->setRadioPosition(myRadioRef, radioPos);
     }
 }
@@ -112,7 +114,7 @@ IChannelControl *ChannelAccess::getChannelControl()
  */
 void ChannelAccess::sendToChannel(AirFrame *msg)
 {
-    EV << "sendToChannel: sending to gates\n";
+    LTE_EV_DEBUG << "sendToChannel: sending to gates\n";
 
     // delegate it to ChannelControl
     cc->sendToChannel(myRadioRef, msg);
@@ -126,7 +128,7 @@ void ChannelAccess::receiveSignal(cComponent *source, simsignal_t signalID, cObj
 
         static inet::Coord out;
 
-        if (auto traci = check_and_cast<veins::TraCIMobility*>(obj)) {
+        if (auto traci = dynamic_cast<veins::TraCIMobility*>(obj)) {
             try {
                 const auto p = traci->getPosition();   // Veins API
                 out.x = p.x; out.y = p.y; out.z = p.z;
@@ -134,7 +136,12 @@ void ChannelAccess::receiveSignal(cComponent *source, simsignal_t signalID, cObj
                 EV_WARN << "CRITICAL TEST: ChannelAccess Casting Error "<<endl;
             }
         }
-        EV_FATAL << "CRITICAL TEST: radioPos is updated from ChannelAccess::receiveSignal"<<endl;
+        else if (auto base = dynamic_cast<veins::BaseMobility*>(obj)) {
+            // built-in highway mobility, stationary RSUs
+            const auto p = base->getPositionAt(simTime());
+            out.x = p.x; out.y = p.y; out.z = p.z;
+        }
+        LTE_EV_DIAG << "CRITICAL TEST: radioPos is updated from ChannelAccess::receiveSignal"<<endl;
         radioPos = out;
         positionUpdateArrived = true;
 
@@ -20,6 +20,7 @@
 #include <cassert>
 
 #include "stack/phy/packet/AirFrame_m.h"
+#include "common/LteProfiler.h"
 
 Define_Module(ChannelControl);
 
@@ -287,6 +288,7 @@ void ChannelControl::purgeOngoingTransmissions()
 
 void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
 {
+    LTE_PROFILE_SCOPE("ChannelControl", "sendToChannel");
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
 
     // loop through all radios in range
@@ -308,6 +310,7 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
             // Over 300m, dt=1us=10 bit times @ 10Mbps
             simtime_t delay = srcRadio->pos.distance(r->pos) / SPEED_OF_LIGHT;
             check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
+            LTE_PROFILE_COUNT("ChannelControl", "framesDelivered", 1);
         }
         else
             EV << "skipping radio listening on a different channel\n";
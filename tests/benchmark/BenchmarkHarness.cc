@@ -0,0 +1,253 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#include "BenchmarkHarness.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace ltebench {
+
+namespace {
+
+struct Run
+{
+    std::string name;
+    std::string runName;
+    uint64_t iterations;
+    double realNs;      // per iteration
+    double cpuNs;       // per iteration
+    std::string label;
+    std::map<std::string, double> counters;
+};
+
+std::vector<Benchmark*>& registry()
+{
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+std::string jsonEscape(const std::string& s)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+Run runOne(const Benchmark* b, const std::vector<int64_t>& args, double minTimeSec)
+{
+    const double minTimeNs = minTimeSec * 1e9;
+    uint64_t iterations = 1;
+    while (true)
+    {
+        State state(iterations, args);
+        b->function()(state);
+
+        const uint64_t maxIterations = 1000000000;
+        if (state.realNs() >= minTimeNs || iterations >= maxIterations)
+        {
+            Run r;
+            r.name = b->name();
+            r.runName = b->runName(args);
+            r.iterations = iterations;
+            r.realNs = state.realNs() / iterations;
+            r.cpuNs = state.cpuNs() / iterations;
+            r.label = state.label();
+            r.counters = state.counters;
+            if (state.itemsProcessed() && state.realNs() > 0)
+                r.counters["items_per_second"] = r.counters["items_per_second"] / (state.realNs() / 1e9);
+            return r;
+        }
+
+        // same growth policy as Google Benchmark: aim 40% above the target, at most 10x per step
+        double multiplier = (state.realNs() > 0) ? minTimeNs * 1.4 / state.realNs() : 10.0;
+        multiplier = std::min(10.0, std::max(2.0, multiplier));
+        iterations = std::min(maxIterations, (uint64_t)(iterations * multiplier));
+    }
+}
+
+void writeJson(const std::string& path, const std::vector<Run>& runs, const char* executable)
+{
+    std::ofstream f(path, std::ios::out | std::ios::trunc);
+    if (!f.is_open())
+    {
+        std::cerr << "lte_bench: cannot open " << path << std::endl;
+        return;
+    }
+
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+
+    f << "{\n  \"context\": {\n"
+      << "    \"date\": \"" << date << "\",\n"
+      << "    \"host_name\": \"" << jsonEscape(host) << "\",\n"
+      << "    \"executable\": \"" << jsonEscape(executable) << "\",\n"
+      << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+      << "    \"library_build_type\": \"release\"\n"
+#else
+      << "    \"library_build_type\": \"debug\"\n"
+#endif
+      << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        const Run& r = runs[i];
+        f << "    {\n"
+          << "      \"name\": \"" << jsonEscape(r.runName) << "\",\n"
+          << "      \"family_name\": \"" << jsonEscape(r.name) << "\",\n"
+          << "      \"run_name\": \"" << jsonEscape(r.runName) << "\",\n"
+          << "      \"run_type\": \"iteration\",\n"
+          << "      \"iterations\": " << r.iterations << ",\n"
+          << "      \"real_time\": " << r.realNs << ",\n"
+          << "      \"cpu_time\": " << r.cpuNs << ",\n"
+          << "      \"time_unit\": \"ns\"";
+        if (!r.label.empty())
+            f << ",\n      \"label\": \"" << jsonEscape(r.label) << "\"";
+        for (const auto& c : r.counters)
+            f << ",\n      \"" << jsonEscape(c.first) << "\": " << c.second;
+        f << "\n    }" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+    f << "  ]\n}\n";
+}
+
+bool parseFlag(const char* arg, const char* flag, std::string& value)
+{
+    size_t n = strlen(flag);
+    if (strncmp(arg, flag, n) != 0 || arg[n] != '=')
+        return false;
+    value = arg + n + 1;
+    return true;
+}
+
+} // unnamed namespace
+
+Benchmark* Benchmark::ArgsProduct(const std::vector<std::vector<int64_t>>& values)
+{
+    std::vector<std::vector<int64_t>> product(1);
+    for (const auto& axis : values)
+    {
+        std::vector<std::vector<int64_t>> next;
+        for (const auto& prefix : product)
+        {
+            for (int64_t v : axis)
+            {
+                std::vector<int64_t> a = prefix;
+                a.push_back(v);
+                next.push_back(a);
+            }
+        }
+        product.swap(next);
+    }
+    argSets_.insert(argSets_.end(), product.begin(), product.end());
+    return this;
+}
+
+std::string Benchmark::runName(const std::vector<int64_t>& args) const
+{
+    std::ostringstream os;
+    os << name_;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        os << '/';
+        if (i < argNames_.size())
+            os << argNames_[i] << ':';
+        os << args[i];
+    }
+    return os.str();
+}
+
+Benchmark* registerBenchmark(const char* name, BenchmarkFunction fn)
+{
+    Benchmark* b = new Benchmark(name, fn);
+    registry().push_back(b);
+    return b;
+}
+
+int runBenchmarks(int argc, char** argv)
+{
+    std::string filter = ".";
+    std::string out;
+    std::string outFormat = "json";
+    double minTime = 0.5;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string v;
+        if (parseFlag(argv[i], "--benchmark_filter", v))
+            filter = v;
+        else if (parseFlag(argv[i], "--benchmark_out", v))
+            out = v;
+        else if (parseFlag(argv[i], "--benchmark_out_format", v))
+            outFormat = v;
+        else if (parseFlag(argv[i], "--benchmark_min_time", v))
+            minTime = atof(v.c_str());
+        else if (strcmp(argv[i], "--benchmark_list_tests") == 0 || parseFlag(argv[i], "--benchmark_list_tests", v))
+            list = true;
+    }
+    if (outFormat != "json")
+    {
+        std::cerr << "lte_bench: only the json output format is supported" << std::endl;
+        return 1;
+    }
+
+    std::regex re(filter);
+    std::vector<Run> runs;
+
+    if (!list)
+        printf("%-64s %15s %15s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+    for (const Benchmark* b : registry())
+    {
+        std::vector<std::vector<int64_t>> argSets = b->argSets();
+        if (argSets.empty())
+            argSets.push_back(std::vector<int64_t>());
+
+        for (const auto& args : argSets)
+        {
+            std::string name = b->runName(args);
+            if (!std::regex_search(name, re))
+                continue;
+            if (list)
+            {
+                printf("%s\n", name.c_str());
+                continue;
+            }
+            Run r = runOne(b, args, minTime);
+            printf("%-64s %15.0f %15.0f %12llu", r.runName.c_str(), r.realNs, r.cpuNs, (unsigned long long)r.iterations);
+            for (const auto& c : r.counters)
+                printf(" %s=%g", c.first.c_str(), c.second);
+            if (!r.label.empty())
+                printf(" %s", r.label.c_str());
+            printf("\n");
+            fflush(stdout);
+            runs.push_back(r);
+        }
+    }
+
+    if (!out.empty() && !list)
+        writeJson(out, runs, argv[0]);
+    return 0;
+}
+
+} // namespace ltebench
@@ -0,0 +1,162 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_BENCHMARKHARNESS_H_
+#define _LTE_BENCHMARKHARNESS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal Google-Benchmark style harness used by the lte_bench executable.
+ *
+ * Benchmarks are registered with LTE_BENCHMARK(fn) and parameterized through
+ * Args(); each registered argument tuple becomes one run named "fn/a0/a1/...".
+ * Results are printed on the console and, with --benchmark_out, written as JSON
+ * using the same schema as Google Benchmark so existing comparison tools work.
+ */
+namespace ltebench {
+
+class State
+{
+  public:
+    // Loop variable of "for (auto _ : state)"; the user-provided destructor keeps -Wunused quiet
+    struct Value
+    {
+        ~Value() {}
+    };
+
+    class Iterator
+    {
+      public:
+        Iterator(State* s, uint64_t n) : state_(s), left_(n) {}
+        bool operator!=(const Iterator&) const
+        {
+            if (left_ != 0)
+                return true;
+            state_->stopTimer();
+            return false;
+        }
+        Iterator& operator++() { --left_; return *this; }
+        Value operator*() const { return Value(); }
+
+      private:
+        State* state_;
+        uint64_t left_;
+    };
+
+    State(uint64_t iterations, const std::vector<int64_t>& args) :
+        iterations_(iterations), args_(args), realNs_(0), cpuNs_(0), running_(false)
+    {
+    }
+
+    Iterator begin() { startTimer(); return Iterator(this, iterations_); }
+    Iterator end() { return Iterator(this, 0); }
+
+    int64_t range(size_t i) const { return args_.at(i); }
+    uint64_t iterations() const { return iterations_; }
+
+    // Excludes per-iteration setup from the measurement
+    void PauseTiming() { stopTimer(); }
+    void ResumeTiming() { startTimer(); }
+
+    void SetLabel(const std::string& label) { label_ = label; }
+    void SetItemsProcessed(int64_t items) { counters["items_per_second"] = (double)items; itemsProcessed_ = true; }
+
+    std::map<std::string, double> counters;
+
+    double realNs() const { return realNs_; }
+    double cpuNs() const { return cpuNs_; }
+    const std::string& label() const { return label_; }
+    bool itemsProcessed() const { return itemsProcessed_; }
+
+  private:
+    void startTimer()
+    {
+        if (running_)
+            return;
+        running_ = true;
+        realStart_ = std::chrono::steady_clock::now();
+        cpuStart_ = std::clock();
+    }
+    void stopTimer()
+    {
+        if (!running_)
+            return;
+        running_ = false;
+        realNs_ += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - realStart_).count();
+        cpuNs_ += 1e9 * (double)(std::clock() - cpuStart_) / CLOCKS_PER_SEC;
+    }
+
+    uint64_t iterations_;
+    std::vector<int64_t> args_;
+    double realNs_;
+    double cpuNs_;
+    bool running_;
+    bool itemsProcessed_ = false;
+    std::string label_;
+    std::chrono::steady_clock::time_point realStart_;
+    std::clock_t cpuStart_;
+};
+
+typedef std::function<void(State&)> BenchmarkFunction;
+
+class Benchmark
+{
+  public:
+    Benchmark(const char* name, BenchmarkFunction fn) : name_(name), fn_(fn) {}
+
+    Benchmark* Arg(int64_t a) { argSets_.push_back({a}); return this; }
+    Benchmark* Args(const std::vector<int64_t>& a) { argSets_.push_back(a); return this; }
+
+    // Cartesian product of the given per-argument values
+    Benchmark* ArgsProduct(const std::vector<std::vector<int64_t>>& values);
+
+    // Names of the arguments, used in the run names ("fn/bands:25/neighbours:50")
+    Benchmark* ArgNames(const std::vector<std::string>& names) { argNames_ = names; return this; }
+
+    const std::string& name() const { return name_; }
+    const BenchmarkFunction& function() const { return fn_; }
+    const std::vector<std::vector<int64_t>>& argSets() const { return argSets_; }
+    std::string runName(const std::vector<int64_t>& args) const;
+
+  private:
+    std::string name_;
+    BenchmarkFunction fn_;
+    std::vector<std::vector<int64_t>> argSets_;
+    std::vector<std::string> argNames_;
+};
+
+// Registers a benchmark; used through LTE_BENCHMARK
+Benchmark* registerBenchmark(const char* name, BenchmarkFunction fn);
+
+// Runs the registered benchmarks selected by the command line, returns the process exit code
+int runBenchmarks(int argc, char** argv);
+
+// Prevents the compiler from optimizing away a computed value
+template <class T>
+inline void DoNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace ltebench
+
+#define LTE_BENCHMARK_CONCAT_(a, b) a##b
+#define LTE_BENCHMARK_CONCAT(a, b) LTE_BENCHMARK_CONCAT_(a, b)
+
+#define LTE_BENCHMARK(fn) \
+    static ltebench::Benchmark* LTE_BENCHMARK_CONCAT(lteBenchmark_, __LINE__) = ltebench::registerBenchmark(#fn, fn)
+
+#endif
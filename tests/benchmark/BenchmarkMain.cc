@@ -0,0 +1,124 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Entry point of lte_bench: embeds the OMNeT++ kernel with a null environment,
+// sets up LteBenchmarkNetwork (a lone binder, which the channel model and the
+// BLER tables are looked up from) and runs the registered benchmarks.
+//
+
+#include <omnetpp.h>
+
+#include "BenchmarkHarness.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace omnetpp;
+
+namespace {
+
+class EmptyConfig : public cConfiguration
+{
+  protected:
+    class NullKeyValue : public KeyValue
+    {
+      public:
+        virtual const char *getKey() const override { return nullptr; }
+        virtual const char *getValue() const override { return nullptr; }
+        virtual const char *getBaseDirectory() const override { return nullptr; }
+    };
+    NullKeyValue nullKeyValue;
+
+  protected:
+    virtual const char *substituteVariables(const char *value) const override { return value; }
+
+  public:
+    virtual const char *getConfigValue(const char *key) const override { return nullptr; }
+    virtual const KeyValue& getConfigEntry(const char *key) const override { return nullKeyValue; }
+    virtual const char *getPerObjectConfigValue(const char *objectFullPath, const char *keySuffix) const override { return nullptr; }
+    virtual const KeyValue& getPerObjectConfigEntry(const char *objectFullPath, const char *keySuffix) const override { return nullKeyValue; }
+};
+
+/**
+ * Environment of the benchmark network: NED defaults for every parameter, no output
+ */
+class BenchmarkEnvir : public cNullEnvir
+{
+  public:
+    BenchmarkEnvir(int ac, char **av, cConfiguration *c) : cNullEnvir(ac, av, c) {}
+
+    virtual void readParameter(cPar *par) override
+    {
+        if (par->containsValue())
+            par->acceptDefault();
+        else
+            throw cRuntimeError("no value for parameter %s", par->getFullPath().c_str());
+    }
+
+    virtual bool isLoggingEnabled() const override { return false; }
+};
+
+// NED folders: --ned-path=<dir:dir...>, otherwise $NEDPATH
+std::string nedPath(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+        if (strncmp(argv[i], "--ned-path=", 11) == 0)
+            return argv[i] + 11;
+    const char *env = getenv("NEDPATH");
+    return env ? env : "";
+}
+
+} // unnamed namespace
+
+int main(int argc, char **argv)
+{
+    // must be the first line of main() when embedding the simulation kernel
+    cStaticFlag dummy;
+
+    CodeFragments::executeAll(CodeFragments::STARTUP);
+    SimTime::setScaleExp(-12);
+
+    int ret = 0;
+    try
+    {
+        std::string path = nedPath(argc, argv);
+        if (path.empty())
+            throw cRuntimeError("NED folders not given, use --ned-path or NEDPATH (see tests/benchmark/Makefile)");
+        cStringTokenizer tokenizer(path.c_str(), ":;");
+        while (tokenizer.hasMoreTokens())
+            cSimulation::loadNedSourceFolder(tokenizer.nextToken());
+        cSimulation::doneLoadingNedFiles();
+
+        cSimulation *sim = new cSimulation("lte_bench", new BenchmarkEnvir(argc, argv, new EmptyConfig()));
+        cSimulation::setActiveSimulation(sim);
+
+        cModuleType *networkType = cModuleType::find("LteBenchmarkNetwork");
+        if (networkType == nullptr)
+            throw cRuntimeError("network LteBenchmarkNetwork not found on the NED path");
+        sim->setupNetwork(networkType);
+        sim->callInitialize();
+
+        ret = ltebench::runBenchmarks(argc, argv);
+
+        sim->callFinish();
+        sim->deleteNetwork();
+        cSimulation::setActiveSimulation(nullptr);
+        delete sim;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "lte_bench: " << e.what() << std::endl;
+        ret = 1;
+    }
+
+    CodeFragments::executeAll(CodeFragments::SHUTDOWN);
+    return ret;
+}
@@ -0,0 +1,164 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Per-grant cost of the CBR congestion-control lookups in LteMacVUeMode4:
+// the typed tables (CbrTxConfig / CbrLevel) against the string-keyed maps they replaced.
+//
+
+#include "BenchmarkHarness.h"
+
+#include "stack/mac/layer/CbrTxConfig.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+typedef std::unordered_map<std::string, double> StringMap;
+
+// The ten CBR levels of simulations/Mode4/sidelink_configuration.xml
+const double LEVEL_BOUNDS[][2] = {
+    {0, 0.65}, {0.65, 0.675}, {0.675, 0.7}, {0.7, 0.725}, {0.725, 0.75},
+    {0.75, 0.8}, {0.8, 0.825}, {0.825, 0.85}, {0.85, 0.875}, {0.875, 1}
+};
+// minMCS, maxMCS, minSubchannels, maxSubchannels, allowedRetx: the same for every level in that file
+const int TX_CONFIG[] = { 5, 11, 2, 10, 0 };
+const double CR_LIMITS[] = { 1, 1.6e-3, 1.5e-3, 1.4e-3, 1.3e-3, 1.2e-3, 1.1e-3, 1.0e-3, 0.9e-3, 0.8e-3 };
+const int NUM_LEVELS = 10;
+
+// userEquipment-txParameters
+const int UE_MIN_MCS = 5, UE_MAX_MCS = 11, UE_MIN_SUBCHANNELS = 2, UE_MAX_SUBCHANNELS = 10, UE_ALLOWED_RETX = 0;
+
+// Channel busy ratios reported by the PHY, one per grant
+std::vector<double> cbrTrace(size_t n)
+{
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<double> cbr(0, 1);
+    std::vector<double> trace(n);
+    for (auto& c : trace)
+        c = cbr(rng);
+    return trace;
+}
+
+void BM_CbrLookupStringMaps(ltebench::State& state)
+{
+    std::vector<StringMap> levels;
+    std::vector<StringMap> txConfigs;
+    for (int i = 0; i < NUM_LEVELS; i++)
+    {
+        levels.push_back({ {"cbr-lower", LEVEL_BOUNDS[i][0]}, {"cbr-upper", LEVEL_BOUNDS[i][1]}, {"cbr-PSSCH-TxConfig-Index", (double)i} });
+        txConfigs.push_back({ {"minMCS-PSSCH", (double)TX_CONFIG[0]}, {"maxMCS-PSSCH", (double)TX_CONFIG[1]},
+                              {"minSubchannel-NumberPSSCH", (double)TX_CONFIG[2]}, {"maxSubchannel-NumberPSSCH", (double)TX_CONFIG[3]},
+                              {"allowedRetxNumberPSSCH", (double)TX_CONFIG[4]}, {"cr-Limit", CR_LIMITS[i]} });
+    }
+    std::vector<double> trace = cbrTrace(1024);
+    size_t next = 0;
+
+    for (auto _ : state)
+    {
+        double cbr = trace[next++ & 1023];
+
+        // CBR update: level search
+        int index = 0;
+        for (const StringMap& level : levels)
+        {
+            double cbrUpper = level.at("cbr-upper");
+            double cbrLower = level.at("cbr-lower");
+            bool match;
+            if (cbrLower == 0)
+                match = cbr < cbrUpper;
+            else if (cbrUpper == 1)
+                match = cbr > cbrLower;
+            else
+                match = cbr > cbrLower && cbr <= cbrUpper;
+            if (match)
+            {
+                index = (int)level.at("cbr-PSSCH-TxConfig-Index");
+                break;
+            }
+        }
+
+        // grant generation and HARQ flush: per-grant copy of the map and one find per field
+        StringMap cbrMap = txConfigs.at(index);
+        StringMap::const_iterator got = cbrMap.find("allowedRetxNumberPSSCH");
+        int retx = (got == cbrMap.end()) ? UE_ALLOWED_RETX : std::min((int)got->second, UE_ALLOWED_RETX);
+        got = cbrMap.find("minSubchannel-NumberPSSCH");
+        int minSub = (got == cbrMap.end()) ? UE_MIN_SUBCHANNELS : (int)got->second;
+        got = cbrMap.find("maxSubchannel-NumberPSSCH");
+        int maxSub = (got == cbrMap.end()) ? UE_MAX_SUBCHANNELS : (int)got->second;
+        got = cbrMap.find("minMCS-PSSCH");
+        int minMcs = (got == cbrMap.end()) ? UE_MIN_MCS : (int)got->second;
+        got = cbrMap.find("maxMCS-PSSCH");
+        int maxMcs = (got == cbrMap.end()) ? UE_MAX_MCS : (int)got->second;
+
+        StringMap flushMap = txConfigs.at(index);
+        got = flushMap.find("cr-Limit");
+        double crLimit = (got == flushMap.end()) ? 1 : got->second;
+
+        int result = retx + cbrRangeLower(UE_MIN_SUBCHANNELS, UE_MAX_SUBCHANNELS, minSub, maxSub)
+                + cbrRangeUpper(UE_MIN_SUBCHANNELS, UE_MAX_SUBCHANNELS, minSub, maxSub)
+                + cbrRangeLower(UE_MIN_MCS, UE_MAX_MCS, minMcs, maxMcs) + cbrRangeUpper(UE_MIN_MCS, UE_MAX_MCS, minMcs, maxMcs);
+        ltebench::DoNotOptimize(result);
+        ltebench::DoNotOptimize(crLimit);
+    }
+}
+LTE_BENCHMARK(BM_CbrLookupStringMaps);
+
+void BM_CbrLookupTyped(ltebench::State& state)
+{
+    // tables as built once by LteMacVUeMode4::parseCbrTxConfig, already merged with the UE txParameters
+    std::vector<CbrLevel> levels;
+    std::vector<CbrTxConfig> txConfigs;
+    for (int i = 0; i < NUM_LEVELS; i++)
+    {
+        CbrLevel level;
+        level.lower = LEVEL_BOUNDS[i][0];
+        level.upper = LEVEL_BOUNDS[i][1];
+        level.txConfigIndex = i;
+        levels.push_back(level);
+
+        CbrTxConfig config;
+        config.minMcs = cbrRangeLower(UE_MIN_MCS, UE_MAX_MCS, TX_CONFIG[0], TX_CONFIG[1]);
+        config.maxMcs = cbrRangeUpper(UE_MIN_MCS, UE_MAX_MCS, TX_CONFIG[0], TX_CONFIG[1]);
+        config.minSubchannels = cbrRangeLower(UE_MIN_SUBCHANNELS, UE_MAX_SUBCHANNELS, TX_CONFIG[2], TX_CONFIG[3]);
+        config.maxSubchannels = cbrRangeUpper(UE_MIN_SUBCHANNELS, UE_MAX_SUBCHANNELS, TX_CONFIG[2], TX_CONFIG[3]);
+        config.allowedRetx = std::min(TX_CONFIG[4], UE_ALLOWED_RETX);
+        config.crLimit = CR_LIMITS[i];
+        txConfigs.push_back(config);
+    }
+    std::vector<double> trace = cbrTrace(1024);
+    size_t next = 0;
+
+    for (auto _ : state)
+    {
+        double cbr = trace[next++ & 1023];
+
+        int index = 0;
+        for (const CbrLevel& level : levels)
+        {
+            if (level.contains(cbr))
+            {
+                index = level.txConfigIndex;
+                break;
+            }
+        }
+
+        const CbrTxConfig& config = txConfigs[index];
+        int result = config.allowedRetx + config.minSubchannels + config.maxSubchannels + config.minMcs + config.maxMcs;
+        double crLimit = config.crLimit;
+        ltebench::DoNotOptimize(result);
+        ltebench::DoNotOptimize(crLimit);
+    }
+}
+LTE_BENCHMARK(BM_CbrLookupTyped);
+
+} // unnamed namespace
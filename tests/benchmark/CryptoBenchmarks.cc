@@ -0,0 +1,178 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Signature and certificate kernels of the SPDU send/receive paths of Mode4App
+//
+
+#include "BenchmarkHarness.h"
+
+#include "apps/mode4App/pqcdsa.h"
+#include "apps/mode4App/CertificateUtils.h"
+
+#include <array>
+#include <random>
+
+namespace {
+
+// Index used as benchmark argument -> entry of the pqcdsa algorithm registry
+std::vector<int64_t> algorithmIndices()
+{
+    std::vector<int64_t> indices;
+    for (size_t i = 0; i < pqcdsa::algorithms().size(); i++)
+        indices.push_back(i);
+    return indices;
+}
+const std::vector<int64_t> ALL_ALGORITHMS = algorithmIndices();
+
+// Selects the algorithm of the benchmark; false (and an empty run) if liboqs lacks it
+bool selectAlgorithm(ltebench::State& state)
+{
+    const pqcdsa::AlgorithmInfo& info = pqcdsa::algorithms()[state.range(0)];
+    if (!pqcdsa::isAvailable(info))
+    {
+        for (auto _ : state)
+            ;
+        state.SetLabel(std::string(info.tag) + " (not enabled in liboqs)");
+        return false;
+    }
+    pqcdsa::setAlgorithm(info.tag);
+    state.SetLabel(info.tag);
+    return true;
+}
+
+// Size of the signed BSM body in Mode4App (43 bytes) and of a larger SPDU payload
+const std::vector<int64_t> MESSAGE_SIZES = { 43, 300 };
+
+std::string randomHex(size_t bytes, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> buf(bytes);
+    for (auto& b : buf)
+        b = (uint8_t)rng();
+    return pqcdsa::toHex(buf.data(), buf.size());
+}
+
+void BM_PqcKeyGen(ltebench::State& state)
+{
+    if (!selectAlgorithm(state))
+        return;
+    for (auto _ : state)
+    {
+        pqcdsa::KeyPair kp = pqcdsa::generateKeyPair();
+        ltebench::DoNotOptimize(kp.pubHex);
+    }
+    state.counters["reference_ms"] = pqcdsa::algorithms()[state.range(0)].keyGenMs;
+}
+LTE_BENCHMARK(BM_PqcKeyGen)->ArgNames({"alg"})->ArgsProduct({ALL_ALGORITHMS});
+
+void BM_PqcSign(ltebench::State& state)
+{
+    if (!selectAlgorithm(state))
+        return;
+    pqcdsa::KeyPair kp = pqcdsa::generateKeyPair();
+    std::string msgHex = randomHex(state.range(1), 1);
+    size_t sigBytes = 0;
+    for (auto _ : state)
+    {
+        std::string sigHex = pqcdsa::sign(msgHex, kp.privHex);
+        sigBytes = sigHex.size() / 2;
+        ltebench::DoNotOptimize(sigHex);
+    }
+    state.counters["signature_bytes"] = (double)sigBytes;
+    state.counters["reference_ms"] = pqcdsa::algorithms()[state.range(0)].signMs;
+}
+LTE_BENCHMARK(BM_PqcSign)->ArgNames({"alg", "bytes"})->ArgsProduct({ALL_ALGORITHMS, MESSAGE_SIZES});
+
+void BM_PqcVerify(ltebench::State& state)
+{
+    if (!selectAlgorithm(state))
+        return;
+    pqcdsa::KeyPair kp = pqcdsa::generateKeyPair();
+    std::string msgHex = randomHex(state.range(1), 2);
+    std::string sigHex = pqcdsa::sign(msgHex, kp.privHex);
+    for (auto _ : state)
+    {
+        bool ok = pqcdsa::verify(msgHex, sigHex, kp.pubHex);
+        ltebench::DoNotOptimize(ok);
+    }
+    state.counters["reference_ms"] = pqcdsa::algorithms()[state.range(0)].verifyMs;
+}
+LTE_BENCHMARK(BM_PqcVerify)->ArgNames({"alg", "bytes"})->ArgsProduct({ALL_ALGORITHMS, MESSAGE_SIZES});
+
+// Hex helpers, sized after an ECDSA signature, a Falcon-512 public key and a Dilithium-2 signature
+const std::vector<int64_t> HEX_SIZES = { 64, 897, 2420 };
+
+void BM_HexEncode(ltebench::State& state)
+{
+    std::vector<uint8_t> buf = pqcdsa::fromHex(randomHex(state.range(0), 3));
+    for (auto _ : state)
+    {
+        std::string hex = pqcdsa::toHex(buf.data(), buf.size());
+        ltebench::DoNotOptimize(hex);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+LTE_BENCHMARK(BM_HexEncode)->ArgNames({"bytes"})->ArgsProduct({HEX_SIZES});
+
+void BM_HexDecode(ltebench::State& state)
+{
+    // keys travel prefixed with their algorithm tag, decode them as the apps do
+    std::string hex = std::string("ALG:falcon-512:") + randomHex(state.range(0), 4);
+    for (auto _ : state)
+    {
+        std::vector<uint8_t> buf = pqcdsa::fromHex(hex);
+        ltebench::DoNotOptimize(buf);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+LTE_BENCHMARK(BM_HexDecode)->ArgNames({"bytes"})->ArgsProduct({HEX_SIZES});
+
+void BM_AlgoTagFromKey(ltebench::State& state)
+{
+    if (!selectAlgorithm(state))
+        return;
+    pqcdsa::KeyPair kp = pqcdsa::generateKeyPair();
+    for (auto _ : state)
+    {
+        std::string tag = pqcdsa::algoTagFromKey(kp.pubHex);
+        ltebench::DoNotOptimize(tag);
+    }
+}
+LTE_BENCHMARK(BM_AlgoTagFromKey)->ArgNames({"alg"})->ArgsProduct({ALL_ALGORITHMS});
+
+void BM_ComputeHashedId8(ltebench::State& state)
+{
+    // certificate filled as Mode4App::initialize does
+    if (!selectAlgorithm(state))
+        return;
+    pqcdsa::KeyPair kp = pqcdsa::generateKeyPair();
+    std::vector<uint8_t> pkBytes = pqcdsa::fromHex(kp.pubHex);
+
+    Certificate cert;
+    cert.setAlgoName(pqcdsa::prettyNameFromTag(pqcdsa::algoTagFromKey(kp.pubHex)).c_str());
+    cert.setSubjectId("node[0]");
+    cert.setPublicKeyArraySize(pkBytes.size());
+    for (size_t i = 0; i < pkBytes.size(); i++)
+        cert.setPublicKey(i, pkBytes[i]);
+    cert.setVersion(3);
+    cert.setCertType(0);
+    cert.setIssuerType(1);
+    cert.setAppPermPsid(0x20);
+
+    for (auto _ : state)
+    {
+        std::array<uint8_t,8> id8 = computeHashedId8(cert);
+        ltebench::DoNotOptimize(id8);
+    }
+    state.counters["public_key_bytes"] = (double)pkBytes.size();
+}
+LTE_BENCHMARK(BM_ComputeHashedId8)->ArgNames({"alg"})->ArgsProduct({ALL_ALGORITHMS});
+
+} // unnamed namespace
@@ -0,0 +1,418 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Channel model, BLER and sensing kernels of the Mode 4 PHY.
+// They run inside the minimal LteBenchmarkNetwork set up by BenchmarkMain.cc
+// (a binder only), so no UE, eNB or mobility module is involved.
+//
+
+#include "BenchmarkHarness.h"
+
+#include "common/LteCommon.h"
+#include "common/LteControlInfo.h"
+#include "corenetwork/binder/LteBinder.h"
+#include "corenetwork/binder/PhyPisaData.h"
+#include "stack/phy/ChannelModel/LteRealisticChannelModel.h"
+#include "stack/phy/layer/LtePhyVUeMode4.h"
+#include "stack/phy/layer/Subchannel.h"
+
+#include <random>
+
+namespace {
+
+// Arguments shared by the PHY benchmarks
+const std::vector<int64_t> NUM_BANDS = { 10, 25, 50 };
+const std::vector<int64_t> NUM_SUBCHANNELS = { 3, 5, 10 };
+const std::vector<int64_t> NUM_NEIGHBOURS = { 10, 50, 200 };
+
+// ---------------------------------------------------------------------------
+// PhyPisaData BLER lookups, as done by LteRealisticChannelModel::error_Mode4
+// ---------------------------------------------------------------------------
+
+// MCS values allowed on the PSSCH by the sidelink configuration, SINRs of a typical reception
+const uint16_t SWEEP_MCS[] = { 0, 4, 7, 11, 15, 20 };
+const double SWEEP_SINR[] = { -5.3, -1.0, 2.7, 6.2, 9.9, 14.1, 19.6 };
+
+void BM_PisaPsschBler(ltebench::State& state)
+{
+    int64_t lookups = 0;
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (uint16_t mcs : SWEEP_MCS)
+            for (double sinr : SWEEP_SINR)
+                sum += PhyPisaData::GetPsschBler(PhyPisaData::AWGN, PhyPisaData::SISO, mcs, sinr);
+        lookups += sizeof(SWEEP_MCS) / sizeof(SWEEP_MCS[0]) * sizeof(SWEEP_SINR) / sizeof(SWEEP_SINR[0]);
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(lookups);
+}
+LTE_BENCHMARK(BM_PisaPsschBler);
+
+void BM_PisaPscchBler(ltebench::State& state)
+{
+    int64_t lookups = 0;
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (double sinr : SWEEP_SINR)
+            sum += PhyPisaData::GetPscchBler(PhyPisaData::AWGN, PhyPisaData::SISO, sinr);
+        lookups += sizeof(SWEEP_SINR) / sizeof(SWEEP_SINR[0]);
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(lookups);
+}
+LTE_BENCHMARK(BM_PisaPscchBler);
+
+void BM_PisaBlerAnalytical(ltebench::State& state)
+{
+    int64_t lookups = 0;
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (uint16_t mcs : SWEEP_MCS)
+            for (double sinr : SWEEP_SINR)
+                sum += PhyPisaData::GetBlerAnalytical(mcs, sinr);
+        lookups += sizeof(SWEEP_MCS) / sizeof(SWEEP_MCS[0]) * sizeof(SWEEP_SINR) / sizeof(SWEEP_SINR[0]);
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(lookups);
+}
+LTE_BENCHMARK(BM_PisaBlerAnalytical);
+
+void BM_PisaBlerCurves(ltebench::State& state)
+{
+    // table lookups of the legacy (non sidelink) error model
+    PhyPisaData& pisa = getBinder()->phyPisaData;
+    int64_t lookups = 0;
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (int txMode = 0; txMode < pisa.nTxMode(); txMode++)
+            for (int cqi = 1; cqi < pisa.nMcs(); cqi++)
+                for (int snr = 1; snr <= pisa.maxSnr(); snr += 4)
+                    sum += pisa.getBler(txMode, cqi, snr);
+        lookups += pisa.nTxMode() * (pisa.nMcs() - 1) * ((pisa.maxSnr() + 3) / 4);
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(lookups);
+}
+LTE_BENCHMARK(BM_PisaBlerCurves);
+
+// ---------------------------------------------------------------------------
+// LteRealisticChannelModel
+// ---------------------------------------------------------------------------
+
+const char* const SCENARIOS[] = { "ANALYTICAL", "URBAN_MICROCELL", "URBAN_MACROCELL", "RURAL_MACROCELL" };
+
+// Channel model configured like simulations/Mode4/config_channel.xml
+LteRealisticChannelModel* createChannelModel(const char* scenario, unsigned int bands, const char* fadingType)
+{
+    ParameterMap params;
+    params["scenario"].setStringValue(scenario);
+    params["carrierFrequency"].setDoubleValue(5.9);
+    params["shadowing"].setBoolValue(true);
+    params["fading"].setBoolValue(true);
+    params["fading-type"].setStringValue(fadingType);
+    params["fading-paths"].setLongValue(6);
+    params["tolerateMaxDistViolation"].setBoolValue(true);
+    params["dynamic-los"].setBoolValue(true);
+    return new LteRealisticChannelModel(params, inet::Coord(0, 0, 0), bands);
+}
+
+// Vehicles on a 2 km, 3+3 lane highway around the receiver at the origin
+std::vector<inet::Coord> highwayPositions(int n, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> x(-1000, 1000);
+    std::uniform_int_distribution<int> lane(0, 5);
+    std::vector<inet::Coord> positions;
+    for (int i = 0; i < n; i++)
+        positions.push_back(inet::Coord(x(rng), 4.0 * lane(rng), 0));
+    return positions;
+}
+
+void BM_PathLossD2D(ltebench::State& state)
+{
+    LteRealisticChannelModel* channel = createChannelModel(SCENARIOS[state.range(0)], 1, "NAKAGAMI");
+    std::vector<inet::Coord> positions = highwayPositions(state.range(1), 5);
+    inet::Coord rx(0, 0, 0);
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            std::tuple<double, double> att = channel->getAttenuation_D2D(1025 + i, D2D, positions[i], 1024, rx);
+            sum += std::get<1>(att);
+        }
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * positions.size());
+    state.SetLabel(SCENARIOS[state.range(0)]);
+    delete channel;
+}
+LTE_BENCHMARK(BM_PathLossD2D)->ArgNames({"scenario", "neighbours"})->ArgsProduct({{0, 1, 2, 3}, NUM_NEIGHBOURS});
+
+void BM_JakesFading(ltebench::State& state)
+{
+    // eNB-side jakes map (cqiDl = false): the UE-side one needs the peer's PHY module
+    const unsigned int bands = state.range(0);
+    LteRealisticChannelModel* channel = createChannelModel("URBAN_MACROCELL", bands, "JAKES");
+    const int neighbours = state.range(1);
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (int n = 0; n < neighbours; n++)
+            for (unsigned int b = 0; b < bands; b++)
+                sum += channel->jakesFading(1025 + n, 33.3, b, false);
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * neighbours * bands);
+    delete channel;
+}
+LTE_BENCHMARK(BM_JakesFading)->ArgNames({"bands", "neighbours"})->ArgsProduct({NUM_BANDS, NUM_NEIGHBOURS});
+
+void BM_RsrpD2D(ltebench::State& state)
+{
+    // one getRSRP_D2D per transmitting neighbour, as decodeAirFrame does for every received frame
+    const unsigned int bands = state.range(0);
+    LteRealisticChannelModel* channel = createChannelModel("ANALYTICAL", bands, "NAKAGAMI");
+    std::vector<inet::Coord> positions = highwayPositions(state.range(1), 6);
+    inet::Coord rx(0, 0, 0);
+
+    std::vector<UserControlInfo*> infos;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        UserControlInfo* info = new UserControlInfo();
+        info->setSourceId(1025 + i);
+        info->setDirection(D2D);
+        info->setD2dTxPower(23);
+        info->setTotalGrantedBlocks(10);
+        info->setCoord(positions[i]);
+        infos.push_back(info);
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (UserControlInfo* info : infos)
+        {
+            std::tuple<std::vector<double>, double> rsrp = channel->getRSRP_D2D(nullptr, info, 1024, rx);
+            sum += std::get<0>(rsrp)[0];
+        }
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * infos.size());
+
+    for (UserControlInfo* info : infos)
+        delete info;
+    delete channel;
+}
+LTE_BENCHMARK(BM_RsrpD2D)->ArgNames({"bands", "neighbours"})->ArgsProduct({NUM_BANDS, NUM_NEIGHBOURS});
+
+void BM_RssiSinrD2D(ltebench::State& state)
+{
+    // getRSSI_SINR after getRSRP_D2D, traced once per band: compare a default build with
+    // one from "make makefiles-release" to see the cost of the compiled-in log statements
+    const unsigned int bands = state.range(0);
+    LteRealisticChannelModel* channel = createChannelModel("ANALYTICAL", bands, "NAKAGAMI");
+    std::vector<inet::Coord> positions = highwayPositions(state.range(1), 6);
+    inet::Coord rx(0, 0, 0);
+
+    std::vector<UserControlInfo*> infos;
+    std::vector<std::vector<double>> rsrps;
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        UserControlInfo* info = new UserControlInfo();
+        info->setSourceId(1025 + i);
+        info->setDirection(D2D);
+        info->setD2dTxPower(23);
+        info->setTotalGrantedBlocks(10);
+        info->setCoord(positions[i]);
+        infos.push_back(info);
+        rsrps.push_back(std::get<0>(channel->getRSRP_D2D(nullptr, info, 1024, rx)));
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (size_t i = 0; i < infos.size(); i++)
+        {
+            std::tuple<std::vector<double>, std::vector<double>> rssiSinr = channel->getRSSI_SINR(nullptr, infos[i], 1024, rx, 0, rsrps[i]);
+            sum += std::get<1>(rssiSinr)[0];
+        }
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * infos.size());
+
+    for (UserControlInfo* info : infos)
+        delete info;
+    delete channel;
+}
+LTE_BENCHMARK(BM_RssiSinrD2D)->ArgNames({"bands", "neighbours"})->ArgsProduct({NUM_BANDS, NUM_NEIGHBOURS});
+
+// ---------------------------------------------------------------------------
+// Subchannel averaging
+// ---------------------------------------------------------------------------
+
+void fillSubchannel(Subchannel* s, Band firstBand, int bands, std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> power(-110, -60);
+    std::vector<Band> occupied;
+    for (int b = 0; b < bands; b++)
+    {
+        Band band = firstBand + b;
+        occupied.push_back(band);
+        s->addRsrpValue(power(rng), band);
+        s->addRssiValue(power(rng) + 3, band);
+    }
+    s->setOccupiedBands(occupied);
+}
+
+void BM_SubchannelAverage(ltebench::State& state)
+{
+    // one subframe of the sensing window: numSubchannels subchannels of subchannelSize bands each
+    const int subchannels = state.range(0);
+    const int subchannelSize = state.range(1);
+    std::mt19937 rng(7);
+    std::vector<Subchannel*> subframe;
+    for (int i = 0; i < subchannels; i++)
+    {
+        Subchannel* s = new Subchannel(subchannelSize, SIMTIME_ZERO);
+        fillSubchannel(s, i * subchannelSize, subchannelSize, rng);
+        subframe.push_back(s);
+    }
+
+    for (auto _ : state)
+    {
+        double sum = 0;
+        for (Subchannel* s : subframe)
+        {
+            sum += s->getAverageRSRP();
+            sum += s->getAverageRSSI();
+        }
+        ltebench::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * subchannels);
+
+    for (Subchannel* s : subframe)
+        delete s;
+}
+LTE_BENCHMARK(BM_SubchannelAverage)->ArgNames({"subchannels", "bands"})->ArgsProduct({NUM_SUBCHANNELS, {5, 10, 25}});
+
+// ---------------------------------------------------------------------------
+// Sensing-based resource selection (LtePhyVUeMode4::selectCSRs)
+// ---------------------------------------------------------------------------
+
+/**
+ * LtePhyVUeMode4 with a synthetic sensing window instead of one filled by received SCIs.
+ * Only the members read by the selection are set up; the module is never initialized.
+ */
+class SensingKernel : public LtePhyVUeMode4
+{
+  public:
+    SensingKernel(int numSubchannels, int subchannelSize, int neighbours, bool rssiFiltering, unsigned int seed)
+    {
+        das_ = NULL;
+        pStep_ = 100;
+        numSubchannels_ = numSubchannels;
+        subchannelSize_ = subchannelSize;
+        selectionWindowStartingSubframe_ = 1;
+        sensingWindowSizeOverride_ = -1;
+        rssiFiltering_ = rssiFiltering;
+        rsrpFiltering_ = false;
+        sensingWindowFront_ = 10 * pStep_ - 1;
+        for (int i = 1; i < 66; i++)
+            ThresPSSCHRSRPvector_.push_back(i);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> noise(-115, -105);
+        for (int sf = 0; sf < 10 * pStep_; sf++)
+        {
+            std::vector<Subchannel*> subframe;
+            for (int i = 0; i < numSubchannels_; i++)
+            {
+                Subchannel* s = new Subchannel(subchannelSize_, SIMTIME_ZERO);
+                for (int b = 0; b < subchannelSize_; b++)
+                    s->addRssiValue(noise(rng), i * subchannelSize_ + b);
+                subframe.push_back(s);
+            }
+            sensingWindow_.push_back(subframe);
+        }
+
+        // every neighbour keeps a 100 ms SPS reservation over one or two subchannels
+        std::uniform_int_distribution<int> offset(0, pStep_ - 1);
+        std::uniform_int_distribution<int> firstSubchannel(0, numSubchannels_ - 1);
+        std::uniform_real_distribution<double> rsrp(-100, -60);
+        for (int n = 0; n < neighbours; n++)
+        {
+            int start = offset(rng);
+            int first = firstSubchannel(rng);
+            int length = std::min(1 + n % 2, numSubchannels_ - first);
+            double power = rsrp(rng);
+            for (int sf = start; sf < 10 * pStep_; sf += pStep_)
+            {
+                for (int i = first; i < first + length; i++)
+                {
+                    Subchannel* s = sensingWindow_[sf][i];
+                    s->setReserved(true);
+                    s->setResourceReservationInterval(1);
+                    s->setPriority(n % 8);
+                    for (int b = 0; b < subchannelSize_; b++)
+                    {
+                        s->addRsrpValue(power, i * subchannelSize_ + b);
+                        s->addRssiValue(power + 3, i * subchannelSize_ + b);
+                    }
+                }
+            }
+        }
+    }
+
+    virtual ~SensingKernel()
+    {
+        for (auto& subframe : sensingWindow_)
+            for (Subchannel* s : subframe)
+                delete s;
+    }
+
+    std::vector<std::tuple<double, int, int, bool>> select(LteMode4SchedulingGrant* grant)
+    {
+        return selectCSRs(grant);
+    }
+};
+
+void BM_SelectCSRs(ltebench::State& state)
+{
+    SensingKernel kernel(state.range(0), 10, state.range(1), state.range(2) != 0, 11);
+
+    LteMode4SchedulingGrant* grant = new LteMode4SchedulingGrant("grant");
+    grant->setPeriod(100);
+    grant->setMaximumLatency(100);
+    grant->setNumberSubchannels(1);
+    grant->setResourceReselectionCounter(10);
+    grant->setSpsPriority(3);
+    grant->setPossibleRRIs({1});
+
+    size_t csrs = 0;
+    for (auto _ : state)
+    {
+        std::vector<std::tuple<double, int, int, bool>> selected = kernel.select(grant);
+        csrs = selected.size();
+        ltebench::DoNotOptimize(selected);
+    }
+    state.counters["csrs"] = (double)csrs;
+    state.SetLabel(state.range(2) ? "rssiFiltering" : "random");
+    delete grant;
+}
+LTE_BENCHMARK(BM_SelectCSRs)->ArgNames({"subchannels", "neighbours", "rssi"})->ArgsProduct({NUM_SUBCHANNELS, NUM_NEIGHBOURS, {0, 1}});
+
+} // unnamed namespace
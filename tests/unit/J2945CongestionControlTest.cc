@@ -0,0 +1,84 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Dead reckoning of J2945CongestionControl: a vehicle moving at constant speed
+// along its announced heading must not see any tracking error, whatever its
+// direction (headings as given by the veins mobilities, y growing southwards).
+//
+
+#include "UnitTest.h"
+
+#include "apps/mode4App/J2945CongestionControl.h"
+
+namespace {
+
+J2945CongestionControl::Params params()
+{
+    J2945CongestionControl::Params p;
+    p.cbrWeight = 0.5;
+    p.densityWeight = 0.05;
+    p.densityRange = 100;
+    p.densityWindow = 1;
+    p.densityCoefficient = 25;
+    p.minItt = 0.1;
+    p.maxItt = 0.6;
+    p.minTxPower = 10;
+    p.maxTxPower = 20;
+    p.minChanUtil = 0.5;
+    p.maxChanUtil = 0.8;
+    p.trackingErrMin = 0.2;
+    p.trackingErrMax = 0.5;
+    return p;
+}
+
+// tracking error after "elapsed" seconds at "speed" from (500, 500), moving by (dx, dy) per meter
+void checkConstantSpeed(double heading, double dx, double dy)
+{
+    J2945CongestionControl congestion(params());
+    const double speed = 20;
+    const veins::Coord start(500, 500, 0);
+    congestion.transmitted(1, start, speed, heading);
+
+    for (int ms = 100; ms <= 1000; ms += 100)
+    {
+        double travelled = speed * ms / 1000.0;
+        veins::Coord position(start.x + dx * travelled, start.y + dy * travelled, 0);
+        double probability = congestion.trackingProbability(position, SimTime(1) + SimTime(ms, SIMTIME_MS));
+        LTE_CHECK_NEAR(congestion.getTrackingError(), 0, 1e-6);
+        LTE_CHECK(probability == 0);
+    }
+}
+
+} // unnamed namespace
+
+LTE_TEST(J2945_Northbound)
+{
+    checkConstantSpeed(M_PI / 2, 0, -1);
+}
+
+LTE_TEST(J2945_Southbound)
+{
+    checkConstantSpeed(-M_PI / 2, 0, 1);
+}
+
+LTE_TEST(J2945_Eastbound)
+{
+    checkConstantSpeed(0, 1, 0);
+}
+
+LTE_TEST(J2945_DriftTriggersTransmission)
+{
+    // announced northbound, actually southbound: 2 m off after 50 ms at 20 m/s
+    J2945CongestionControl congestion(params());
+    congestion.transmitted(1, veins::Coord(500, 500, 0), 20, M_PI / 2);
+    double probability = congestion.trackingProbability(veins::Coord(500, 501, 0), SimTime(1) + SimTime(50, SIMTIME_MS));
+    LTE_CHECK_NEAR(congestion.getTrackingError(), 2, 1e-6);
+    LTE_CHECK(probability == 1);
+}
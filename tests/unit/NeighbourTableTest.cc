@@ -0,0 +1,67 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Late authentication in NeighbourTable: an entry updated by an unverified
+// (compact) BSM becomes verified when that BSM is authenticated, and goes
+// away when it fails, unless a newer BSM replaced it in the meantime.
+//
+
+#include "UnitTest.h"
+
+#include "apps/mode4App/NeighbourTable.h"
+
+namespace {
+
+const veins::Coord ORIGIN(0, 0, 0);
+
+void receive(NeighbourTable& table, uint32_t id, uint8_t msgCnt, bool verified)
+{
+    table.update(id, veins::Coord(10, 0, 0), 20, 0, msgCnt, 1, verified, 1);
+}
+
+} // unnamed namespace
+
+LTE_TEST(NeighbourTable_AuthenticatedLater)
+{
+    NeighbourTable table(1);
+    receive(table, 7, 3, false);
+    LTE_CHECK(!table.find(7)->verified);
+
+    table.authenticated(7, 3);
+    LTE_CHECK(table.find(7)->verified);
+}
+
+LTE_TEST(NeighbourTable_RejectedIsRemoved)
+{
+    NeighbourTable table(1);
+    receive(table, 7, 3, true);
+    receive(table, 8, 3, true);
+    receive(table, 7, 4, false);
+    LTE_CHECK(table.countWithin(ORIGIN, 100, 1, 1) == 2);
+
+    table.rejected(7, 4);
+    LTE_CHECK(table.find(7) == nullptr);
+    LTE_CHECK(table.find(8) != nullptr);
+    LTE_CHECK(table.countWithin(ORIGIN, 100, 1, 1) == 1);
+}
+
+LTE_TEST(NeighbourTable_NewerBsmKept)
+{
+    // the outcome of msgCnt 4 arrives after msgCnt 5 replaced it
+    NeighbourTable table(1);
+    receive(table, 7, 4, false);
+    receive(table, 7, 5, false);
+
+    table.authenticated(7, 4);
+    LTE_CHECK(!table.find(7)->verified);
+    table.rejected(7, 4);
+    LTE_CHECK(table.find(7) != nullptr);
+    LTE_CHECK(table.find(7)->msgCnt == 5);
+}
@@ -0,0 +1,77 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+#ifndef _LTE_UNITTEST_H_
+#define _LTE_UNITTEST_H_
+
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal harness of the lte_unit executable.
+ *
+ * Tests are registered with LTE_TEST(name) and check their expectations with
+ * LTE_CHECK / LTE_CHECK_NEAR; a failed check is reported and ends its test,
+ * the other tests still run.
+ */
+namespace lteunit {
+
+struct Failure
+{
+    std::string message;
+};
+
+typedef std::function<void()> TestFunction;
+
+struct Test
+{
+    const char* name;
+    TestFunction fn;
+};
+
+std::vector<Test>& registry();
+
+struct Registrar
+{
+    Registrar(const char* name, TestFunction fn) { registry().push_back({name, fn}); }
+};
+
+// runs the tests matching --filter=<substring>, returns the number of failures
+int runTests(int argc, char** argv);
+
+} // namespace lteunit
+
+#define LTE_TEST(name) \
+    static void name(); \
+    static lteunit::Registrar name##_registrar(#name, name); \
+    static void name()
+
+#define LTE_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::ostringstream os; \
+            os << __FILE__ << ":" << __LINE__ << ": " << #cond; \
+            throw lteunit::Failure{os.str()}; \
+        } \
+    } while (0)
+
+#define LTE_CHECK_NEAR(a, b, tolerance) \
+    do { \
+        double va = (a), vb = (b); \
+        if (!(std::fabs(va - vb) <= (tolerance))) { \
+            std::ostringstream os; \
+            os << __FILE__ << ":" << __LINE__ << ": " << #a << " = " << va << ", expected " << vb << " +- " << (tolerance); \
+            throw lteunit::Failure{os.str()}; \
+        } \
+    } while (0)
+
+#endif
@@ -0,0 +1,82 @@
+//
+//                           SimuLTE
+//
+// This file is part of a software released under the license included in file
+// "license.pdf". This license can be also found at http://www.ltesimulator.com/
+// The above file and the present reference are part of the software itself,
+// and cannot be removed from it.
+//
+
+//
+// Entry point of lte_unit: sets up the OMNeT++ kernel statics the tested
+// classes rely on (simulation time scale), without any network, and runs
+// the registered tests.
+//
+
+#include <omnetpp.h>
+
+#include "UnitTest.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+using namespace omnetpp;
+
+namespace lteunit {
+
+std::vector<Test>& registry()
+{
+    static std::vector<Test> tests;
+    return tests;
+}
+
+int runTests(int argc, char** argv)
+{
+    const char* filter = "";
+    for (int i = 1; i < argc; i++)
+        if (strncmp(argv[i], "--filter=", 9) == 0)
+            filter = argv[i] + 9;
+
+    int run = 0, failed = 0;
+    for (const Test& test : registry())
+    {
+        if (strstr(test.name, filter) == nullptr)
+            continue;
+
+        run++;
+        try
+        {
+            test.fn();
+            std::cout << "[  OK  ] " << test.name << std::endl;
+        }
+        catch (Failure& f)
+        {
+            failed++;
+            std::cout << "[ FAIL ] " << test.name << ": " << f.message << std::endl;
+        }
+        catch (std::exception& e)
+        {
+            failed++;
+            std::cout << "[ FAIL ] " << test.name << ": exception: " << e.what() << std::endl;
+        }
+    }
+    std::cout << run - failed << "/" << run << " tests passed" << std::endl;
+    return failed;
+}
+
+} // namespace lteunit
+
+int main(int argc, char **argv)
+{
+    // must be the first line of main() when embedding the simulation kernel
+    cStaticFlag dummy;
+
+    CodeFragments::executeAll(CodeFragments::STARTUP);
+    SimTime::setScaleExp(-12);
+
+    int failed = lteunit::runTests(argc, argv);
+
+    CodeFragments::executeAll(CodeFragments::SHUTDOWN);
+    return failed == 0 ? 0 : 1;
+}